@@ -0,0 +1,22 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "type.h"
+
+typedef struct arena_chunk_s arena_chunk_t;
+
+typedef struct arena_s {
+	arena_chunk_t *chunks;
+	size_t chunk_size;
+	size_t used;
+} arena_t;
+
+arena_t *arena_init(arena_t *arena, size_t chunk_size);
+void arena_free(arena_t *arena);
+
+void arena_reset(arena_t *arena);
+
+void *arena_alloc(arena_t *arena, size_t size);
+char *arena_strn(arena_t *arena, const char *cstr, size_t len);
+
+#endif
@@ -27,6 +27,8 @@ char *cstr_chr(const char *cstr, char c);
 char *cstr_rchr(const char *cstr, char c);
 char *cstr_cstr(const char *cstr, const char *src);
 
+size_t cstr_remove_chr(char *cstr, size_t len, char c);
+
 size_t cstr_replace(char *str, size_t str_size, size_t str_len, const char *old, size_t old_len, const char *new, size_t new_len, int *found);
 size_t cstr_replaces(char *str, size_t str_size, size_t str_len, const char *const *old, const char *const *new, size_t cnt, int *found);
 size_t cstr_rreplaces(char *str, size_t str_size, size_t str_len, const char *const *old, const char *const *new, size_t cnt);
@@ -0,0 +1,38 @@
+#ifndef DBUF_H
+#define DBUF_H
+
+#include "print.h"
+#include "type.h"
+
+#include <stdarg.h>
+
+#define DBUF_SIZE	(64 * 1024)
+#define DBUF_STACK_SIZE (4 * 1024)
+
+typedef struct dbuf_s {
+	char *data;
+	size_t size;
+	size_t len;
+	print_dst_t dst;
+	bool sink;
+	bool ext;
+	bool fixed;
+} dbuf_t;
+
+dbuf_t *dbuf_init(dbuf_t *buf, size_t size);
+// PRINT_DST_BUF destinations are written in place and stay terminated; fragments that do not fit are dropped
+dbuf_t *dbuf_init_dst(dbuf_t *buf, size_t size, print_dst_t dst);
+dbuf_t *dbuf_init_ext(dbuf_t *buf, void *data, size_t size, print_dst_t dst);
+void dbuf_free(dbuf_t *buf);
+
+int dbuf_flush(dbuf_t *buf);
+int dbuf_reserve(dbuf_t *buf, size_t len);
+
+int dbuf_cat(dbuf_t *buf, const char *data, size_t len);
+int dbuf_catc(dbuf_t *buf, char c);
+int dbuf_catn(dbuf_t *buf, char c, size_t cnt);
+
+int dbuf_printf(dbuf_t *buf, const char *fmt, ...);
+int dbuf_printv(dbuf_t *buf, const char *fmt, va_list args);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef DIGEST_H
+#define DIGEST_H
+
+#include "type.h"
+
+int digest_hex(const byte *digest, size_t size, char *out, size_t out_size);
+int digest_guid(const byte *digest, char *out, size_t out_size);
+
+typedef void (*digest_blocks_fn)(void *h, const byte *data, size_t cnt);
+void digest_update(void *h, byte *block, size_t block_size, u64 *len, const void *data, size_t size, digest_blocks_fn blocks);
+
+typedef void (*digest_update_fn)(void *ctx, const void *data, size_t len);
+int digest_file(const char *path, void *ctx, digest_update_fn update);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef FCACHE_H
+#define FCACHE_H
+
+#include "arena.h"
+#include "dict.h"
+#include "path.h"
+#include "print.h"
+#include "type.h"
+
+typedef struct fcache_stats_s {
+	uint hits;
+	uint rehashed;
+	uint misses;
+} fcache_stats_t;
+
+typedef struct fcache_s {
+	path_t dir;
+	arena_t arena;
+	dict_t ents;
+	fcache_stats_t stats;
+	bool dirty;
+} fcache_t;
+
+fcache_t *fcache_init(fcache_t *cache, const char *dir, size_t len);
+void fcache_free(fcache_t *cache);
+
+int fcache_save(fcache_t *cache);
+
+// hits only when an artifact was stored for the current content of path, the index is updated by fcache_put
+int fcache_check(fcache_t *cache, const char *path, size_t len);
+
+int fcache_put(fcache_t *cache, const char *path, size_t len, const void *data, size_t size);
+// returns a read-only mapping of the cached artifact, non-NULL with *size == 0 for empty ones; release it with
+// file_unmap(data, *size)
+void *fcache_get(fcache_t *cache, const char *path, size_t len, size_t *size);
+
+int fcache_print(const fcache_t *cache, print_dst_t dst);
+
+#endif
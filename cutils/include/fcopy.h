@@ -0,0 +1,26 @@
+#ifndef FCOPY_H
+#define FCOPY_H
+
+#include "fglob.h"
+#include "path.h"
+#include "type.h"
+
+#define FCOPY_CONTENT (1 << 0)
+
+typedef struct fcopy_stats_s {
+	uint folders;
+	uint copied;
+	uint skipped;
+	uint failed;
+	uint peak;
+} fcopy_stats_t;
+
+int file_copy(const char *src, const char *dst);
+int file_same(const char *src, const char *dst, int flags);
+
+// folder_sync walks src and creates folders on the calling thread and hands files to threads copy workers, with at most
+// 2 * threads copies queued or running at once. threads == 1 copies on the calling thread. peak is the most copies
+// that ran at the same time.
+int folder_sync(const path_t *src, const path_t *dst, uint threads, int flags, const fglob_t *ignore, fcopy_stats_t *stats);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef FDICT_H
+#define FDICT_H
+
+#include "arena.h"
+#include "dict.h"
+#include "type.h"
+
+typedef struct fdict_s {
+	byte *data;
+	size_t size;
+	u32 cap;
+	u32 cnt;
+} fdict_t;
+
+fdict_t *fdict_open(fdict_t *dict, const char *path);
+void fdict_close(fdict_t *dict);
+
+const void *fdict_get(const fdict_t *dict, const void *key, size_t ksize, size_t *vsize);
+
+typedef int (*fdict_foreach_cb)(const void *key, size_t ksize, const void *val, size_t vsize, void *priv);
+int fdict_foreach(const fdict_t *dict, fdict_foreach_cb cb, void *priv);
+
+typedef struct fdict_writer_s {
+	arena_t arena;
+	dict_t ents;
+} fdict_writer_t;
+
+fdict_writer_t *fdict_writer_init(fdict_writer_t *writer, uint cap);
+void fdict_writer_free(fdict_writer_t *writer);
+
+int fdict_writer_add(fdict_writer_t *writer, const void *key, size_t ksize, const void *val, size_t vsize);
+int fdict_writer_load(fdict_writer_t *writer, const fdict_t *dict);
+int fdict_writer_save(const fdict_writer_t *writer, const char *path);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef FGLOB_H
+#define FGLOB_H
+
+#include "arena.h"
+#include "arr.h"
+#include "dict.h"
+#include "type.h"
+
+typedef struct fglob_rule_s fglob_rule_t;
+
+typedef struct fglob_s {
+	arena_t arena;
+	arr_t rules;
+	dict_t names;
+	dict_t exts;
+	uint cnt;
+} fglob_t;
+
+fglob_t *fglob_init(fglob_t *glob);
+void fglob_free(fglob_t *glob);
+
+int fglob_add(fglob_t *glob, const char *pattern, size_t len);
+int fglob_add_file(fglob_t *glob, const char *path);
+
+int fglob_match(const fglob_t *glob, const char *path, size_t len, bool folder);
+
+#endif
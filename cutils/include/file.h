@@ -18,6 +18,10 @@ size_t file_read_ft(FILE *file, char *data, size_t data_size);
 
 size_t file_size(FILE *file);
 
+void *file_map(const char *path, size_t *size);
+void *file_map_cow(const char *path, size_t *size);
+void file_unmap(void *data, size_t size);
+
 int file_close(FILE *file);
 
 int file_delete(const char *path);
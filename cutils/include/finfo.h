@@ -0,0 +1,43 @@
+#ifndef FINFO_H
+#define FINFO_H
+
+#include "type.h"
+
+typedef enum finfo_type_e {
+	FINFO_NONE,
+	FINFO_FILE,
+	FINFO_FOLDER,
+	FINFO_OTHER,
+} finfo_type_t;
+
+typedef struct finfo_s {
+	finfo_type_t type;
+	u64 size;
+	u64 mtime;
+	u64 ino;
+} finfo_t;
+
+typedef struct finfo_query_s {
+	const char *path;
+	size_t len;
+	finfo_t info;
+} finfo_query_t;
+
+int finfo_stat(const char *path, finfo_t *info);
+
+// finfo_get answers from a process-wide cache. file_open/file_close for writing, file_delete, folder_create and
+// folder_delete invalidate it; changes made by other means need finfo_invalidate. file_exists and folder_exists
+// always query the file system and never consult the cache.
+
+int finfo_get(const char *path, size_t len, finfo_t *info);
+int finfo_batch(finfo_query_t *queries, uint cnt, uint threads);
+
+void finfo_invalidate(const char *path, size_t len);
+void finfo_invalidate_all();
+
+void finfo_track(const void *file, const char *path, size_t len);
+void finfo_untrack(const void *file);
+
+void finfo_free();
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FREADER_H
+#define FREADER_H
+
+#include "str.h"
+#include "type.h"
+
+#include <stdio.h>
+
+typedef size_t (*freader_refill_cb)(void *priv, char *data, size_t size);
+
+typedef enum freader_advice_e {
+	FREADER_ADVICE_NORMAL,
+	FREADER_ADVICE_SEQUENTIAL,
+	FREADER_ADVICE_WILLNEED,
+	FREADER_ADVICE_DONTNEED,
+} freader_advice_t;
+
+typedef struct freader_s {
+	FILE *file;
+	freader_refill_cb refill;
+	void *priv;
+	char *bufs[2];
+	size_t size;
+	uint cur;
+	size_t start;
+	size_t len;
+	size_t off;
+	freader_advice_t advice;
+	bool eof;
+} freader_t;
+
+freader_t *freader_init(freader_t *reader, size_t size, freader_refill_cb refill, void *priv);
+freader_t *freader_open(freader_t *reader, const char *path, size_t size);
+void freader_free(freader_t *reader);
+
+int freader_advise(freader_t *reader, freader_advice_t advice);
+
+size_t freader_read(freader_t *reader, char *data, size_t size);
+
+int freader_chunk(freader_t *reader, str_t *chunk);
+int freader_record(freader_t *reader, char delim, str_t *record);
+int freader_line(freader_t *reader, str_t *line);
+
+#define freader_foreach_line(_reader, _line) while (freader_line(_reader, _line) == 0)
+
+#endif
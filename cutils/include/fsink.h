@@ -0,0 +1,26 @@
+#ifndef FSINK_H
+#define FSINK_H
+
+#include "path.h"
+#include "type.h"
+
+#include <stdio.h>
+
+typedef struct fsink_stats_s {
+	uint written;
+	uint skipped;
+} fsink_stats_t;
+
+typedef struct fsink_s {
+	path_t path;
+	FILE *file;
+	char *data;
+	size_t size;
+	fsink_stats_t *stats;
+} fsink_t;
+
+FILE *fsink_open(fsink_t *sink, const char *path, fsink_stats_t *stats);
+int fsink_close(fsink_t *sink);
+void fsink_abort(fsink_t *sink);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef FWALK_H
+#define FWALK_H
+
+#include "fglob.h"
+#include "file.h"
+#include "path.h"
+#include "type.h"
+
+#define FWALK_SORT (1 << 0)
+
+// Callbacks run on the calling thread in depth-first order, worker threads only read directories ahead of the walk.
+// There is no per-directory parallelism or work stealing: threads - 1 workers share one queue of directory reads and
+// prefetch at most 4 listings each, so throughput is bounded by the callbacks. Callers that need parallel work, like
+// folder_sync, hand it off to their own threads from the callbacks.
+// FWALK_SORT sorts the entries of each directory before descending into it. Symbolic links are skipped and never followed.
+int fwalk(const path_t *path, uint threads, int flags, const fglob_t *ignore, files_foreach_cb on_folder, files_foreach_cb on_file, void *priv);
+
+#endif
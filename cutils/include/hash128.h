@@ -0,0 +1,18 @@
+#ifndef HASH128_H
+#define HASH128_H
+
+#include "type.h"
+
+typedef struct hash128_s {
+	u64 h[2];
+	u64 len;
+	byte block[16];
+} hash128_t;
+
+hash128_t *hash128_init(hash128_t *ctx);
+void hash128_update(hash128_t *ctx, const void *data, size_t len);
+void hash128_final(hash128_t *ctx, byte *digest);
+
+int hash128_file(const char *path, byte *digest);
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef JSON_H
 #define JSON_H
 
+#include "arena.h"
+#include "dbuf.h"
+#include "dict.h"
 #include "list.h"
 #include "str.h"
 #include "type.h"
@@ -9,6 +12,8 @@
 
 #define JSON_END LIST_END
 
+#define JSON_MAX_DEPTH 512
+
 typedef lnode_t json_val_t;
 
 typedef enum json_val_type_e {
@@ -19,6 +24,7 @@ typedef enum json_val_type_e {
 	JSON_VAL_STR,
 	JSON_VAL_OBJ,
 	JSON_VAL_ARR,
+	JSON_VAL_NULL,
 } json_val_type_t;
 
 typedef struct json_obj_s {
@@ -49,15 +55,61 @@ typedef struct json_mem_s {
 
 typedef struct json_s {
 	list_t values;
+	arena_t arena;
 } json_t;
 
 json_t *json_init(json_t *json, uint values_cap);
+json_t *json_init_arena(json_t *json, uint values_cap, size_t chunk_size);
 void json_free(json_t *json);
 
+str_t json_strz(json_t *json, size_t size);
+str_t json_strn(json_t *json, const char *data, size_t len);
+
+// takes ownership of name and string values on success; on JSON_END they stay with the caller
 json_val_t json_add_val(json_t *json, json_val_t parent, str_t name, json_val_data_t value);
+json_val_t json_add_val_next(json_t *json, json_val_t parent, json_val_t last, str_t name, json_val_data_t value);
+
+json_val_t json_copy(json_t *dst, json_val_t parent, const json_t *src, json_val_t val);
+
+json_val_t json_get(const json_t *json, json_val_t obj, const char *name, size_t len);
+json_val_t json_get_at(const json_t *json, json_val_t arr, uint index);
+json_val_t json_pointer(const json_t *json, json_val_t root, const char *ptr, size_t len);
+
+typedef uint (*json_ptr_cb)(const void *priv, uint node, const char *name, size_t len, uint index);
+uint json_ptr_walk(const char *ptr, size_t len, uint node, json_ptr_cb cb, const void *priv);
+
+typedef struct json_lookup_s {
+	const json_t *json;
+	dict_t dict;
+} json_lookup_t;
+
+json_lookup_t *json_lookup_init(json_lookup_t *lookup, const json_t *json, json_val_t obj);
+void json_lookup_free(json_lookup_t *lookup);
+json_val_t json_lookup_get(const json_lookup_t *lookup, const char *name, size_t len);
 
 int json_print(const json_t *json, json_val_t val, print_dst_t dst, const char *indent);
 
+typedef struct json_writer_s {
+	dbuf_t buf;
+	dbuf_t pad;
+	const char *indent;
+	size_t indent_len;
+	uint depth;
+	bool first;
+	bool key;
+	bool done;
+	byte stack[JSON_MAX_DEPTH / 8];
+} json_writer_t;
+
+json_writer_t *json_writer_init(json_writer_t *writer, print_dst_t dst, const char *indent);
+int json_writer_close(json_writer_t *writer);
+
+int json_write_obj(json_writer_t *writer);
+int json_write_arr(json_writer_t *writer);
+int json_write_key(json_writer_t *writer, const char *key, size_t len);
+int json_write_val(json_writer_t *writer, json_val_data_t val);
+int json_write_end(json_writer_t *writer);
+
 #define JSON_INT(_val)                               \
 	(json_val_data_t)                            \
 	{                                            \
@@ -88,6 +140,12 @@ int json_print(const json_t *json, json_val_t val, print_dst_t dst, const char *
 		.type = JSON_VAL_STR, .val.s = _val, \
 	}
 
+#define JSON_NULL()                    \
+	(json_val_data_t)              \
+	{                              \
+		.type = JSON_VAL_NULL, \
+	}
+
 #define JSON_OBJ()                                                                 \
 	(json_val_data_t)                                                          \
 	{                                                                          \
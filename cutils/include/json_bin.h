@@ -0,0 +1,30 @@
+#ifndef JSON_BIN_H
+#define JSON_BIN_H
+
+#include "dbuf.h"
+#include "json.h"
+#include "type.h"
+
+int json_bin_write(const json_t *json, json_val_t val, dbuf_t *buf);
+
+typedef struct json_bin_s {
+	const byte *data;
+	uint len;
+	uint pos;
+} json_bin_t;
+
+json_bin_t json_bin_root(const void *data, size_t len);
+json_bin_t json_bin_get(json_bin_t obj, const char *name, size_t len);
+json_bin_t json_bin_at(json_bin_t arr, uint index);
+json_bin_t json_bin_pointer(json_bin_t root, const char *ptr, size_t len);
+
+int json_bin_type(json_bin_t bin, json_val_type_t *type);
+int json_bin_cnt(json_bin_t bin, uint *cnt);
+int json_bin_str(json_bin_t bin, str_t *str);
+int json_bin_int(json_bin_t bin, int *val);
+int json_bin_double(json_bin_t bin, double *val);
+int json_bin_bool(json_bin_t bin, int *val);
+
+json_val_t json_bin_load(json_bin_t bin, json_t *json);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef JSON_PARSE_H
+#define JSON_PARSE_H
+
+#include "json.h"
+#include "type.h"
+
+typedef struct json_idx_s {
+	const char *data;
+	size_t len;
+	uint *pos;
+	uint cnt;
+} json_idx_t;
+
+json_idx_t *json_idx_init(json_idx_t *idx, const char *data, size_t len);
+void json_idx_free(json_idx_t *idx);
+
+json_val_t json_parse(json_t *json, const char *data, size_t len);
+
+typedef struct json_ref_s {
+	const json_idx_t *idx;
+	uint pos;
+} json_ref_t;
+
+json_ref_t json_ref_root(const json_idx_t *idx);
+json_ref_t json_ref_get(json_ref_t obj, const char *name, size_t len);
+json_ref_t json_ref_at(json_ref_t arr, uint index);
+json_ref_t json_ref_pointer(json_ref_t root, const char *ptr, size_t len);
+
+int json_ref_type(json_ref_t ref, json_val_type_t *type);
+int json_ref_str(json_ref_t ref, str_t *str);
+int json_ref_int(json_ref_t ref, int *val);
+int json_ref_double(json_ref_t ref, double *val);
+int json_ref_bool(json_ref_t ref, int *val);
+
+json_val_t json_ref_load(json_ref_t ref, json_t *json);
+
+typedef enum json_evt_e {
+	JSON_EVT_NONE,
+	JSON_EVT_OBJ_START,
+	JSON_EVT_OBJ_END,
+	JSON_EVT_ARR_START,
+	JSON_EVT_ARR_END,
+	JSON_EVT_KEY,
+	JSON_EVT_VAL,
+	JSON_EVT_END,
+	JSON_EVT_ERROR,
+} json_evt_t;
+
+typedef struct json_pull_s {
+	const char *data;
+	size_t len;
+	size_t off;
+	size_t pos;
+	bool last;
+	char *buf;
+	size_t buf_size;
+	size_t buf_len;
+	int lex;
+	int state;
+	bool esc;
+	bool has_esc;
+	byte stack[JSON_MAX_DEPTH / 8];
+	uint depth;
+	json_evt_t evt;
+	str_t key;
+	json_val_data_t val;
+	json_t *keep;
+	uint keep_depth;
+	json_val_t nodes[JSON_MAX_DEPTH];
+	json_val_t lasts[JSON_MAX_DEPTH];
+} json_pull_t;
+
+json_pull_t *json_pull_init(json_pull_t *pull, size_t tok_size);
+void json_pull_free(json_pull_t *pull);
+
+void json_pull_feed(json_pull_t *pull, const char *data, size_t len, bool last);
+json_evt_t json_pull_next(json_pull_t *pull);
+
+json_val_t json_pull_keep(json_pull_t *pull, json_t *json, json_val_t parent);
+
+#endif
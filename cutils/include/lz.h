@@ -0,0 +1,46 @@
+#ifndef LZ_H
+#define LZ_H
+
+#include "hash128.h"
+#include "print.h"
+#include "type.h"
+
+#include <stdio.h>
+
+#define LZ_ERR	      ((size_t)-1)
+#define LZ_MAX_INPUT  0x7E000000
+#define LZ_BLOCK_SIZE (64 * 1024)
+
+size_t lz_bound(size_t size);
+size_t lz_compress(const void *src, size_t src_size, void *dst, size_t dst_size);
+size_t lz_decompress(const void *src, size_t src_size, void *dst, size_t dst_size);
+
+typedef struct lz_writer_s {
+	FILE *file;
+	byte *buf;
+	size_t len;
+	byte *out;
+	hash128_t hash;
+	int err;
+} lz_writer_t;
+
+lz_writer_t *lz_writer_init(lz_writer_t *writer, FILE *file);
+int lz_write(lz_writer_t *writer, const void *data, size_t size);
+int lz_writer_close(lz_writer_t *writer);
+
+typedef struct lz_reader_s {
+	FILE *file;
+	byte *buf;
+	size_t len;
+	size_t pos;
+	byte *in;
+	hash128_t hash;
+	bool end;
+} lz_reader_t;
+
+lz_reader_t *lz_reader_init(lz_reader_t *reader, FILE *file);
+size_t lz_read(lz_reader_t *reader, void *data, size_t size);
+size_t lz_print(lz_reader_t *reader, print_dst_t dst);
+void lz_reader_free(lz_reader_t *reader);
+
+#endif
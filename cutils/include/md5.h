@@ -3,6 +3,25 @@
 
 #include "type.h"
 
+typedef struct md5_s {
+	u32 h[4];
+	u64 len;
+	byte block[64];
+} md5_t;
+
+typedef struct md5_msg_s {
+	const void *data;
+	size_t len;
+	byte digest[16];
+} md5_msg_t;
+
+md5_t *md5_init(md5_t *ctx);
+void md5_update(md5_t *ctx, const void *data, size_t len);
+void md5_final(md5_t *ctx, byte *digest);
+
+int md5_file(const char *path, byte *digest);
+int md5_batch(md5_msg_t *msgs, uint cnt);
+
 int md5(const char *msg, size_t msg_len, byte *buf, size_t buf_size, char *out, size_t out_size);
 
 #endif
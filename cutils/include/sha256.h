@@ -0,0 +1,18 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include "type.h"
+
+typedef struct sha256_s {
+	u32 h[8];
+	u64 len;
+	byte block[64];
+} sha256_t;
+
+sha256_t *sha256_init(sha256_t *ctx);
+void sha256_update(sha256_t *ctx, const void *data, size_t len);
+void sha256_final(sha256_t *ctx, byte *digest);
+
+int sha256_file(const char *path, byte *digest);
+
+#endif
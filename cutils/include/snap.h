@@ -0,0 +1,40 @@
+#ifndef SNAP_H
+#define SNAP_H
+
+#include "arr.h"
+#include "list.h"
+#include "str.h"
+#include "tree.h"
+#include "type.h"
+
+#define SNAP_MAX_STRS 8
+
+typedef struct snap_s {
+	byte *data;
+	size_t size;
+	uint cnt;
+} snap_t;
+
+// snap_open maps the file read-only and validates only the header and the container table, so it does not touch the
+// elements. Views returned by snap_get must not be modified. str_t fields of snapshot elements hold file offsets,
+// resolve them with snap_str. Snapshots only load on hosts with the byte order and pointer size of the writer.
+snap_t *snap_open(snap_t *snap, const char *path);
+void snap_close(snap_t *snap);
+
+arr_t *snap_get(const snap_t *snap, uint index, arr_t *arr);
+str_t snap_str(const snap_t *snap, str_t str);
+
+typedef struct snap_writer_s {
+	arr_t arrs;
+} snap_writer_t;
+
+snap_writer_t *snap_writer_init(snap_writer_t *writer, uint cap);
+void snap_writer_free(snap_writer_t *writer);
+
+uint snap_writer_arr(snap_writer_t *writer, const arr_t *arr, const size_t *strs, uint strs_cnt);
+uint snap_writer_list(snap_writer_t *writer, const list_t *list, const size_t *strs, uint strs_cnt);
+uint snap_writer_tree(snap_writer_t *writer, const tree_t *tree, const size_t *strs, uint strs_cnt);
+
+int snap_writer_save(const snap_writer_t *writer, const char *path);
+
+#endif
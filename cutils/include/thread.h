@@ -0,0 +1,74 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "platform.h"
+#include "type.h"
+
+typedef void (*thread_fn)(void *priv);
+
+#if defined(C_WIN)
+typedef struct thread_s {
+	HANDLE handle;
+	thread_fn fn;
+	void *priv;
+} thread_t;
+
+typedef struct mutex_s {
+	SRWLOCK lock;
+} mutex_t;
+
+typedef struct cond_s {
+	CONDITION_VARIABLE cond;
+} cond_t;
+
+typedef struct once_s {
+	INIT_ONCE once;
+} once_t;
+
+	#define MUTEX_INIT { SRWLOCK_INIT }
+	#define ONCE_INIT  { INIT_ONCE_STATIC_INIT }
+#else
+	#include <pthread.h>
+
+typedef struct thread_s {
+	pthread_t handle;
+	thread_fn fn;
+	void *priv;
+} thread_t;
+
+typedef struct mutex_s {
+	pthread_mutex_t lock;
+} mutex_t;
+
+typedef struct cond_s {
+	pthread_cond_t cond;
+} cond_t;
+
+typedef struct once_s {
+	pthread_once_t once;
+} once_t;
+
+	#define MUTEX_INIT { PTHREAD_MUTEX_INITIALIZER }
+	#define ONCE_INIT  { PTHREAD_ONCE_INIT }
+#endif
+
+int thread_create(thread_t *thread, thread_fn fn, void *priv);
+int thread_join(thread_t *thread);
+
+uint thread_cpu_cnt();
+
+mutex_t *mutex_init(mutex_t *mutex);
+void mutex_free(mutex_t *mutex);
+void mutex_lock(mutex_t *mutex);
+void mutex_unlock(mutex_t *mutex);
+
+cond_t *cond_init(cond_t *cond);
+void cond_free(cond_t *cond);
+void cond_wait(cond_t *cond, mutex_t *mutex);
+void cond_signal(cond_t *cond);
+void cond_broadcast(cond_t *cond);
+
+typedef void (*once_fn)();
+void thread_once(once_t *once, once_fn fn);
+
+#endif
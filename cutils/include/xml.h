@@ -1,6 +1,8 @@
 #ifndef XML_H
 #define XML_H
 
+#include "arr.h"
+#include "dbuf.h"
 #include "list.h"
 #include "str.h"
 #include "tree.h"
@@ -23,6 +25,9 @@ void xml_free(xml_t *xml);
 
 xml_tag_t xml_add_tag(xml_t *xml, xml_tag_t tag, str_t name);
 xml_tag_t xml_add_tag_val(xml_t *xml, xml_tag_t tag, str_t name, str_t val);
+xml_tag_t xml_add_tag_next(xml_t *xml, xml_tag_t tag, xml_tag_t last, str_t name, str_t val);
+
+int xml_set_val(xml_t *xml, xml_tag_t tag, str_t val);
 
 int xml_remove_tag(xml_t *xml, xml_tag_t tag);
 bool xml_has_child(const xml_t *xml, xml_tag_t tag);
@@ -31,4 +36,22 @@ xml_attr_t xml_add_attr(xml_t *xml, xml_tag_t tag, str_t name, str_t val);
 
 int xml_print(const xml_t *xml, xml_tag_t tag, print_dst_t dst);
 
+typedef struct xml_writer_s {
+	dbuf_t buf;
+	dbuf_t names;
+	arr_t stack;
+	bool start;
+	bool text;
+	bool nl;
+	bool done;
+} xml_writer_t;
+
+xml_writer_t *xml_writer_init(xml_writer_t *writer, print_dst_t dst);
+int xml_writer_close(xml_writer_t *writer);
+
+int xml_write_open(xml_writer_t *writer, const char *name, size_t len);
+int xml_write_attr(xml_writer_t *writer, const char *name, size_t name_len, const char *val, size_t val_len);
+int xml_write_text(xml_writer_t *writer, const char *val, size_t len);
+int xml_write_end(xml_writer_t *writer);
+
 #endif
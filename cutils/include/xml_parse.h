@@ -0,0 +1,22 @@
+#ifndef XML_PARSE_H
+#define XML_PARSE_H
+
+#include "str.h"
+#include "type.h"
+#include "xml.h"
+
+typedef enum xml_evt_e {
+	XML_EVT_OPEN,
+	XML_EVT_ATTR,
+	XML_EVT_TEXT,
+	XML_EVT_CLOSE,
+} xml_evt_t;
+
+typedef int (*xml_parse_cb)(xml_evt_t evt, str_t name, str_t val, void *priv);
+
+// names and values point into data, except decoded values which live in a scratch buffer valid only during the callback
+int xml_parse_stream(const char *data, size_t len, xml_parse_cb cb, void *priv);
+
+xml_tag_t xml_parse(xml_t *xml, const char *data, size_t len);
+
+#endif
@@ -0,0 +1,118 @@
+#include "arena.h"
+
+#include "log.h"
+#include "mem.h"
+
+#define ARENA_ALIGN 8
+
+struct arena_chunk_s {
+	arena_chunk_t *next;
+	size_t size;
+	size_t used;
+};
+
+arena_t *arena_init(arena_t *arena, size_t chunk_size)
+{
+	if (arena == NULL || chunk_size == 0) {
+		return NULL;
+	}
+
+	arena->chunks	  = NULL;
+	arena->chunk_size = chunk_size;
+	arena->used	  = 0;
+
+	return arena;
+}
+
+void arena_free(arena_t *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	arena_chunk_t *chunk = arena->chunks;
+	while (chunk != NULL) {
+		arena_chunk_t *next = chunk->next;
+		mem_free(chunk, sizeof(arena_chunk_t) + chunk->size);
+		chunk = next;
+	}
+
+	arena->chunks = NULL;
+	arena->used   = 0;
+}
+
+void arena_reset(arena_t *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	arena_chunk_t *chunk = arena->chunks;
+	while (chunk != NULL) {
+		chunk->used = 0;
+		chunk	    = chunk->next;
+	}
+
+	arena->used = 0;
+}
+
+static void *chunk_alloc(arena_t *arena, size_t size, size_t align)
+{
+	arena_chunk_t *chunk = arena->chunks;
+
+	while (chunk != NULL) {
+		const size_t start = (chunk->used + align - 1) & ~(align - 1);
+		if (start + size <= chunk->size) {
+			chunk->used = start + size;
+			arena->used += size;
+			return (byte *)(chunk + 1) + start;
+		}
+
+		if (chunk->next == NULL || chunk->next->used != 0) {
+			break;
+		}
+		chunk = chunk->next;
+	}
+
+	const size_t chunk_size = size > arena->chunk_size ? size : arena->chunk_size;
+
+	chunk = mem_alloc(sizeof(arena_chunk_t) + chunk_size);
+	if (chunk == NULL) {
+		log_error("cutils", "arena", NULL, "failed to allocate chunk");
+		return NULL;
+	}
+
+	chunk->next   = arena->chunks;
+	chunk->size   = chunk_size;
+	chunk->used   = size;
+	arena->chunks = chunk;
+	arena->used += size;
+
+	return chunk + 1;
+}
+
+void *arena_alloc(arena_t *arena, size_t size)
+{
+	if (arena == NULL) {
+		return NULL;
+	}
+
+	return chunk_alloc(arena, size, ARENA_ALIGN);
+}
+
+char *arena_strn(arena_t *arena, const char *cstr, size_t len)
+{
+	if (arena == NULL || cstr == NULL) {
+		return NULL;
+	}
+
+	char *data = chunk_alloc(arena, len + 1, 1);
+	if (data == NULL) {
+		return NULL;
+	}
+
+	mem_cpy(data, len + 1, cstr, len);
+	data[len] = '\0';
+
+	return data;
+}
@@ -6,6 +6,11 @@
 
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define CSTR_SSE2
+	#include <emmintrin.h>
+#endif
+
 size_t cstrv(char *cstr, size_t size, const char *fmt, va_list args)
 {
 	return c_sprintv(cstr, size, 0, fmt, args);
@@ -139,6 +144,50 @@ void *cstr_cpy(char *cstr, size_t size, const char *src, size_t len)
 	return mem_cpy(cstr, size, src, len * sizeof(char));
 }
 
+size_t cstr_remove_chr(char *cstr, size_t len, char c)
+{
+	if (cstr == NULL) {
+		return 0;
+	}
+
+	const char *first = memchr(cstr, c, len);
+	if (first == NULL) {
+		return len;
+	}
+
+	size_t src = (size_t)(first - cstr);
+	size_t dst = src;
+
+#if defined(CSTR_SSE2)
+	const __m128i needle = _mm_set1_epi8(c);
+	while (src + 16 <= len) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)&cstr[src]);
+		const int mask	    = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+		if (mask == 0) {
+			_mm_storeu_si128((__m128i *)&cstr[dst], chunk);
+			dst += 16;
+		} else if (mask != 0xFFFF) {
+			for (int i = 0; i < 16; i++) {
+				if (!(mask & (1 << i))) {
+					cstr[dst++] = cstr[src + i];
+				}
+			}
+		}
+		src += 16;
+	}
+#endif
+
+	while (src < len) {
+		const char *next = memchr(&cstr[src], c, len - src);
+		const size_t end = next == NULL ? len : (size_t)(next - cstr);
+		memmove(&cstr[dst], &cstr[src], end - src);
+		dst += end - src;
+		src = end + 1;
+	}
+
+	return dst;
+}
+
 size_t cstr_replace(char *str, size_t str_size, size_t str_len, const char *old, size_t old_len, const char *new, size_t new_len, int *found)
 {
 	if (found) {
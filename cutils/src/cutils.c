@@ -1,5 +1,7 @@
 #include "cutils.h"
 
+#include "finfo.h"
+
 cutils_t *c_init(cutils_t *cutils)
 {
 	if (cutils == NULL) {
@@ -17,6 +19,8 @@ int c_free(cutils_t *cutils, print_dst_t dst)
 		return 1;
 	}
 
+	finfo_free();
+
 	mem_print(dst);
 
 	if (mem_check()) {
@@ -0,0 +1,287 @@
+#include "dbuf.h"
+
+#include "log.h"
+#include "mem.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int dst_fixed(dbuf_t *buf, print_dst_t dst)
+{
+	if (dst.cb != c_sprintv_cb || dst.dst == NULL) {
+		return 0;
+	}
+
+	const size_t off = (size_t)dst.off < dst.size ? (size_t)dst.off : dst.size;
+
+	// bounded buffers are written in place, keeping the byte past size for the terminator
+	buf->data  = (char *)dst.dst + off;
+	buf->size  = off < dst.size ? dst.size - off - 1 : 0;
+	buf->len   = 0;
+	buf->dst   = dst;
+	buf->sink  = 1;
+	buf->ext   = 1;
+	buf->fixed = 1;
+
+	return 1;
+}
+
+dbuf_t *dbuf_init(dbuf_t *buf, size_t size)
+{
+	if (buf == NULL || size == 0) {
+		return NULL;
+	}
+
+	buf->data = mem_alloc(size);
+	if (buf->data == NULL) {
+		log_error("cutils", "dbuf", NULL, "failed to allocate buffer");
+		return NULL;
+	}
+
+	buf->size  = size;
+	buf->len   = 0;
+	buf->dst   = PRINT_DST_NONE();
+	buf->sink  = 0;
+	buf->ext   = 0;
+	buf->fixed = 0;
+
+	return buf;
+}
+
+dbuf_t *dbuf_init_dst(dbuf_t *buf, size_t size, print_dst_t dst)
+{
+	if (buf != NULL && size > 0 && dst_fixed(buf, dst)) {
+		return buf;
+	}
+
+	if (dbuf_init(buf, size) == NULL) {
+		return NULL;
+	}
+
+	buf->dst  = dst;
+	buf->sink = 1;
+
+	return buf;
+}
+
+dbuf_t *dbuf_init_ext(dbuf_t *buf, void *data, size_t size, print_dst_t dst)
+{
+	if (buf == NULL || data == NULL || size == 0) {
+		return NULL;
+	}
+
+	if (dst_fixed(buf, dst)) {
+		return buf;
+	}
+
+	buf->data  = data;
+	buf->size  = size;
+	buf->len   = 0;
+	buf->dst   = dst;
+	buf->sink  = dst.cb != NULL;
+	buf->ext   = 1;
+	buf->fixed = 0;
+
+	return buf;
+}
+
+void dbuf_free(dbuf_t *buf)
+{
+	if (buf == NULL) {
+		return;
+	}
+
+	if (!buf->ext) {
+		mem_free(buf->data, buf->size);
+	}
+
+	buf->data = NULL;
+	buf->size = 0;
+	buf->len  = 0;
+}
+
+static int dst_write(print_dst_t dst, const char *data, size_t len)
+{
+	if (dst.cb == c_fprintv_cb) {
+		return dst.dst == NULL ? 0 : (int)fwrite(data, 1, len, dst.dst);
+	}
+
+	if (dst.cb == c_printv_cb) {
+		return (int)fwrite(data, 1, len, stdout);
+	}
+
+	int off = 0;
+
+	const char *cur = data;
+	const char *end = data + len;
+	while (cur < end) {
+		const char *nul	 = memchr(cur, '\0', (size_t)(end - cur));
+		const size_t cnt = (nul ? nul : end) - cur;
+		if (cnt > 0) {
+			off += dprintf(dst, "%.*s", (int)cnt, cur);
+		}
+		cur += cnt + 1;
+	}
+
+	return off;
+}
+
+int dbuf_flush(dbuf_t *buf)
+{
+	if (buf == NULL || !buf->sink) {
+		return 0;
+	}
+
+	if (buf->fixed) {
+		const int len = (int)buf->len;
+		if ((size_t)buf->dst.off < buf->dst.size) {
+			buf->data[buf->len] = '\0';
+		}
+
+		buf->dst.off += len;
+		buf->data += buf->len;
+		buf->size -= buf->len;
+		buf->len = 0;
+		return len;
+	}
+
+	if (buf->len == 0) {
+		return 0;
+	}
+
+	const int len = dst_write(buf->dst, buf->data, buf->len);
+	buf->dst.off += len;
+	buf->len = 0;
+	return len;
+}
+
+int dbuf_reserve(dbuf_t *buf, size_t len)
+{
+	if (buf == NULL) {
+		return 1;
+	}
+
+	if (buf->len + len <= buf->size) {
+		return 0;
+	}
+
+	if (buf->fixed) {
+		return 1;
+	}
+
+	if (buf->sink) {
+		dbuf_flush(buf);
+		if (len <= buf->size) {
+			return 0;
+		}
+	}
+
+	size_t size = buf->size;
+	while (size < buf->len + len) {
+		size *= 2;
+	}
+
+	void *data = buf->ext ? mem_alloc(size) : mem_realloc(buf->data, size, buf->size);
+	if (data == NULL) {
+		log_error("cutils", "dbuf", NULL, "failed to grow buffer");
+		return 1;
+	}
+
+	if (buf->ext) {
+		mem_cpy(data, size, buf->data, buf->len);
+		buf->ext = 0;
+	}
+
+	buf->data = data;
+	buf->size = size;
+
+	return 0;
+}
+
+int dbuf_cat(dbuf_t *buf, const char *data, size_t len)
+{
+	if (buf == NULL || data == NULL) {
+		return 0;
+	}
+
+	if (buf->sink && !buf->fixed && len > buf->size) {
+		dbuf_flush(buf);
+		const int cnt = dst_write(buf->dst, data, len);
+		buf->dst.off += cnt;
+		return cnt;
+	}
+
+	if (dbuf_reserve(buf, len)) {
+		return 0;
+	}
+
+	mem_cpy(buf->data + buf->len, buf->size - buf->len, data, len);
+	buf->len += len;
+
+	return (int)len;
+}
+
+int dbuf_catc(dbuf_t *buf, char c)
+{
+	if (buf == NULL || dbuf_reserve(buf, 1)) {
+		return 0;
+	}
+
+	buf->data[buf->len++] = c;
+
+	return 1;
+}
+
+int dbuf_catn(dbuf_t *buf, char c, size_t cnt)
+{
+	if (buf == NULL || dbuf_reserve(buf, cnt)) {
+		return 0;
+	}
+
+	mem_set(buf->data + buf->len, c, cnt);
+	buf->len += cnt;
+
+	return (int)cnt;
+}
+
+int dbuf_printv(dbuf_t *buf, const char *fmt, va_list args)
+{
+	if (buf == NULL || fmt == NULL) {
+		return 0;
+	}
+
+	const size_t room = buf->size - buf->len + (buf->fixed && (size_t)buf->dst.off < buf->dst.size);
+
+	va_list copy;
+	va_copy(copy, args);
+	int len = room > 0 ? c_sprintv(buf->data + buf->len, room, 0, fmt, copy) : 0;
+	va_end(copy);
+
+	if (len > 0) {
+		buf->len += len;
+		return len;
+	}
+
+	// c_sprintv returns 0 both for empty output and when the output does not fit
+	va_copy(copy, args);
+	const int need = c_sprintv(NULL, 0, 0, fmt, copy);
+	va_end(copy);
+
+	if (need <= 0 || buf->fixed || dbuf_reserve(buf, (size_t)need + 1)) {
+		return 0;
+	}
+
+	len = c_sprintv(buf->data + buf->len, buf->size - buf->len, 0, fmt, args);
+	buf->len += len;
+
+	return len;
+}
+
+int dbuf_printf(dbuf_t *buf, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int len = dbuf_printv(buf, fmt, args);
+	va_end(args);
+	return len;
+}
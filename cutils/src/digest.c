@@ -0,0 +1,112 @@
+#include "digest.h"
+
+#include "file.h"
+#include "log.h"
+#include "mem.h"
+
+#include <stdio.h>
+
+#define DIGEST_FILE_BUF_SIZE (64 * 1024)
+
+int digest_hex(const byte *digest, size_t size, char *out, size_t out_size)
+{
+	if (digest == NULL || out == NULL || out_size < size * 2 + 1) {
+		return 1;
+	}
+
+	static const char hex[] = "0123456789abcdef";
+
+	for (size_t i = 0; i < size; i++) {
+		out[i * 2]     = hex[digest[i] >> 4];
+		out[i * 2 + 1] = hex[digest[i] & 0xF];
+	}
+
+	out[size * 2] = '\0';
+	return 0;
+}
+
+int digest_guid(const byte *digest, char *out, size_t out_size)
+{
+	if (digest == NULL || out == NULL || out_size < 37) {
+		return 1;
+	}
+
+	static const char hex[] = "0123456789ABCDEF";
+
+	size_t len = 0;
+	for (int i = 0; i < 16; i++) {
+		if (i == 4 || i == 6 || i == 8 || i == 10) {
+			out[len++] = '-';
+		}
+		out[len++] = hex[digest[i] >> 4];
+		out[len++] = hex[digest[i] & 0xF];
+	}
+
+	out[len] = '\0';
+	return 0;
+}
+
+void digest_update(void *h, byte *block, size_t block_size, u64 *len, const void *data, size_t size, digest_blocks_fn blocks)
+{
+	const byte *cur = data;
+	size_t used	= *len % block_size;
+
+	*len += size;
+
+	if (used > 0) {
+		size_t fill = block_size - used < size ? block_size - used : size;
+		mem_cpy(block + used, block_size - used, cur, fill);
+		cur += fill;
+		size -= fill;
+
+		if (used + fill < block_size) {
+			return;
+		}
+
+		blocks(h, block, 1);
+	}
+
+	if (size >= block_size) {
+		blocks(h, cur, size / block_size);
+		cur += size / block_size * block_size;
+		size %= block_size;
+	}
+
+	if (size > 0) {
+		mem_cpy(block, block_size, cur, size);
+	}
+}
+
+int digest_file(const char *path, void *ctx, digest_update_fn update)
+{
+	if (path == NULL || ctx == NULL || update == NULL) {
+		return 1;
+	}
+
+	FILE *file = file_open(path, "rb");
+	if (file == NULL) {
+		return 1;
+	}
+
+	byte *buf = mem_alloc(DIGEST_FILE_BUF_SIZE);
+	if (buf == NULL) {
+		log_error("cutils", "digest", NULL, "failed to allocate buffer");
+		file_close(file);
+		return 1;
+	}
+
+	size_t cnt;
+	while ((cnt = fread(buf, 1, DIGEST_FILE_BUF_SIZE, file)) > 0) {
+		update(ctx, buf, cnt);
+	}
+
+	const int ret = ferror(file) != 0;
+	if (ret) {
+		log_error("cutils", "digest", NULL, "failed to read file: %s", path);
+	}
+
+	mem_free(buf, DIGEST_FILE_BUF_SIZE);
+	file_close(file);
+
+	return ret;
+}
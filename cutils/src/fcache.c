@@ -0,0 +1,362 @@
+#include "fcache.h"
+
+#include "cstr.h"
+#include "digest.h"
+#include "file.h"
+#include "finfo.h"
+#include "fsink.h"
+#include "hash128.h"
+#include "log.h"
+#include "mem.h"
+
+#include <stdio.h>
+
+#define FCACHE_ARENA_SIZE (16 * 1024)
+#define FCACHE_MAGIC	  "FCI1"
+#define FCACHE_INDEX	  "index"
+
+typedef struct fcache_ent_s {
+	const char *path;
+	u32 len;
+	u64 size;
+	u64 mtime;
+	u64 ino;
+	byte hash[16];
+} fcache_ent_t;
+
+static byte s_empty[1];
+
+static void put_u32(byte *buf, u32 val)
+{
+	for (int i = 0; i < 4; i++) {
+		buf[i] = (byte)(val >> (8 * i));
+	}
+}
+
+static void put_u64(byte *buf, u64 val)
+{
+	for (int i = 0; i < 8; i++) {
+		buf[i] = (byte)(val >> (8 * i));
+	}
+}
+
+static u32 get_u32(const byte *buf)
+{
+	u32 val = 0;
+	for (int i = 0; i < 4; i++) {
+		val |= (u32)buf[i] << (8 * i);
+	}
+	return val;
+}
+
+static u64 get_u64(const byte *buf)
+{
+	u64 val = 0;
+	for (int i = 0; i < 8; i++) {
+		val |= (u64)buf[i] << (8 * i);
+	}
+	return val;
+}
+
+static fcache_ent_t *ent_add(fcache_t *cache, const char *path, size_t len)
+{
+	fcache_ent_t *ent = arena_alloc(&cache->arena, sizeof(fcache_ent_t));
+	const char *key	  = arena_strn(&cache->arena, path, len);
+	if (ent == NULL || key == NULL) {
+		log_error("cutils", "fcache", NULL, "failed to add entry: %.*s", (int)len, path);
+		return NULL;
+	}
+
+	*ent = (fcache_ent_t){
+		.path = key,
+		.len  = (u32)len,
+	};
+
+	dict_set(&cache->ents, key, len, ent);
+	return ent;
+}
+
+static fcache_ent_t *ent_get(const fcache_t *cache, const char *path, size_t len)
+{
+	void *val;
+	return dict_get(&cache->ents, path, len, &val) == 0 ? val : NULL;
+}
+
+static int index_load(fcache_t *cache)
+{
+	path_t path = cache->dir;
+	if (path_child(&path, CSTR(FCACHE_INDEX)) == NULL) {
+		return 1;
+	}
+
+	size_t size;
+	byte *data = file_map(path.path, &size);
+	if (data == NULL) {
+		return 0;
+	}
+
+	const byte *cur = data;
+	const byte *end = data + size;
+
+	u32 cnt = 0;
+	if (size < 8 || mem_cmp(cur, FCACHE_MAGIC, 4) != 0) {
+		log_warn("cutils", "fcache", NULL, "invalid index: %s", path.path);
+		end = cur;
+	} else {
+		cnt = get_u32(cur + 4);
+		cur += 8;
+	}
+
+	for (u32 i = 0; i < cnt; i++) {
+		if ((size_t)(end - cur) < sizeof(u32)) {
+			break;
+		}
+
+		const u32 len = get_u32(cur);
+		cur += sizeof(u32);
+
+		if ((size_t)(end - cur) < len + 3 * sizeof(u64) + 16) {
+			break;
+		}
+
+		fcache_ent_t *ent = ent_add(cache, (const char *)cur, len);
+		if (ent == NULL) {
+			break;
+		}
+		cur += len;
+
+		ent->size  = get_u64(cur);
+		ent->mtime = get_u64(cur + 8);
+		ent->ino   = get_u64(cur + 16);
+		mem_cpy(ent->hash, sizeof(ent->hash), cur + 24, sizeof(ent->hash));
+		cur += 24 + sizeof(ent->hash);
+	}
+
+	file_unmap(data, size);
+	return 0;
+}
+
+fcache_t *fcache_init(fcache_t *cache, const char *dir, size_t len)
+{
+	if (cache == NULL || dir == NULL) {
+		return NULL;
+	}
+
+	if (path_init(&cache->dir, dir, len) == NULL) {
+		log_error("cutils", "fcache", NULL, "path too long: %.*s", (int)len, dir);
+		return NULL;
+	}
+
+	if (!folder_exists(cache->dir.path) && folder_create(cache->dir.path)) {
+		log_error("cutils", "fcache", NULL, "failed to create cache folder: %s", cache->dir.path);
+		return NULL;
+	}
+
+	if (dict_init(&cache->ents, 64) == NULL) {
+		log_error("cutils", "fcache", NULL, "failed to create cache");
+		return NULL;
+	}
+
+	arena_init(&cache->arena, FCACHE_ARENA_SIZE);
+	cache->stats = (fcache_stats_t){ 0 };
+	cache->dirty = 0;
+
+	index_load(cache);
+
+	return cache;
+}
+
+void fcache_free(fcache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	dict_free(&cache->ents);
+	arena_free(&cache->arena);
+}
+
+int fcache_save(fcache_t *cache)
+{
+	if (cache == NULL) {
+		return 1;
+	}
+
+	if (!cache->dirty) {
+		return 0;
+	}
+
+	path_t path = cache->dir;
+	if (path_child(&path, CSTR(FCACHE_INDEX)) == NULL) {
+		return 1;
+	}
+
+	fsink_t sink;
+	FILE *file = fsink_open(&sink, path.path, NULL);
+	if (file == NULL) {
+		return 1;
+	}
+
+	byte hdr[8];
+	mem_cpy(hdr, sizeof(hdr), FCACHE_MAGIC, 4);
+	put_u32(hdr + 4, (u32)cache->ents.count);
+
+	int ret = fwrite(hdr, 1, sizeof(hdr), file) != sizeof(hdr);
+
+	dict_foreach(&cache->ents, bucket)
+	{
+		const fcache_ent_t *ent = bucket->value;
+		if (ret) {
+			break;
+		}
+
+		byte len[4];
+		byte tail[3 * sizeof(u64) + sizeof(ent->hash)];
+		put_u32(len, ent->len);
+		put_u64(tail, ent->size);
+		put_u64(tail + 8, ent->mtime);
+		put_u64(tail + 16, ent->ino);
+		mem_cpy(tail + 24, sizeof(tail) - 24, ent->hash, sizeof(ent->hash));
+
+		ret = fwrite(len, 1, sizeof(len), file) != sizeof(len) || fwrite(ent->path, 1, ent->len, file) != ent->len ||
+		      fwrite(tail, 1, sizeof(tail), file) != sizeof(tail);
+	}
+
+	if (ret) {
+		log_error("cutils", "fcache", NULL, "failed to write index: %s", path.path);
+		fsink_abort(&sink);
+		return 1;
+	}
+
+	if (fsink_close(&sink)) {
+		return 1;
+	}
+
+	cache->dirty = 0;
+	return 0;
+}
+
+int fcache_check(fcache_t *cache, const char *path, size_t len)
+{
+	if (cache == NULL || path == NULL) {
+		return 0;
+	}
+
+	finfo_t info;
+	fcache_ent_t *ent = ent_get(cache, path, len);
+	if (ent == NULL || finfo_stat(path, &info) || info.type != FINFO_FILE) {
+		cache->stats.misses++;
+		return 0;
+	}
+
+	if (ent->size == info.size && ent->mtime == info.mtime && ent->ino == info.ino) {
+		cache->stats.hits++;
+		return 1;
+	}
+
+	byte hash[16];
+	if (hash128_file(path, hash) || mem_cmp(ent->hash, hash, sizeof(hash)) != 0) {
+		cache->stats.misses++;
+		return 0;
+	}
+
+	ent->size    = info.size;
+	ent->mtime   = info.mtime;
+	ent->ino     = info.ino;
+	cache->dirty = 1;
+
+	cache->stats.rehashed++;
+	return 1;
+}
+
+static int artifact_path(const fcache_t *cache, const byte *hash, path_t *path)
+{
+	char hex[33];
+	digest_hex(hash, 16, hex, sizeof(hex));
+
+	*path = cache->dir;
+	return path_child(path, hex, sizeof(hex) - 1) == NULL;
+}
+
+int fcache_put(fcache_t *cache, const char *path, size_t len, const void *data, size_t size)
+{
+	if (cache == NULL || path == NULL || (data == NULL && size > 0)) {
+		return 1;
+	}
+
+	finfo_t info;
+	byte hash[16];
+	if (finfo_stat(path, &info) || info.type != FINFO_FILE || hash128_file(path, hash)) {
+		return 1;
+	}
+
+	path_t artifact;
+	if (artifact_path(cache, hash, &artifact)) {
+		return 1;
+	}
+
+	fsink_t sink;
+	FILE *file = fsink_open(&sink, artifact.path, NULL);
+	if (file == NULL) {
+		return 1;
+	}
+
+	if (size > 0 && fwrite(data, 1, size, file) != size) {
+		log_error("cutils", "fcache", NULL, "failed to write artifact: %s", artifact.path);
+		fsink_abort(&sink);
+		return 1;
+	}
+
+	if (fsink_close(&sink)) {
+		return 1;
+	}
+
+	fcache_ent_t *ent = ent_get(cache, path, len);
+	if (ent == NULL && (ent = ent_add(cache, path, len)) == NULL) {
+		return 1;
+	}
+
+	ent->size  = info.size;
+	ent->mtime = info.mtime;
+	ent->ino   = info.ino;
+	mem_cpy(ent->hash, sizeof(ent->hash), hash, sizeof(hash));
+	cache->dirty = 1;
+
+	return 0;
+}
+
+void *fcache_get(fcache_t *cache, const char *path, size_t len, size_t *size)
+{
+	if (cache == NULL || path == NULL || size == NULL) {
+		return NULL;
+	}
+
+	const fcache_ent_t *ent = ent_get(cache, path, len);
+
+	path_t artifact;
+	if (ent == NULL || artifact_path(cache, ent->hash, &artifact)) {
+		return NULL;
+	}
+
+	void *data = file_map(artifact.path, size);
+
+	finfo_t info;
+	if (data == NULL && finfo_stat(artifact.path, &info) == 0 && info.type == FINFO_FILE && info.size == 0) {
+		return s_empty;
+	}
+
+	return data;
+}
+
+int fcache_print(const fcache_t *cache, print_dst_t dst)
+{
+	if (cache == NULL) {
+		return 0;
+	}
+
+	const uint hits	 = cache->stats.hits + cache->stats.rehashed;
+	const uint total = hits + cache->stats.misses;
+
+	return dprintf(dst, "fcache: %u/%u hits (%u%%), %u rehashed, %u misses\n", hits, total, total ? hits * 100 / total : 0, cache->stats.rehashed,
+		       cache->stats.misses);
+}
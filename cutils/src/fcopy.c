@@ -0,0 +1,506 @@
+#if !defined(_WIN32)
+	#define _GNU_SOURCE
+#endif
+
+#include "fcopy.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "finfo.h"
+#include "fwalk.h"
+#include "log.h"
+#include "mem.h"
+#include "platform.h"
+#include "thread.h"
+
+#include <errno.h>
+#include <string.h>
+
+#if defined(C_WIN)
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#if defined(C_LINUX)
+		#include <linux/fs.h>
+		#include <sys/ioctl.h>
+		#include <sys/sendfile.h>
+	#endif
+#endif
+
+#define FCOPY_BUF_SIZE (64 * 1024)
+#define FCOPY_CMP_SIZE (16 * 1024)
+#define FCOPY_INFLIGHT 2
+
+#if defined(C_WIN)
+#else
+static int copy_rw(int in, int out, off_t off, off_t size, char *buf)
+{
+	char *own = NULL;
+	if (buf == NULL) {
+		buf = own = mem_alloc(FCOPY_BUF_SIZE);
+		if (buf == NULL) {
+			log_error("cutils", "fcopy", NULL, "failed to allocate buffer");
+			return 1;
+		}
+	}
+
+	int ret = 0;
+	while (off < size) {
+		const ssize_t rd = pread(in, buf, FCOPY_BUF_SIZE, off);
+		if (rd <= 0) {
+			ret = rd < 0;
+			break;
+		}
+
+		for (ssize_t wr = 0; wr < rd;) {
+			const ssize_t cnt = pwrite(out, buf + wr, (size_t)(rd - wr), off + wr);
+			if (cnt < 0) {
+				ret = 1;
+				break;
+			}
+			wr += cnt;
+		}
+
+		if (ret) {
+			break;
+		}
+
+		off += rd;
+	}
+
+	if (own) {
+		mem_free(own, FCOPY_BUF_SIZE);
+	}
+
+	return ret;
+}
+
+static int copy_fd(int in, int out, off_t size, char *buf)
+{
+	off_t off = 0;
+
+	#if defined(C_LINUX)
+		#if defined(FICLONE)
+	if (ioctl(out, FICLONE, in) == 0) {
+		return 0;
+	}
+		#endif
+
+	while (off < size) {
+		const ssize_t cnt = copy_file_range(in, NULL, out, NULL, (size_t)(size - off), 0);
+		if (cnt <= 0) {
+			break;
+		}
+		off += cnt;
+	}
+
+	if (off < size && lseek(in, off, SEEK_SET) == off && lseek(out, off, SEEK_SET) == off) {
+		while (off < size) {
+			const ssize_t cnt = sendfile(out, in, &off, (size_t)(size - off));
+			if (cnt <= 0) {
+				break;
+			}
+		}
+	}
+	#endif
+
+	return off < size ? copy_rw(in, out, off, size, buf) : 0;
+}
+#endif
+
+static int copy_file(const char *src, const char *dst, char *buf)
+{
+	finfo_invalidate(dst, cstr_len(dst));
+
+#if defined(C_WIN)
+	(void)buf;
+	return CopyFileA(src, dst, FALSE) ? 0 : EIO;
+#else
+	const int in = open(src, O_RDONLY | O_CLOEXEC);
+	if (in < 0) {
+		return errno;
+	}
+
+	struct stat st;
+	if (fstat(in, &st)) {
+		const int errnum = errno;
+		close(in);
+		return errnum;
+	}
+
+	const int out = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+	if (out < 0) {
+		const int errnum = errno;
+		close(in);
+		return errnum;
+	}
+
+	errno	   = 0;
+	int errnum = copy_fd(in, out, st.st_size, buf) ? (errno ? errno : EIO) : 0;
+
+	const struct timespec times[2] = { st.st_atim, st.st_mtim };
+	if (errnum == 0 && futimens(out, times)) {
+		errnum = errno;
+	}
+
+	close(in);
+	if (close(out) && errnum == 0) {
+		errnum = errno;
+	}
+
+	return errnum;
+#endif
+}
+
+int file_copy(const char *src, const char *dst)
+{
+	if (src == NULL || dst == NULL) {
+		return 1;
+	}
+
+	const int errnum = copy_file(src, dst, NULL);
+	if (errnum) {
+		log_error("cutils", "fcopy", NULL, "failed to copy file \"%s\" to \"%s\": %s (%d)", src, dst, log_strerror(errnum), errnum);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int content_same(const char *src, const char *dst)
+{
+	FILE *l = fopen(src, "rb");
+	FILE *r = fopen(dst, "rb");
+
+	int same = l != NULL && r != NULL;
+
+	char lbuf[FCOPY_CMP_SIZE];
+	char rbuf[FCOPY_CMP_SIZE];
+
+	while (same) {
+		const size_t lcnt = fread(lbuf, 1, sizeof(lbuf), l);
+		const size_t rcnt = fread(rbuf, 1, sizeof(rbuf), r);
+
+		if (lcnt != rcnt || mem_cmp(lbuf, rbuf, lcnt) != 0) {
+			same = 0;
+		}
+
+		if (lcnt < sizeof(lbuf)) {
+			break;
+		}
+	}
+
+	if (l) {
+		fclose(l);
+	}
+	if (r) {
+		fclose(r);
+	}
+
+	return same;
+}
+
+int file_same(const char *src, const char *dst, int flags)
+{
+	if (src == NULL || dst == NULL) {
+		return 0;
+	}
+
+	finfo_t sinfo;
+	finfo_t dinfo;
+	if (finfo_stat(src, &sinfo) || finfo_stat(dst, &dinfo) || sinfo.type != FINFO_FILE || dinfo.type != FINFO_FILE || sinfo.size != dinfo.size) {
+		return 0;
+	}
+
+	if (flags & FCOPY_CONTENT) {
+		return content_same(src, dst);
+	}
+
+	return sinfo.mtime == dinfo.mtime;
+}
+
+typedef enum copy_state_e {
+	COPY_QUEUED,
+	COPY_RUNNING,
+	COPY_DONE,
+} copy_state_t;
+
+typedef struct copy_job_s {
+	path_t src;
+	path_t dst;
+	copy_state_t state;
+	int skip;
+	int errnum;
+} copy_job_t;
+
+typedef struct fsync_s {
+	path_t dst;
+	size_t src_len;
+	int flags;
+	mutex_t lock;
+	cond_t cond;
+	cond_t done;
+	copy_job_t *jobs;
+	uint cap;
+	uint queued;
+	uint taken;
+	uint reaped;
+	uint running;
+	uint peak;
+	bool stop;
+	fcopy_stats_t stats;
+} fsync_t;
+
+typedef struct copy_worker_s {
+	thread_t thread;
+	fsync_t *sync;
+	char *buf;
+} copy_worker_t;
+
+static int dst_path(const fsync_t *sync, const path_t *src, path_t *dst)
+{
+	if (path_init(dst, sync->dst.path, sync->dst.len) == NULL || path_child_s(dst, src->path + sync->src_len, src->len - sync->src_len, '\0') == NULL) {
+		log_error("cutils", "fcopy", NULL, "path too long: %.*s", (int)src->len, src->path);
+		return 1;
+	}
+
+	return 0;
+}
+
+static void job_run(const fsync_t *sync, copy_job_t *job, char *buf)
+{
+	job->skip   = file_same(job->src.path, job->dst.path, sync->flags);
+	job->errnum = job->skip ? 0 : copy_file(job->src.path, job->dst.path, buf);
+}
+
+static void job_done(fsync_t *sync, const copy_job_t *job)
+{
+	if (job->errnum) {
+		log_error("cutils", "fcopy", NULL, "failed to copy file \"%s\" to \"%s\": %s (%d)", job->src.path, job->dst.path, log_strerror(job->errnum),
+			  job->errnum);
+		sync->stats.failed++;
+	} else if (job->skip) {
+		sync->stats.skipped++;
+	} else {
+		sync->stats.copied++;
+	}
+}
+
+static void worker_run(void *priv)
+{
+	copy_worker_t *worker = priv;
+	fsync_t *sync	      = worker->sync;
+
+	mutex_lock(&sync->lock);
+	for (;;) {
+		while (sync->taken == sync->queued && !sync->stop) {
+			cond_wait(&sync->cond, &sync->lock);
+		}
+
+		if (sync->taken == sync->queued) {
+			break;
+		}
+
+		copy_job_t *job = &sync->jobs[sync->taken++ % sync->cap];
+		job->state	= COPY_RUNNING;
+		if (++sync->running > sync->peak) {
+			sync->peak = sync->running;
+		}
+		mutex_unlock(&sync->lock);
+
+		job_run(sync, job, worker->buf);
+
+		mutex_lock(&sync->lock);
+		sync->running--;
+		job->state = COPY_DONE;
+		cond_signal(&sync->done);
+	}
+	mutex_unlock(&sync->lock);
+}
+
+static void job_reap(fsync_t *sync)
+{
+	copy_job_t *job = &sync->jobs[sync->reaped % sync->cap];
+
+	mutex_lock(&sync->lock);
+	while (job->state != COPY_DONE) {
+		cond_wait(&sync->done, &sync->lock);
+	}
+	mutex_unlock(&sync->lock);
+
+	sync->reaped++;
+	job_done(sync, job);
+}
+
+static int sync_folder_cb(path_t *path, const char *folder, void *priv)
+{
+	(void)folder;
+
+	fsync_t *sync = priv;
+
+	path_t dst;
+	int ret = dst_path(sync, path, &dst) || (!folder_exists(dst.path) && folder_create(dst.path));
+
+	if (ret) {
+		sync->stats.failed++;
+	} else {
+		sync->stats.folders++;
+	}
+
+	return ret;
+}
+
+static int sync_file_cb(path_t *path, const char *file, void *priv)
+{
+	(void)file;
+
+	fsync_t *sync = priv;
+
+	if (sync->cap > 0 && sync->queued - sync->reaped == sync->cap) {
+		job_reap(sync);
+	}
+
+	copy_job_t local;
+	copy_job_t *job = sync->cap > 0 ? &sync->jobs[sync->queued % sync->cap] : &local;
+
+	if (path_init(&job->src, path->path, path->len) == NULL || dst_path(sync, path, &job->dst)) {
+		sync->stats.failed++;
+		return 0;
+	}
+
+	if (sync->cap == 0) {
+		job_run(sync, job, NULL);
+		job_done(sync, job);
+		sync->peak = 1;
+		return 0;
+	}
+
+	mutex_lock(&sync->lock);
+	job->state = COPY_QUEUED;
+	sync->queued++;
+	cond_signal(&sync->cond);
+	mutex_unlock(&sync->lock);
+
+	return 0;
+}
+
+static uint workers_start(fsync_t *sync, copy_worker_t *workers, uint threads, char *bufs)
+{
+	uint started = 0;
+	for (uint i = 0; i < threads; i++) {
+		workers[started] = (copy_worker_t){
+			.sync = sync,
+			.buf  = bufs + (size_t)i * FCOPY_BUF_SIZE,
+		};
+
+		if (thread_create(&workers[started].thread, worker_run, &workers[started]) == 0) {
+			started++;
+		}
+	}
+
+	return started;
+}
+
+int folder_sync(const path_t *src, const path_t *dst, uint threads, int flags, const fglob_t *ignore, fcopy_stats_t *stats)
+{
+	if (src == NULL || dst == NULL) {
+		return 1;
+	}
+
+	if (!folder_exists(src->path)) {
+		return 1;
+	}
+
+	if (threads == 0) {
+		threads = thread_cpu_cnt();
+	}
+
+	fsync_t *sync = mem_calloc(1, sizeof(fsync_t));
+	if (sync == NULL) {
+		log_error("cutils", "fcopy", NULL, "failed to allocate sync");
+		return 1;
+	}
+
+	sync->dst     = *dst;
+	sync->src_len = src->len;
+	sync->flags   = flags;
+	mutex_init(&sync->lock);
+	cond_init(&sync->cond);
+	cond_init(&sync->done);
+
+	copy_worker_t *workers = NULL;
+	char *bufs	       = NULL;
+	uint started	       = 0;
+
+	if (threads > 1) {
+		workers	   = mem_calloc(threads, sizeof(copy_worker_t));
+		bufs	   = mem_alloc((size_t)threads * FCOPY_BUF_SIZE);
+		sync->jobs = mem_calloc(threads * FCOPY_INFLIGHT, sizeof(copy_job_t));
+		if (workers == NULL || bufs == NULL || sync->jobs == NULL) {
+			log_error("cutils", "fcopy", NULL, "failed to allocate copy workers");
+		} else {
+			sync->cap = threads * FCOPY_INFLIGHT;
+			started	  = workers_start(sync, workers, threads, bufs);
+		}
+
+		if (started == 0) {
+			sync->cap = 0;
+		}
+	}
+
+	int ret = 0;
+
+	const char dst_last = dst->len > 0 ? dst->path[dst->len - 1] : '/';
+	if (dst_last != '/' && dst_last != '\\' && path_child_s(&sync->dst, SEP, 1, '\0') == NULL) {
+		ret = 1;
+	}
+
+	const char src_last = src->len > 0 ? src->path[src->len - 1] : '/';
+	if (src_last != '/' && src_last != '\\') {
+		sync->src_len++;
+	}
+
+	if (ret == 0 && !folder_exists(dst->path) && folder_create(dst->path)) {
+		ret = 1;
+	}
+
+	if (ret == 0) {
+		ret = fwalk(src, threads, 0, ignore, sync_folder_cb, sync_file_cb, sync);
+	}
+
+	while (sync->reaped != sync->queued) {
+		job_reap(sync);
+	}
+
+	mutex_lock(&sync->lock);
+	sync->stop = 1;
+	cond_broadcast(&sync->cond);
+	mutex_unlock(&sync->lock);
+
+	for (uint i = 0; i < started; i++) {
+		thread_join(&workers[i].thread);
+	}
+
+	if (ret == 0 && sync->stats.failed > 0) {
+		ret = 1;
+	}
+
+	if (stats) {
+		*stats	    = sync->stats;
+		stats->peak = sync->peak;
+	}
+
+	if (threads > 1) {
+		mem_free(sync->jobs, threads * FCOPY_INFLIGHT * sizeof(copy_job_t));
+		mem_free(bufs, (size_t)threads * FCOPY_BUF_SIZE);
+		mem_free(workers, threads * sizeof(copy_worker_t));
+	}
+
+	cond_free(&sync->done);
+	cond_free(&sync->cond);
+	mutex_free(&sync->lock);
+	mem_free(sync, sizeof(fsync_t));
+
+	return ret;
+}
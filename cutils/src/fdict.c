@@ -0,0 +1,360 @@
+#include "fdict.h"
+
+#include "file.h"
+#include "fsink.h"
+#include "log.h"
+#include "mem.h"
+#include "platform.h"
+
+#include <stdio.h>
+
+#define FDICT_MAGIC	 "FDT1"
+#define FDICT_ARENA_SIZE (64 * 1024)
+#define FDICT_HDR_SIZE	 16
+#define FDICT_SLOT_SIZE	 32
+
+typedef struct fdict_slot_s {
+	u64 koff;
+	u64 voff;
+	u32 ksize;
+	u32 vsize;
+	u32 hash;
+} fdict_slot_t;
+
+typedef struct fdict_ent_s {
+	const void *key;
+	const void *val;
+	u32 ksize;
+	u32 vsize;
+} fdict_ent_t;
+
+static u32 fdict_hash(const void *key, size_t ksize)
+{
+	const byte *data = key;
+
+	u32 hash = 2166136261u;
+	for (size_t i = 0; i < ksize; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static void put_u32(byte *buf, u32 val)
+{
+	for (int i = 0; i < 4; i++) {
+		buf[i] = (byte)(val >> (8 * i));
+	}
+}
+
+static void put_u64(byte *buf, u64 val)
+{
+	for (int i = 0; i < 8; i++) {
+		buf[i] = (byte)(val >> (8 * i));
+	}
+}
+
+static u32 get_u32(const byte *buf)
+{
+	u32 val = 0;
+	for (int i = 0; i < 4; i++) {
+		val |= (u32)buf[i] << (8 * i);
+	}
+	return val;
+}
+
+static u64 get_u64(const byte *buf)
+{
+	u64 val = 0;
+	for (int i = 0; i < 8; i++) {
+		val |= (u64)buf[i] << (8 * i);
+	}
+	return val;
+}
+
+static void get_slot(const fdict_t *dict, u32 index, fdict_slot_t *slot)
+{
+	const byte *data = dict->data + FDICT_HDR_SIZE + (size_t)index * FDICT_SLOT_SIZE;
+
+	slot->koff  = get_u64(data);
+	slot->voff  = get_u64(data + 8);
+	slot->ksize = get_u32(data + 16);
+	slot->vsize = get_u32(data + 20);
+	slot->hash  = get_u32(data + 24);
+}
+
+static void put_slot(byte *data, const fdict_slot_t *slot)
+{
+	put_u64(data, slot->koff);
+	put_u64(data + 8, slot->voff);
+	put_u32(data + 16, slot->ksize);
+	put_u32(data + 20, slot->vsize);
+	put_u32(data + 24, slot->hash);
+	put_u32(data + 28, 0);
+}
+
+fdict_t *fdict_open(fdict_t *dict, const char *path)
+{
+	if (dict == NULL || path == NULL) {
+		return NULL;
+	}
+
+	dict->data = file_map(path, &dict->size);
+	if (dict->data == NULL) {
+		return NULL;
+	}
+
+	u32 cap	  = 0;
+	int valid = dict->size >= FDICT_HDR_SIZE && mem_cmp(dict->data, FDICT_MAGIC, 4) == 0;
+	if (valid) {
+		cap   = get_u32(dict->data + 4);
+		valid = cap > 0 && (cap & (cap - 1)) == 0 && (dict->size - FDICT_HDR_SIZE) / FDICT_SLOT_SIZE >= cap;
+	}
+
+	if (!valid) {
+		log_error("cutils", "fdict", NULL, "invalid file: %s", path);
+		file_unmap(dict->data, dict->size);
+		dict->data = NULL;
+		return NULL;
+	}
+
+	dict->cap = cap;
+	dict->cnt = get_u32(dict->data + 8);
+
+	return dict;
+}
+
+void fdict_close(fdict_t *dict)
+{
+	if (dict == NULL || dict->data == NULL) {
+		return;
+	}
+
+	file_unmap(dict->data, dict->size);
+	dict->data = NULL;
+	dict->size = 0;
+}
+
+static int slot_valid(const fdict_t *dict, const fdict_slot_t *slot)
+{
+	return slot->koff <= dict->size && slot->ksize <= dict->size - slot->koff && slot->voff <= dict->size && slot->vsize <= dict->size - slot->voff;
+}
+
+const void *fdict_get(const fdict_t *dict, const void *key, size_t ksize, size_t *vsize)
+{
+	if (dict == NULL || dict->data == NULL || key == NULL) {
+		return NULL;
+	}
+
+	const u32 hash = fdict_hash(key, ksize);
+
+	for (u32 i = 0; i < dict->cap; i++) {
+		fdict_slot_t slot;
+		get_slot(dict, (hash + i) & (dict->cap - 1), &slot);
+		if (slot.koff == 0) {
+			break;
+		}
+
+		if (slot.hash != hash || slot.ksize != ksize || !slot_valid(dict, &slot) || mem_cmp(dict->data + slot.koff, key, ksize) != 0) {
+			continue;
+		}
+
+		if (vsize) {
+			*vsize = slot.vsize;
+		}
+
+		return dict->data + slot.voff;
+	}
+
+	return NULL;
+}
+
+int fdict_foreach(const fdict_t *dict, fdict_foreach_cb cb, void *priv)
+{
+	if (dict == NULL || dict->data == NULL || cb == NULL) {
+		return 1;
+	}
+
+	for (u32 i = 0; i < dict->cap; i++) {
+		fdict_slot_t slot;
+		get_slot(dict, i, &slot);
+		if (slot.koff == 0 || !slot_valid(dict, &slot)) {
+			continue;
+		}
+
+		int ret = cb(dict->data + slot.koff, slot.ksize, dict->data + slot.voff, slot.vsize, priv);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+fdict_writer_t *fdict_writer_init(fdict_writer_t *writer, uint cap)
+{
+	if (writer == NULL) {
+		return NULL;
+	}
+
+	if (dict_init(&writer->ents, cap < 8 ? 8 : cap) == NULL) {
+		log_error("cutils", "fdict", NULL, "failed to create writer");
+		return NULL;
+	}
+
+	arena_init(&writer->arena, FDICT_ARENA_SIZE);
+
+	return writer;
+}
+
+void fdict_writer_free(fdict_writer_t *writer)
+{
+	if (writer == NULL) {
+		return;
+	}
+
+	dict_free(&writer->ents);
+	arena_free(&writer->arena);
+}
+
+int fdict_writer_add(fdict_writer_t *writer, const void *key, size_t ksize, const void *val, size_t vsize)
+{
+	if (writer == NULL || key == NULL || (val == NULL && vsize > 0)) {
+		return 1;
+	}
+
+	if ((u64)ksize > 0xFFFFFFFF || (u64)vsize > 0xFFFFFFFF) {
+		log_error("cutils", "fdict", NULL, "entry too large: key %zu bytes, value %zu bytes", ksize, vsize);
+		return 1;
+	}
+
+	void *prev;
+	const int found = dict_get(&writer->ents, key, ksize, &prev) == 0;
+
+	fdict_ent_t *ent = found ? prev : arena_alloc(&writer->arena, sizeof(fdict_ent_t));
+	void *data	 = arena_alloc(&writer->arena, (found ? 0 : ksize) + vsize + 1);
+	if (ent == NULL || data == NULL) {
+		log_error("cutils", "fdict", NULL, "failed to add entry");
+		return 1;
+	}
+
+	if (!found) {
+		mem_cpy(data, ksize, key, ksize);
+		ent->key   = data;
+		ent->ksize = (u32)ksize;
+		data	   = (byte *)data + ksize;
+	}
+
+	if (vsize > 0) {
+		mem_cpy(data, vsize, val, vsize);
+	}
+	ent->val   = data;
+	ent->vsize = (u32)vsize;
+
+	if (!found) {
+		dict_set(&writer->ents, ent->key, ksize, ent);
+	}
+
+	return 0;
+}
+
+static int load_cb(const void *key, size_t ksize, const void *val, size_t vsize, void *priv)
+{
+	return fdict_writer_add(priv, key, ksize, val, vsize);
+}
+
+int fdict_writer_load(fdict_writer_t *writer, const fdict_t *dict)
+{
+	if (writer == NULL || dict == NULL) {
+		return 1;
+	}
+
+	return fdict_foreach(dict, load_cb, writer);
+}
+
+static int write_file(const fdict_writer_t *writer, FILE *file)
+{
+	u32 cap = 8;
+	while (cap < (u32)writer->ents.count * 2) {
+		cap *= 2;
+	}
+
+	fdict_slot_t *slots = mem_calloc(cap, sizeof(fdict_slot_t));
+	if (slots == NULL) {
+		log_error("cutils", "fdict", NULL, "failed to allocate slots");
+		return 1;
+	}
+
+	u64 off = FDICT_HDR_SIZE + (u64)cap * FDICT_SLOT_SIZE;
+
+	dict_foreach(&writer->ents, bucket)
+	{
+		const fdict_ent_t *ent = bucket->value;
+		const u32 hash	       = fdict_hash(ent->key, ent->ksize);
+
+		u32 i = hash & (cap - 1);
+		while (slots[i].koff != 0) {
+			i = (i + 1) & (cap - 1);
+		}
+
+		slots[i] = (fdict_slot_t){
+			.koff  = off,
+			.voff  = off + ent->ksize,
+			.ksize = ent->ksize,
+			.vsize = ent->vsize,
+			.hash  = hash,
+		};
+
+		off += ent->ksize + ent->vsize;
+	}
+
+	byte hdr[FDICT_HDR_SIZE];
+	mem_cpy(hdr, sizeof(hdr), FDICT_MAGIC, 4);
+	put_u32(hdr + 4, cap);
+	put_u32(hdr + 8, (u32)writer->ents.count);
+	put_u32(hdr + 12, 0);
+
+	int ret = fwrite(hdr, 1, sizeof(hdr), file) != sizeof(hdr);
+
+	for (u32 i = 0; i < cap && ret == 0; i++) {
+		byte slot[FDICT_SLOT_SIZE];
+		put_slot(slot, &slots[i]);
+		ret = fwrite(slot, 1, sizeof(slot), file) != sizeof(slot);
+	}
+
+	mem_free(slots, cap * sizeof(fdict_slot_t));
+
+	dict_foreach(&writer->ents, bucket)
+	{
+		const fdict_ent_t *ent = bucket->value;
+		if (ret) {
+			break;
+		}
+
+		ret = fwrite(ent->key, 1, ent->ksize, file) != ent->ksize || fwrite(ent->val, 1, ent->vsize, file) != ent->vsize;
+	}
+
+	return ret;
+}
+
+int fdict_writer_save(const fdict_writer_t *writer, const char *path)
+{
+	if (writer == NULL || path == NULL) {
+		return 1;
+	}
+
+	fsink_t sink;
+	FILE *file = fsink_open(&sink, path, NULL);
+	if (file == NULL) {
+		return 1;
+	}
+
+	if (write_file(writer, file)) {
+		log_error("cutils", "fdict", NULL, "failed to write file: %s", path);
+		fsink_abort(&sink);
+		return 1;
+	}
+
+	return fsink_close(&sink);
+}
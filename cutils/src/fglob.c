@@ -0,0 +1,441 @@
+#include "fglob.h"
+
+#include "cstr.h"
+#include "freader.h"
+#include "log.h"
+
+#define FGLOB_ARENA_SIZE 4096
+#define FGLOB_NONE	 ((uint) - 1)
+
+typedef struct fglob_seg_s {
+	const char *pat;
+	size_t len;
+	bool globstar;
+} fglob_seg_t;
+
+struct fglob_rule_s {
+	fglob_rule_t *prev;
+	uint index;
+	bool negate;
+	bool folder;
+	bool anchored;
+	bool sub;
+	fglob_seg_t *segs;
+	uint segs_cnt;
+};
+
+fglob_t *fglob_init(fglob_t *glob)
+{
+	if (glob == NULL) {
+		return NULL;
+	}
+
+	arena_init(&glob->arena, FGLOB_ARENA_SIZE);
+
+	if (arr_init(&glob->rules, 8, sizeof(fglob_rule_t *)) == NULL) {
+		return NULL;
+	}
+
+	if (dict_init(&glob->names, 16) == NULL) {
+		arr_free(&glob->rules);
+		return NULL;
+	}
+
+	if (dict_init(&glob->exts, 16) == NULL) {
+		dict_free(&glob->names);
+		arr_free(&glob->rules);
+		return NULL;
+	}
+
+	glob->cnt = 0;
+
+	return glob;
+}
+
+void fglob_free(fglob_t *glob)
+{
+	if (glob == NULL) {
+		return;
+	}
+
+	dict_free(&glob->exts);
+	dict_free(&glob->names);
+	arr_free(&glob->rules);
+	arena_free(&glob->arena);
+	glob->cnt = 0;
+}
+
+static inline int is_sep(char c)
+{
+	return c == '/' || c == '\\';
+}
+
+static inline int is_wild(char c)
+{
+	return c == '*' || c == '?' || c == '[' || c == '\\';
+}
+
+static int has_wild(const char *pat, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (is_wild(pat[i])) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void dict_add(dict_t *dict, const char *key, size_t len, fglob_rule_t *rule)
+{
+	void *prev = NULL;
+	if (dict_get(dict, key, len, &prev)) {
+		prev = NULL;
+	}
+
+	rule->prev = prev;
+	dict_set(dict, key, len, rule);
+}
+
+int fglob_add(fglob_t *glob, const char *pattern, size_t len)
+{
+	if (glob == NULL || pattern == NULL) {
+		return 1;
+	}
+
+	while (len > 0 && (pattern[len - 1] == '\r' || pattern[len - 1] == '\n')) {
+		len--;
+	}
+
+	while (len > 0 && pattern[len - 1] == ' ' && (len < 2 || pattern[len - 2] != '\\')) {
+		len--;
+	}
+
+	if (len == 0 || pattern[0] == '#') {
+		return 0;
+	}
+
+	bool negate = 0;
+	if (pattern[0] == '!') {
+		negate = 1;
+		pattern++;
+		len--;
+	} else if (len > 1 && pattern[0] == '\\' && (pattern[1] == '!' || pattern[1] == '#')) {
+		pattern++;
+		len--;
+	}
+
+	bool folder = 0;
+	if (len > 0 && pattern[len - 1] == '/') {
+		folder = 1;
+		len--;
+	}
+
+	bool anchored = 0;
+	if (len > 0 && pattern[0] == '/') {
+		anchored = 1;
+		pattern++;
+		len--;
+	}
+
+	if (len == 0) {
+		return 0;
+	}
+
+	uint segs_cnt = 1;
+	for (size_t i = 0; i < len; i++) {
+		if (pattern[i] == '/') {
+			anchored = 1;
+			segs_cnt++;
+		}
+	}
+
+	fglob_rule_t *rule = arena_alloc(&glob->arena, sizeof(fglob_rule_t));
+	fglob_seg_t *segs  = arena_alloc(&glob->arena, segs_cnt * sizeof(fglob_seg_t));
+	const char *pat	   = arena_strn(&glob->arena, pattern, len);
+	if (rule == NULL || segs == NULL || pat == NULL) {
+		log_error("cutils", "fglob", NULL, "failed to add pattern: %.*s", (int)len, pattern);
+		return 1;
+	}
+
+	rule->prev     = NULL;
+	rule->index    = glob->cnt;
+	rule->negate   = negate;
+	rule->folder   = folder;
+	rule->anchored = anchored;
+	rule->sub      = 0;
+	rule->segs     = segs;
+	rule->segs_cnt = 0;
+
+	size_t start = 0;
+	for (size_t i = 0; i <= len; i++) {
+		if (i < len && pat[i] != '/') {
+			continue;
+		}
+
+		const size_t seg_len = i - start;
+		const bool globstar  = seg_len == 2 && pat[start] == '*' && pat[start + 1] == '*';
+
+		if (seg_len > 0 && !(globstar && rule->segs_cnt > 0 && segs[rule->segs_cnt - 1].globstar)) {
+			segs[rule->segs_cnt].pat      = pat + start;
+			segs[rule->segs_cnt].len      = seg_len;
+			segs[rule->segs_cnt].globstar = globstar;
+			rule->segs_cnt++;
+		}
+
+		start = i + 1;
+	}
+
+	if (rule->segs_cnt > 1 && segs[rule->segs_cnt - 1].globstar) {
+		rule->sub = 1;
+		rule->segs_cnt--;
+	}
+
+	if (!anchored && !has_wild(pat, len)) {
+		dict_add(&glob->names, pat, len, rule);
+	} else if (!anchored && len > 2 && pat[0] == '*' && pat[1] == '.' && !has_wild(pat + 2, len - 2) && cstr_chr(pat + 2, '.') == NULL) {
+		dict_add(&glob->exts, pat + 2, len - 2, rule);
+	} else if (arr_app(&glob->rules, &rule) == ARR_END) {
+		log_error("cutils", "fglob", NULL, "failed to add pattern: %.*s", (int)len, pattern);
+		return 1;
+	}
+
+	glob->cnt++;
+	return 0;
+}
+
+int fglob_add_file(fglob_t *glob, const char *path)
+{
+	if (glob == NULL || path == NULL) {
+		return 1;
+	}
+
+	freader_t reader = { 0 };
+	if (freader_open(&reader, path, 4096) == NULL) {
+		return 1;
+	}
+
+	int ret = 0;
+
+	str_t line;
+	freader_foreach_line(&reader, &line)
+	{
+		ret |= fglob_add(glob, line.data, line.len);
+	}
+
+	freader_free(&reader);
+	return ret;
+}
+
+static int class_match(const char *pat, size_t len, size_t *p, char c)
+{
+	size_t i = *p;
+
+	bool negate = 0;
+	if (i < len && (pat[i] == '!' || pat[i] == '^')) {
+		negate = 1;
+		i++;
+	}
+
+	bool match = 0;
+	bool first = 1;
+	for (; i < len && (first || pat[i] != ']'); i++, first = 0) {
+		char lo = pat[i];
+		if (lo == '\\' && i + 1 < len) {
+			lo = pat[++i];
+		}
+
+		char hi = lo;
+		if (i + 2 < len && pat[i + 1] == '-' && pat[i + 2] != ']') {
+			i += 2;
+			hi = pat[i];
+			if (hi == '\\' && i + 1 < len) {
+				hi = pat[++i];
+			}
+		}
+
+		if ((unsigned char)c >= (unsigned char)lo && (unsigned char)c <= (unsigned char)hi) {
+			match = 1;
+		}
+	}
+
+	if (i >= len) {
+		return -1;
+	}
+
+	*p = i + 1;
+	return match != negate;
+}
+
+static int seg_match(const char *pat, size_t plen, const char *str, size_t slen)
+{
+	size_t p      = 0;
+	size_t s      = 0;
+	size_t star_p = (size_t)-1;
+	size_t star_s = 0;
+
+	while (s < slen) {
+		if (p < plen) {
+			const char c = pat[p];
+
+			if (c == '*') {
+				star_p = ++p;
+				star_s = s;
+				continue;
+			}
+
+			size_t next = p + 1;
+			int match;
+			if (c == '?') {
+				match = 1;
+			} else if (c == '[') {
+				match = class_match(pat, plen, &next, str[s]);
+				if (match < 0) {
+					match = str[s] == '[';
+					next  = p + 1;
+				}
+			} else if (c == '\\' && p + 1 < plen) {
+				match = str[s] == pat[p + 1];
+				next  = p + 2;
+			} else {
+				match = str[s] == c;
+			}
+
+			if (match) {
+				p = next;
+				s++;
+				continue;
+			}
+		}
+
+		if (star_p == (size_t)-1) {
+			return 0;
+		}
+
+		p = star_p;
+		s = ++star_s;
+	}
+
+	while (p < plen && pat[p] == '*') {
+		p++;
+	}
+
+	return p == plen;
+}
+
+static size_t seg_end(const char *path, size_t len, size_t s)
+{
+	while (s < len && !is_sep(path[s])) {
+		s++;
+	}
+	return s;
+}
+
+static int path_match(const fglob_rule_t *rule, const char *path, size_t len)
+{
+	uint p	      = 0;
+	size_t s      = 0;
+	uint star_p   = FGLOB_NONE;
+	size_t star_s = 0;
+
+	while (s < len) {
+		if (p == rule->segs_cnt && rule->sub) {
+			return 1;
+		}
+
+		const size_t e = seg_end(path, len, s);
+
+		if (p < rule->segs_cnt) {
+			const fglob_seg_t *seg = &rule->segs[p];
+
+			if (seg->globstar) {
+				star_p = ++p;
+				star_s = s;
+				continue;
+			}
+
+			if (seg_match(seg->pat, seg->len, path + s, e - s)) {
+				p++;
+				s = e < len ? e + 1 : len;
+				continue;
+			}
+		}
+
+		if (star_p == FGLOB_NONE) {
+			return 0;
+		}
+
+		p      = star_p;
+		star_s = seg_end(path, len, star_s);
+		star_s = star_s < len ? star_s + 1 : len;
+		s      = star_s;
+	}
+
+	while (p < rule->segs_cnt && rule->segs[p].globstar) {
+		p++;
+	}
+
+	return p == rule->segs_cnt && !rule->sub;
+}
+
+static const fglob_rule_t *chain_find(const fglob_rule_t *rule, bool folder)
+{
+	while (rule != NULL && rule->folder && !folder) {
+		rule = rule->prev;
+	}
+	return rule;
+}
+
+int fglob_match(const fglob_t *glob, const char *path, size_t len, bool folder)
+{
+	if (glob == NULL || path == NULL || glob->cnt == 0) {
+		return 0;
+	}
+
+	size_t name = len;
+	while (name > 0 && !is_sep(path[name - 1])) {
+		name--;
+	}
+
+	const char *base      = path + name;
+	const size_t base_len = len - name;
+
+	const fglob_rule_t *best = NULL;
+
+	void *val;
+	if (glob->names.count > 0 && dict_get(&glob->names, base, base_len, &val) == 0) {
+		best = chain_find(val, folder);
+	}
+
+	if (glob->exts.count > 0) {
+		size_t dot = base_len;
+		while (dot > 0 && base[dot - 1] != '.') {
+			dot--;
+		}
+
+		if (dot > 0 && dict_get(&glob->exts, base + dot, base_len - dot, &val) == 0) {
+			const fglob_rule_t *rule = chain_find(val, folder);
+			if (rule != NULL && (best == NULL || rule->index > best->index)) {
+				best = rule;
+			}
+		}
+	}
+
+	for (uint i = glob->rules.cnt; i > 0; i--) {
+		const fglob_rule_t *rule = *(fglob_rule_t **)arr_get(&glob->rules, i - 1);
+		if (best != NULL && rule->index < best->index) {
+			break;
+		}
+
+		if (rule->folder && !folder) {
+			continue;
+		}
+
+		const int match = rule->anchored ? path_match(rule, path, len) : seg_match(rule->segs[0].pat, rule->segs[0].len, base, base_len);
+		if (match) {
+			best = rule;
+			break;
+		}
+	}
+
+	return best != NULL && !best->negate;
+}
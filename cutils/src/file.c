@@ -2,6 +2,7 @@
 
 #include "arr.h"
 #include "cstr.h"
+#include "finfo.h"
 #include "log.h"
 #include "mem.h"
 #include "path.h"
@@ -15,9 +16,17 @@
 #else
 	#include <dirent.h>
 	#include <errno.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
 	#include <sys/stat.h>
+	#include <unistd.h>
 #endif
 
+static int is_write(const char *mode)
+{
+	return cstr_chr(mode, 'w') || cstr_chr(mode, 'a') || cstr_chr(mode, '+');
+}
+
 FILE *file_open(const char *path, const char *mode)
 {
 	if (path == NULL || mode == NULL) {
@@ -36,12 +45,19 @@ FILE *file_open(const char *path, const char *mode)
 		int errnum = errno;
 		log_error("cutils", "file", NULL, "failed to open file \"%s\": %s (%d)", path, log_strerror(errnum), errnum);
 	}
+
+	if (is_write(mode)) {
+		const size_t len = cstr_len(path);
+		finfo_invalidate(path, len);
+		finfo_track(file, path, len);
+	}
+
 	return file;
 }
 
 FILE *file_open_v(const char *format, const char *mode, va_list args)
 {
-	char path[P_MAX_PATH] = { 0 };
+	char path[P_MAX_PATH];
 
 	if (c_sprintv(path, sizeof(path) / sizeof(char), 0, format, args) == 0) {
 		return NULL;
@@ -65,6 +81,8 @@ FILE *file_reopen(const char *path, const char *mode, FILE *file)
 		return NULL;
 	}
 
+	finfo_untrack(file);
+
 	errno = 0;
 #if defined(C_WIN)
 	if (path == NULL) {
@@ -78,6 +96,13 @@ FILE *file_reopen(const char *path, const char *mode, FILE *file)
 		int errnum = errno;
 		log_error("cutils", "file", NULL, "failed to reopen file \"%s\": %s (%d)", path, log_strerror(errnum), errnum);
 	}
+
+	if (path != NULL && is_write(mode)) {
+		const size_t len = cstr_len(path);
+		finfo_invalidate(path, len);
+		finfo_track(file, path, len);
+	}
+
 	return file;
 }
 
@@ -116,14 +141,8 @@ size_t file_read_ft(FILE *file, char *data, size_t data_size)
 	}
 
 	const size_t size = file_read(file, data_size, data, data_size);
+	const size_t len  = cstr_remove_chr(data, size, '\r');
 
-	size_t len = 0;
-	for (size_t i = 0; i < size; i++) {
-		data[len] = data[i];
-		if (data[i] != '\r') {
-			len++;
-		}
-	}
 	data[len] = '\0';
 
 	return len;
@@ -155,12 +174,95 @@ size_t file_size(FILE *file)
 	return size;
 }
 
+static void *map_file(const char *path, size_t *size, int cow)
+{
+	if (path == NULL || size == NULL) {
+		return NULL;
+	}
+
+	*size = 0;
+
+#if defined(C_WIN)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return NULL;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, cow ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL) {
+		return NULL;
+	}
+
+	void *data = MapViewOfFile(mapping, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (data == NULL) {
+		return NULL;
+	}
+
+	*size = (size_t)file_size.QuadPart;
+	return data;
+#else
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+
+	void *data = mmap(NULL, (size_t)st.st_size, cow ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return NULL;
+	}
+
+	*size = (size_t)st.st_size;
+	return data;
+#endif
+}
+
+void *file_map(const char *path, size_t *size)
+{
+	return map_file(path, size, 0);
+}
+
+void *file_map_cow(const char *path, size_t *size)
+{
+	return map_file(path, size, 1);
+}
+
+void file_unmap(void *data, size_t size)
+{
+	if (data == NULL || size == 0) {
+		return;
+	}
+
+#if defined(C_WIN)
+	(void)size;
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
 int file_close(FILE *file)
 {
 	if (file == NULL) {
 		return EOF;
 	}
 
+	fflush(file);
+	finfo_untrack(file);
 	return fclose(file);
 }
 
@@ -182,6 +284,8 @@ int file_delete(const char *path)
 		ret = 1;
 	}
 #endif
+
+	finfo_invalidate(path, cstr_len(path));
 	return ret;
 }
 
@@ -206,7 +310,7 @@ int file_exists(const char *path)
 
 int file_exists_v(const char *format, va_list args)
 {
-	char path[P_MAX_PATH] = { 0 };
+	char path[P_MAX_PATH];
 
 	if (c_sprintv(path, sizeof(path) / sizeof(char), 0, format, args) == 0) {
 		return 0;
@@ -230,20 +334,24 @@ int folder_create(const char *path)
 		return 1;
 	}
 
+	int ret;
 #if defined(C_WIN)
-	return CreateDirectoryA(path, NULL) == 0 ? 1 : 0 || ERROR_ALREADY_EXISTS == GetLastError();
+	ret = CreateDirectoryA(path, NULL) == 0 ? 1 : 0 || ERROR_ALREADY_EXISTS == GetLastError();
 #else
 	struct stat st = { 0 };
 	if (stat(path, &st) == -1) {
 		mkdir(path, 0700);
 	}
-	return 0;
+	ret = 0;
 #endif
+
+	finfo_invalidate(path, cstr_len(path));
+	return ret;
 }
 
 int folder_create_v(const char *format, va_list args)
 {
-	char path[P_MAX_PATH] = { 0 };
+	char path[P_MAX_PATH];
 
 	if (c_sprintv(path, sizeof(path) / sizeof(char), 0, format, args) == 0) {
 		return 1;
@@ -263,16 +371,24 @@ int folder_create_f(const char *format, ...)
 
 int folder_delete(const char *path)
 {
+	if (path == NULL) {
+		return 1;
+	}
+
+	int ret;
 #if defined(C_WIN)
-	return RemoveDirectoryA(path) == 0 ? 1 : 0;
+	ret = RemoveDirectoryA(path) == 0 ? 1 : 0;
 #else
-	return remove(path) == 0 ? 0 : 1;
+	ret = remove(path) == 0 ? 0 : 1;
 #endif
+
+	finfo_invalidate(path, cstr_len(path));
+	return ret;
 }
 
 int folder_delete_v(const char *format, va_list args)
 {
-	char path[P_MAX_PATH] = { 0 };
+	char path[P_MAX_PATH];
 
 	if (c_sprintv(path, sizeof(path) / sizeof(char), 0, format, args) == 0) {
 		return 1;
@@ -300,19 +416,14 @@ int folder_exists(const char *path)
 	int dwAttrib = GetFileAttributesA(path);
 	return dwAttrib != INVALID_FILE_ATTRIBUTES && (dwAttrib & FILE_ATTRIBUTE_DIRECTORY);
 #else
-	DIR *dir = opendir(path);
-	if (dir) {
-		closedir(dir);
-		return 1;
-	} else {
-		return 0;
-	}
+	struct stat buffer;
+	return stat(path, &buffer) == 0 && S_ISDIR(buffer.st_mode);
 #endif
 }
 
 int folder_exists_v(const char *format, va_list args)
 {
-	char path[P_MAX_PATH] = { 0 };
+	char path[P_MAX_PATH];
 
 	if (c_sprintv(path, sizeof(path) / sizeof(char), 0, format, args) == 0) {
 		return 0;
@@ -0,0 +1,364 @@
+#if !defined(_WIN32)
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "finfo.h"
+
+#include "arena.h"
+#include "dict.h"
+#include "log.h"
+#include "mem.h"
+#include "platform.h"
+#include "thread.h"
+
+#if defined(C_WIN)
+#else
+	#include <sys/stat.h>
+#endif
+
+#define FINFO_ARENA_SIZE (16 * 1024)
+#define FINFO_BATCH_SIZE 64
+#define FINFO_CACHE_MAX	 (64 * 1024)
+
+typedef struct finfo_ent_s {
+	finfo_t info;
+	uint gen;
+	uint ver;
+} finfo_ent_t;
+
+typedef struct finfo_track_s finfo_track_t;
+
+struct finfo_track_s {
+	finfo_track_t *next;
+	const void *file;
+	size_t len;
+	char path[];
+};
+
+typedef struct finfo_cache_s {
+	mutex_t lock;
+	bool init;
+	dict_t dict;
+	arena_t arena;
+	uint gen;
+	finfo_track_t *tracked;
+} finfo_cache_t;
+
+static finfo_cache_t s_cache = {
+	.lock = MUTEX_INIT,
+};
+
+int finfo_stat(const char *path, finfo_t *info)
+{
+	if (path == NULL || info == NULL) {
+		return 1;
+	}
+
+	info->type  = FINFO_NONE;
+	info->size  = 0;
+	info->mtime = 0;
+	info->ino   = 0;
+
+#if defined(C_WIN)
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) {
+		return 1;
+	}
+
+	const u64 time = ((u64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+
+	info->type  = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ? FINFO_FOLDER : FINFO_FILE;
+	info->size  = ((u64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	info->mtime = time > 116444736000000000ULL ? (time - 116444736000000000ULL) * 100 : 0;
+#else
+	struct stat st;
+	if (stat(path, &st)) {
+		return 1;
+	}
+
+	info->type  = S_ISREG(st.st_mode) ? FINFO_FILE : S_ISDIR(st.st_mode) ? FINFO_FOLDER : FINFO_OTHER;
+	info->size  = (u64)st.st_size;
+	info->mtime = (u64)st.st_mtim.tv_sec * 1000000000ULL + (u64)st.st_mtim.tv_nsec;
+	info->ino   = (u64)st.st_ino;
+#endif
+
+	return 0;
+}
+
+static int cache_init()
+{
+	if (s_cache.init) {
+		return 0;
+	}
+
+	if (dict_init(&s_cache.dict, 64) == NULL) {
+		log_error("cutils", "finfo", NULL, "failed to create cache");
+		return 1;
+	}
+
+	arena_init(&s_cache.arena, FINFO_ARENA_SIZE);
+	s_cache.gen  = 1;
+	s_cache.init = 1;
+
+	return 0;
+}
+
+static finfo_ent_t *cache_ent(const char *path, size_t len)
+{
+	void *val;
+	if (dict_get(&s_cache.dict, path, len, &val) == 0) {
+		return val;
+	}
+
+	if (s_cache.dict.count >= FINFO_CACHE_MAX) {
+		dict_free(&s_cache.dict);
+		arena_reset(&s_cache.arena);
+		s_cache.gen++;
+		if (dict_init(&s_cache.dict, 64) == NULL) {
+			log_error("cutils", "finfo", NULL, "failed to create cache");
+			s_cache.init = 0;
+			return NULL;
+		}
+	}
+
+	finfo_ent_t *ent = arena_alloc(&s_cache.arena, sizeof(finfo_ent_t));
+	const char *key	 = arena_strn(&s_cache.arena, path, len);
+	if (ent == NULL || key == NULL) {
+		log_error("cutils", "finfo", NULL, "failed to cache path: %.*s", (int)len, path);
+		return NULL;
+	}
+
+	ent->gen = 0;
+	ent->ver = 0;
+
+	dict_set(&s_cache.dict, key, len, ent);
+	return ent;
+}
+
+int finfo_get(const char *path, size_t len, finfo_t *info)
+{
+	if (path == NULL || info == NULL) {
+		return 1;
+	}
+
+	char buf[P_MAX_PATH];
+	if (len >= sizeof(buf)) {
+		log_error("cutils", "finfo", NULL, "path too long: %.*s", (int)len, path);
+		return 1;
+	}
+
+	mem_cpy(buf, sizeof(buf), path, len);
+	buf[len] = '\0';
+
+	mutex_lock(&s_cache.lock);
+
+	finfo_ent_t *ent = cache_init() ? NULL : cache_ent(path, len);
+	if (ent == NULL) {
+		mutex_unlock(&s_cache.lock);
+		return 1;
+	}
+
+	if (ent->gen == s_cache.gen) {
+		*info = ent->info;
+		mutex_unlock(&s_cache.lock);
+		return info->type == FINFO_NONE;
+	}
+
+	const uint gen = s_cache.gen;
+	const uint ver = ent->ver;
+	mutex_unlock(&s_cache.lock);
+
+	finfo_stat(buf, info);
+
+	mutex_lock(&s_cache.lock);
+	if (s_cache.gen == gen && ent->ver == ver) {
+		ent->info = *info;
+		ent->gen  = gen;
+	}
+	mutex_unlock(&s_cache.lock);
+
+	return info->type == FINFO_NONE;
+}
+
+typedef struct finfo_batch_s {
+	finfo_query_t *queries;
+	uint cnt;
+	mutex_t lock;
+	uint next;
+} finfo_batch_t;
+
+static void batch_run(void *priv)
+{
+	finfo_batch_t *batch = priv;
+
+	for (;;) {
+		mutex_lock(&batch->lock);
+		const uint start = batch->next;
+		batch->next += FINFO_BATCH_SIZE;
+		mutex_unlock(&batch->lock);
+
+		if (start >= batch->cnt) {
+			break;
+		}
+
+		const uint end = start + FINFO_BATCH_SIZE < batch->cnt ? start + FINFO_BATCH_SIZE : batch->cnt;
+		for (uint i = start; i < end; i++) {
+			finfo_query_t *query = &batch->queries[i];
+			finfo_get(query->path, query->len, &query->info);
+		}
+	}
+}
+
+int finfo_batch(finfo_query_t *queries, uint cnt, uint threads)
+{
+	if (queries == NULL) {
+		return 1;
+	}
+
+	if (threads == 0) {
+		threads = thread_cpu_cnt();
+	}
+
+	const uint max = (cnt + FINFO_BATCH_SIZE - 1) / FINFO_BATCH_SIZE;
+	if (threads > max) {
+		threads = max;
+	}
+
+	finfo_batch_t batch = {
+		.queries = queries,
+		.cnt	 = cnt,
+	};
+
+	if (threads <= 1) {
+		mutex_init(&batch.lock);
+		batch_run(&batch);
+		mutex_free(&batch.lock);
+		return 0;
+	}
+
+	thread_t *workers = mem_alloc(threads * sizeof(thread_t));
+	if (workers == NULL) {
+		log_error("cutils", "finfo", NULL, "failed to allocate workers");
+		return 1;
+	}
+
+	mutex_init(&batch.lock);
+
+	uint started = 0;
+	for (uint i = 1; i < threads; i++) {
+		if (thread_create(&workers[started], batch_run, &batch) == 0) {
+			started++;
+		}
+	}
+
+	batch_run(&batch);
+
+	for (uint i = 0; i < started; i++) {
+		thread_join(&workers[i]);
+	}
+
+	mutex_free(&batch.lock);
+	mem_free(workers, threads * sizeof(thread_t));
+
+	return 0;
+}
+
+void finfo_invalidate(const char *path, size_t len)
+{
+	if (path == NULL) {
+		return;
+	}
+
+	mutex_lock(&s_cache.lock);
+
+	void *val;
+	if (s_cache.init && dict_get(&s_cache.dict, path, len, &val) == 0) {
+		finfo_ent_t *ent = val;
+		ent->gen	 = 0;
+		ent->ver++;
+	}
+
+	mutex_unlock(&s_cache.lock);
+}
+
+void finfo_track(const void *file, const char *path, size_t len)
+{
+	if (file == NULL || path == NULL) {
+		return;
+	}
+
+	finfo_track_t *track = mem_alloc(sizeof(finfo_track_t) + len + 1);
+	if (track == NULL) {
+		log_error("cutils", "finfo", NULL, "failed to track file: %.*s", (int)len, path);
+		return;
+	}
+
+	track->next = NULL;
+	track->file = file;
+	track->len  = len;
+	mem_cpy(track->path, len + 1, path, len);
+	track->path[len] = '\0';
+
+	mutex_lock(&s_cache.lock);
+
+	finfo_track_t **last = &s_cache.tracked;
+	while (*last != NULL) {
+		last = &(*last)->next;
+	}
+	*last = track;
+
+	mutex_unlock(&s_cache.lock);
+}
+
+void finfo_untrack(const void *file)
+{
+	if (file == NULL) {
+		return;
+	}
+
+	mutex_lock(&s_cache.lock);
+
+	finfo_track_t *track = NULL;
+	for (finfo_track_t **cur = &s_cache.tracked; *cur != NULL; cur = &(*cur)->next) {
+		if ((*cur)->file == file) {
+			track = *cur;
+			*cur  = track->next;
+			break;
+		}
+	}
+
+	mutex_unlock(&s_cache.lock);
+
+	if (track == NULL) {
+		return;
+	}
+
+	finfo_invalidate(track->path, track->len);
+	mem_free(track, sizeof(finfo_track_t) + track->len + 1);
+}
+
+void finfo_invalidate_all()
+{
+	mutex_lock(&s_cache.lock);
+	s_cache.gen++;
+	mutex_unlock(&s_cache.lock);
+}
+
+void finfo_free()
+{
+	mutex_lock(&s_cache.lock);
+
+	if (s_cache.init) {
+		dict_free(&s_cache.dict);
+		arena_free(&s_cache.arena);
+		s_cache.init = 0;
+	}
+
+	while (s_cache.tracked != NULL) {
+		finfo_track_t *track = s_cache.tracked;
+		s_cache.tracked	     = track->next;
+		mem_free(track, sizeof(finfo_track_t) + track->len + 1);
+	}
+
+	mutex_unlock(&s_cache.lock);
+}
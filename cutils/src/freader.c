@@ -0,0 +1,321 @@
+#if !defined(_WIN32)
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "freader.h"
+
+#include "file.h"
+#include "log.h"
+#include "mem.h"
+#include "platform.h"
+
+#include <string.h>
+
+#if defined(C_WIN)
+#else
+	#include <fcntl.h>
+#endif
+
+freader_t *freader_init(freader_t *reader, size_t size, freader_refill_cb refill, void *priv)
+{
+	if (reader == NULL || size == 0) {
+		return NULL;
+	}
+
+	reader->bufs[0] = mem_alloc(size);
+	if (reader->bufs[0] == NULL) {
+		log_error("cutils", "freader", NULL, "failed to allocate buffer");
+		return NULL;
+	}
+
+	reader->bufs[1] = mem_alloc(size);
+	if (reader->bufs[1] == NULL) {
+		log_error("cutils", "freader", NULL, "failed to allocate buffer");
+		mem_free(reader->bufs[0], size);
+		reader->bufs[0] = NULL;
+		return NULL;
+	}
+
+	reader->file   = NULL;
+	reader->refill = refill;
+	reader->priv   = priv;
+	reader->size   = size;
+	reader->cur    = 0;
+	reader->start  = 0;
+	reader->len    = 0;
+	reader->off    = 0;
+	reader->advice = FREADER_ADVICE_NORMAL;
+	reader->eof    = 0;
+
+	return reader;
+}
+
+freader_t *freader_open(freader_t *reader, const char *path, size_t size)
+{
+	if (reader == NULL || path == NULL) {
+		return NULL;
+	}
+
+	FILE *file = file_open(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	if (freader_init(reader, size, NULL, NULL) == NULL) {
+		file_close(file);
+		return NULL;
+	}
+
+	setvbuf(file, NULL, _IONBF, 0);
+	reader->file = file;
+
+	return reader;
+}
+
+void freader_free(freader_t *reader)
+{
+	if (reader == NULL) {
+		return;
+	}
+
+	if (reader->file) {
+		file_close(reader->file);
+		reader->file = NULL;
+	}
+
+	mem_free(reader->bufs[0], reader->size);
+	mem_free(reader->bufs[1], reader->size);
+	reader->bufs[0] = NULL;
+	reader->bufs[1] = NULL;
+	reader->size	= 0;
+	reader->start	= 0;
+	reader->len	= 0;
+}
+
+static int advise(FILE *file, size_t off, size_t len, freader_advice_t advice)
+{
+#if defined(C_WIN)
+	(void)file;
+	(void)off;
+	(void)len;
+	(void)advice;
+	return 0;
+#else
+	int adv;
+	switch (advice) {
+	case FREADER_ADVICE_SEQUENTIAL: adv = POSIX_FADV_SEQUENTIAL; break;
+	case FREADER_ADVICE_WILLNEED: adv = POSIX_FADV_WILLNEED; break;
+	case FREADER_ADVICE_DONTNEED: adv = POSIX_FADV_DONTNEED; break;
+	default: adv = POSIX_FADV_NORMAL; break;
+	}
+
+	return posix_fadvise(fileno(file), (off_t)off, (off_t)len, adv) == 0 ? 0 : 1;
+#endif
+}
+
+int freader_advise(freader_t *reader, freader_advice_t advice)
+{
+	if (reader == NULL) {
+		return 1;
+	}
+
+	reader->advice = advice;
+
+	if (reader->file == NULL) {
+		return 0;
+	}
+
+	if (advice == FREADER_ADVICE_DONTNEED) {
+		return reader->off > 0 ? advise(reader->file, 0, reader->off, advice) : 0;
+	}
+
+	return advise(reader->file, 0, 0, advice);
+}
+
+static size_t source_read(freader_t *reader, char *data, size_t size)
+{
+	if (reader->eof || size == 0) {
+		return 0;
+	}
+
+	size_t cnt;
+	if (reader->file) {
+		cnt = fread(data, 1, size, reader->file);
+	} else if (reader->refill) {
+		cnt = reader->refill(reader->priv, data, size);
+	} else {
+		cnt = 0;
+	}
+
+	if (cnt == 0) {
+		reader->eof = 1;
+		return 0;
+	}
+
+	if (reader->file) {
+		const size_t end = reader->off + reader->len + cnt;
+		switch (reader->advice) {
+		case FREADER_ADVICE_SEQUENTIAL:
+		case FREADER_ADVICE_WILLNEED: advise(reader->file, end, reader->size, FREADER_ADVICE_WILLNEED); break;
+		case FREADER_ADVICE_DONTNEED:
+			if (reader->off > 0) {
+				advise(reader->file, 0, reader->off, FREADER_ADVICE_DONTNEED);
+			}
+			break;
+		default: break;
+		}
+	}
+
+	return cnt;
+}
+
+static size_t fill(freader_t *reader)
+{
+	const size_t rem = reader->len - reader->start;
+	const uint next	 = reader->cur ^ 1;
+
+	if (rem > 0) {
+		mem_cpy(reader->bufs[next], reader->size, reader->bufs[reader->cur] + reader->start, rem);
+	}
+
+	reader->off += reader->start;
+	reader->cur   = next;
+	reader->start = 0;
+	reader->len   = rem;
+
+	const size_t cnt = source_read(reader, reader->bufs[reader->cur] + rem, reader->size - rem);
+	reader->len += cnt;
+	return cnt;
+}
+
+size_t freader_read(freader_t *reader, char *data, size_t size)
+{
+	if (reader == NULL || data == NULL || reader->bufs[0] == NULL) {
+		return 0;
+	}
+
+	size_t cnt = 0;
+	while (cnt < size) {
+		if (reader->start == reader->len) {
+			if (size - cnt >= reader->size) {
+				reader->off += reader->len;
+				reader->start = 0;
+				reader->len   = 0;
+
+				const size_t read = source_read(reader, data + cnt, size - cnt);
+				reader->off += read;
+				cnt += read;
+				if (read == 0) {
+					break;
+				}
+				continue;
+			}
+
+			if (fill(reader) == 0) {
+				break;
+			}
+		}
+
+		size_t len = reader->len - reader->start;
+		if (len > size - cnt) {
+			len = size - cnt;
+		}
+
+		mem_cpy(data + cnt, size - cnt, reader->bufs[reader->cur] + reader->start, len);
+		reader->start += len;
+		cnt += len;
+	}
+
+	return cnt;
+}
+
+int freader_chunk(freader_t *reader, str_t *chunk)
+{
+	if (reader == NULL || chunk == NULL || reader->bufs[0] == NULL) {
+		return 1;
+	}
+
+	if (reader->start == reader->len && fill(reader) == 0) {
+		return 1;
+	}
+
+	*chunk	      = strc(reader->bufs[reader->cur] + reader->start, reader->len - reader->start);
+	reader->start = reader->len;
+	return 0;
+}
+
+static int grow(freader_t *reader)
+{
+	const size_t size = reader->size * 2;
+	const uint next	  = reader->cur ^ 1;
+
+	char *data = mem_alloc(size);
+	if (data == NULL) {
+		log_error("cutils", "freader", NULL, "record too long: failed to grow buffer to %zu bytes", size);
+		return 1;
+	}
+
+	char *cur = mem_realloc(reader->bufs[reader->cur], size, reader->size);
+	if (cur == NULL) {
+		log_error("cutils", "freader", NULL, "record too long: failed to grow buffer to %zu bytes", size);
+		mem_free(data, size);
+		return 1;
+	}
+
+	mem_free(reader->bufs[next], reader->size);
+	reader->bufs[reader->cur] = cur;
+	reader->bufs[next]	  = data;
+	reader->size		  = size;
+
+	return 0;
+}
+
+int freader_record(freader_t *reader, char delim, str_t *record)
+{
+	if (reader == NULL || record == NULL || reader->bufs[0] == NULL) {
+		return 1;
+	}
+
+	size_t scan = reader->start;
+
+	for (;;) {
+		const char *buf = reader->bufs[reader->cur];
+		const char *end = memchr(buf + scan, delim, reader->len - scan);
+
+		if (end != NULL) {
+			*record	      = strc(buf + reader->start, (size_t)(end - buf) - reader->start);
+			reader->start = (size_t)(end - buf) + 1;
+			return 0;
+		}
+
+		if (reader->eof) {
+			if (reader->start == reader->len) {
+				return 1;
+			}
+
+			*record	      = strc(buf + reader->start, reader->len - reader->start);
+			reader->start = reader->len;
+			return 0;
+		}
+
+		if (reader->len - reader->start == reader->size && grow(reader)) {
+			return 1;
+		}
+
+		scan = reader->len - reader->start;
+		fill(reader);
+	}
+}
+
+int freader_line(freader_t *reader, str_t *line)
+{
+	if (freader_record(reader, '\n', line)) {
+		return 1;
+	}
+
+	if (line->len > 0 && line->data[line->len - 1] == '\r') {
+		line->len--;
+	}
+
+	return 0;
+}
@@ -0,0 +1,275 @@
+#if !defined(_WIN32)
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fsink.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "finfo.h"
+#include "log.h"
+#include "mem.h"
+#include "platform.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#if defined(C_WIN)
+	#include <io.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#define FSINK_TMP_TRIES 64
+
+FILE *fsink_open(fsink_t *sink, const char *path, fsink_stats_t *stats)
+{
+	if (sink == NULL || path == NULL) {
+		return NULL;
+	}
+
+	if (path_init(&sink->path, path, cstr_len(path)) == NULL) {
+		log_error("cutils", "fsink", NULL, "path too long: %s", path);
+		return NULL;
+	}
+
+	sink->data  = NULL;
+	sink->size  = 0;
+	sink->stats = stats;
+
+#if defined(C_WIN)
+	tmpfile_s(&sink->file);
+#else
+	sink->file = open_memstream(&sink->data, &sink->size);
+#endif
+	if (sink->file == NULL) {
+		log_error("cutils", "fsink", NULL, "failed to create buffer for: %s", path);
+		return NULL;
+	}
+
+	return sink->file;
+}
+
+static int content_same(const char *path, const char *data, size_t size)
+{
+	finfo_t info;
+	if (finfo_stat(path, &info) || info.type != FINFO_FILE || info.size != size) {
+		return 0;
+	}
+
+	if (size == 0) {
+		return 1;
+	}
+
+	size_t old_size;
+	void *old = file_map(path, &old_size);
+	if (old == NULL) {
+		return 0;
+	}
+
+	const int same = old_size == size && mem_cmp(old, data, size) == 0;
+
+	file_unmap(old, old_size);
+	return same;
+}
+
+static FILE *tmp_open(const char *path, size_t len, char *tmp, size_t size)
+{
+#if defined(C_WIN)
+	const uint pid = (uint)GetCurrentProcessId();
+#else
+	const uint pid = (uint)getpid();
+
+	struct stat st;
+	const int exists  = stat(path, &st) == 0;
+	const mode_t mode = exists ? st.st_mode & 07777 : 0666;
+#endif
+
+	// the buffer lives on the caller's stack, so its address differs between concurrent writers
+	const uint seed = (uint)(uintptr_t)tmp;
+
+	for (uint i = 0; i < FSINK_TMP_TRIES; i++) {
+		if (c_sprintf(tmp, size, 0, "%.*s.%x.%x.tmp", (int)len, path, pid, seed + i) == 0) {
+			log_error("cutils", "fsink", NULL, "path too long: %s", path);
+			return NULL;
+		}
+
+		errno = 0;
+#if defined(C_WIN)
+		FILE *file = NULL;
+		if (fopen_s(&file, tmp, "wbx") == 0) {
+			return file;
+		}
+#else
+		const int fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL, mode);
+		if (fd >= 0) {
+			FILE *file = NULL;
+			if ((exists == 0 || fchmod(fd, mode) == 0) && (file = fdopen(fd, "wb")) != NULL) {
+				return file;
+			}
+
+			close(fd);
+			remove(tmp);
+			break;
+		}
+#endif
+		if (errno != EEXIST) {
+			break;
+		}
+	}
+
+	int errnum = errno;
+	log_error("cutils", "fsink", NULL, "failed to create temporary file for \"%s\": %s (%d)", path, log_strerror(errnum), errnum);
+	return NULL;
+}
+
+static int file_sync(FILE *file)
+{
+	if (fflush(file)) {
+		return 1;
+	}
+
+#if defined(C_WIN)
+	return _commit(_fileno(file)) ? 1 : 0;
+#else
+	return fsync(fileno(file)) ? 1 : 0;
+#endif
+}
+
+static int dir_sync(const char *path, size_t len)
+{
+#if defined(C_WIN)
+	(void)path;
+	(void)len;
+	return 0;
+#else
+	char dir[P_MAX_PATH] = ".";
+
+	size_t dir_len = len;
+	while (dir_len > 0 && path[dir_len - 1] != '/') {
+		dir_len--;
+	}
+
+	if (dir_len > 0) {
+		mem_cpy(dir, sizeof(dir), path, dir_len);
+		dir[dir_len] = '\0';
+	}
+
+	const int fd = open(dir, O_RDONLY);
+	if (fd < 0) {
+		return 1;
+	}
+
+	const int ret = fsync(fd) ? 1 : 0;
+	close(fd);
+	return ret;
+#endif
+}
+
+static int write_atomic(const char *path, size_t len, const char *data, size_t size)
+{
+	char tmp[P_MAX_PATH];
+	FILE *file = tmp_open(path, len, tmp, sizeof(tmp));
+	if (file == NULL) {
+		return 1;
+	}
+
+	int ret = (size > 0 && fwrite(data, 1, size, file) != size) || file_sync(file);
+	if (file_close(file)) {
+		ret = 1;
+	}
+
+	if (ret == 0) {
+#if defined(C_WIN)
+		ret = MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : 1;
+#else
+		ret = rename(tmp, path) ? 1 : 0;
+#endif
+	}
+
+	if (ret) {
+		remove(tmp);
+	} else {
+		ret = dir_sync(path, len);
+	}
+
+	if (ret) {
+		log_error("cutils", "fsink", NULL, "failed to write file: %s", path);
+	}
+
+	finfo_invalidate(path, len);
+	return ret;
+}
+
+int fsink_close(fsink_t *sink)
+{
+	if (sink == NULL || sink->file == NULL) {
+		return 1;
+	}
+
+#if defined(C_WIN)
+	fflush(sink->file);
+	sink->size = file_size(sink->file);
+	sink->data = mem_alloc(sink->size + 1);
+	if (sink->data == NULL || file_read(sink->file, sink->size, sink->data, sink->size + 1) != sink->size) {
+		log_error("cutils", "fsink", NULL, "failed to read buffer for: %s", sink->path.path);
+		mem_free(sink->data, sink->size + 1);
+		file_close(sink->file);
+		sink->file = NULL;
+		sink->data = NULL;
+		return 1;
+	}
+	file_close(sink->file);
+#else
+	if (file_close(sink->file)) {
+		log_error("cutils", "fsink", NULL, "failed to flush buffer for: %s", sink->path.path);
+		free(sink->data);
+		sink->file = NULL;
+		sink->data = NULL;
+		return 1;
+	}
+#endif
+	sink->file = NULL;
+
+	int ret	   = 0;
+	bool write = !content_same(sink->path.path, sink->data, sink->size);
+
+	if (write) {
+		ret = write_atomic(sink->path.path, sink->path.len, sink->data, sink->size);
+	}
+
+	if (ret == 0 && sink->stats) {
+		if (write) {
+			sink->stats->written++;
+		} else {
+			sink->stats->skipped++;
+		}
+	}
+
+#if defined(C_WIN)
+	mem_free(sink->data, sink->size + 1);
+#else
+	free(sink->data);
+#endif
+	sink->data = NULL;
+	sink->size = 0;
+
+	return ret;
+}
+
+void fsink_abort(fsink_t *sink)
+{
+	if (sink == NULL || sink->file == NULL) {
+		return;
+	}
+
+	file_close(sink->file);
+#if !defined(C_WIN)
+	free(sink->data);
+#endif
+	sink->file = NULL;
+	sink->data = NULL;
+	sink->size = 0;
+}
@@ -0,0 +1,671 @@
+#if !defined(_WIN32)
+	#define _GNU_SOURCE
+#endif
+
+#include "fwalk.h"
+
+#include "arr.h"
+#include "log.h"
+#include "mem.h"
+#include "platform.h"
+#include "thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(C_WIN)
+#else
+	#include <dirent.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#define FWALK_CHUNK_SIZE (16 * 1024)
+#define FWALK_NAME_MAX	 260
+#define FWALK_ENT_MAX	 (FWALK_NAME_MAX + 2)
+#define FWALK_MAX_FDS	 64
+#define FWALK_AHEAD	 4
+
+typedef struct walk_chunk_s walk_chunk_t;
+
+struct walk_chunk_s {
+	walk_chunk_t *next;
+	size_t len;
+	char data[FWALK_CHUNK_SIZE];
+};
+
+typedef struct walk_dir_s walk_dir_t;
+
+typedef struct walk_ent_s {
+	const char *name;
+	size_t len;
+	bool folder;
+	walk_dir_t *dir;
+} walk_ent_t;
+
+typedef enum walk_state_e {
+	WALK_IDLE,
+	WALK_QUEUED,
+	WALK_RUNNING,
+	WALK_DONE,
+} walk_state_t;
+
+struct walk_dir_s {
+	walk_dir_t *parent;
+	walk_dir_t *next;
+	char *path;
+	size_t len;
+	size_t base;
+	const char *name;
+	int fd;
+	int dfd;
+#if defined(C_WIN)
+	HANDLE find;
+	WIN32_FIND_DATAA file;
+	bool more;
+#else
+	DIR *d;
+#endif
+	walk_chunk_t *chunks;
+	walk_chunk_t *last;
+	walk_chunk_t *chunk;
+	walk_state_t state;
+	bool eof;
+	bool listed;
+	bool kept;
+	arr_t ents;
+	uint cur;
+	uint ahead;
+};
+
+typedef struct walk_s {
+	int flags;
+	const fglob_t *ignore;
+	size_t root;
+	files_foreach_cb on_folder;
+	files_foreach_cb on_file;
+	void *priv;
+	thread_t *workers;
+	uint workers_cnt;
+	mutex_t lock;
+	cond_t cond;
+	cond_t done;
+	walk_dir_t *head;
+	walk_dir_t *tail;
+	bool stop;
+	uint ahead;
+	uint ahead_max;
+	uint fds;
+	path_t path;
+} walk_t;
+
+static inline int is_sep(char c)
+{
+	return c == '/' || c == '\\';
+}
+
+static walk_dir_t *dir_new(walk_dir_t *parent, const char *path, size_t len)
+{
+	walk_dir_t *dir = mem_calloc(1, sizeof(walk_dir_t) + len + 3);
+	if (dir == NULL) {
+		log_error("cutils", "fwalk", NULL, "failed to allocate directory: %.*s", (int)len, path);
+		return NULL;
+	}
+
+	dir->path = (char *)(dir + 1);
+	mem_cpy(dir->path, len + 3, path, len);
+
+	dir->parent = parent;
+	dir->len    = len;
+	dir->base   = len;
+	if (len > 0 && !is_sep(path[len - 1])) {
+		dir->path[dir->base++] = SEP[0];
+	}
+	dir->path[dir->base] = '\0';
+
+	dir->name = parent ? dir->path + parent->base : dir->path;
+	dir->fd	  = -1;
+	dir->dfd  = -1;
+#if defined(C_WIN)
+#else
+	if (parent && parent->d) {
+		dir->dfd = dirfd(parent->d);
+	}
+#endif
+
+	return dir;
+}
+
+static int ent_path(walk_t *walk, const walk_dir_t *dir, const walk_ent_t *ent)
+{
+	path_t *path = &walk->path;
+
+	if (dir->base + ent->len + 1 > P_MAX_PATH) {
+		log_warn("cutils", "fwalk", NULL, "path too long: %.*s%.*s", (int)dir->base, dir->path, (int)ent->len, ent->name);
+		return 1;
+	}
+
+	mem_cpy(path->path, P_MAX_PATH, dir->path, dir->base);
+	mem_cpy(path->path + dir->base, P_MAX_PATH - dir->base, ent->name, ent->len);
+	path->len	      = dir->base + ent->len;
+	path->path[path->len] = '\0';
+
+	return 0;
+}
+
+static walk_dir_t *dir_child(walk_t *walk, walk_dir_t *dir, const walk_ent_t *ent)
+{
+	if (ent_path(walk, dir, ent)) {
+		return NULL;
+	}
+
+	return dir_new(dir, walk->path.path, walk->path.len);
+}
+
+static void chunk_add(walk_chunk_t *chunk, const char *name, size_t len, bool folder)
+{
+	chunk->data[chunk->len++] = folder ? 1 : 0;
+	memcpy(chunk->data + chunk->len, name, len);
+	chunk->len += len;
+	chunk->data[chunk->len++] = '\0';
+}
+
+static void dir_read(walk_dir_t *dir)
+{
+	walk_chunk_t *chunk = dir->chunk;
+
+#if defined(C_WIN)
+	if (dir->find == NULL) {
+		dir->path[dir->base]	 = '*';
+		dir->path[dir->base + 1] = '\0';
+		dir->find		 = FindFirstFileA(dir->path, &dir->file);
+		dir->path[dir->base]	 = '\0';
+
+		if (dir->find == INVALID_HANDLE_VALUE) {
+			dir->find = NULL;
+			dir->eof  = 1;
+			return;
+		}
+		dir->more = 1;
+	}
+
+	while (sizeof(chunk->data) - chunk->len >= FWALK_ENT_MAX) {
+		if (!dir->more) {
+			dir->eof = 1;
+			return;
+		}
+
+		const char *name  = dir->file.cFileName;
+		const size_t len  = strlen(name);
+		const DWORD attrs = dir->file.dwFileAttributes;
+
+		if (!(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) && !(attrs & FILE_ATTRIBUTE_REPARSE_POINT) &&
+		    len <= FWALK_NAME_MAX) {
+			chunk_add(chunk, name, len, (attrs & FILE_ATTRIBUTE_DIRECTORY) != 0);
+		}
+
+		dir->more = FindNextFileA(dir->find, &dir->file) != 0;
+	}
+#else
+	if (dir->d == NULL) {
+		int fd = dir->fd;
+		if (fd < 0) {
+			fd = dir->dfd >= 0 ? openat(dir->dfd, dir->name, O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+					   : open(dir->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		}
+		dir->fd = -1;
+
+		if (fd < 0) {
+			dir->eof = 1;
+			return;
+		}
+
+		dir->d = fdopendir(fd);
+		if (dir->d == NULL) {
+			close(fd);
+			dir->eof = 1;
+			return;
+		}
+	}
+
+	while (sizeof(chunk->data) - chunk->len >= FWALK_ENT_MAX) {
+		struct dirent *dp = readdir(dir->d);
+		if (dp == NULL) {
+			dir->eof = 1;
+			return;
+		}
+
+		const char *name = dp->d_name;
+		if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+			continue;
+		}
+
+		int type;
+		switch (dp->d_type) {
+		case DT_DIR: type = 1; break;
+		case DT_REG: type = 0; break;
+		case DT_UNKNOWN: {
+			struct stat st;
+			if (fstatat(dirfd(dir->d), name, &st, AT_SYMLINK_NOFOLLOW)) {
+				type = -1;
+			} else {
+				type = S_ISDIR(st.st_mode) ? 1 : S_ISREG(st.st_mode) ? 0 : -1;
+			}
+			break;
+		}
+		default: type = -1; break;
+		}
+
+		const size_t len = strlen(name);
+		if (type < 0 || len > FWALK_NAME_MAX) {
+			continue;
+		}
+
+		chunk_add(chunk, name, len, type == 1);
+	}
+#endif
+}
+
+static void worker_run(void *priv)
+{
+	walk_t *walk = priv;
+
+	mutex_lock(&walk->lock);
+	for (;;) {
+		while (walk->head == NULL && !walk->stop) {
+			cond_wait(&walk->cond, &walk->lock);
+		}
+
+		walk_dir_t *dir = walk->head;
+		if (dir == NULL) {
+			break;
+		}
+
+		walk->head = dir->next;
+		if (walk->head == NULL) {
+			walk->tail = NULL;
+		}
+		dir->state = WALK_RUNNING;
+		mutex_unlock(&walk->lock);
+
+		dir_read(dir);
+
+		mutex_lock(&walk->lock);
+		dir->state = WALK_DONE;
+		cond_broadcast(&walk->done);
+	}
+	mutex_unlock(&walk->lock);
+}
+
+static int scan_start(walk_t *walk, walk_dir_t *dir)
+{
+	dir->chunk = mem_alloc(sizeof(walk_chunk_t));
+	if (dir->chunk == NULL) {
+		log_error("cutils", "fwalk", NULL, "failed to allocate entries: %.*s", (int)dir->len, dir->path);
+		return 1;
+	}
+
+	dir->chunk->next = NULL;
+	dir->chunk->len	 = 0;
+
+	mutex_lock(&walk->lock);
+	dir->state = WALK_QUEUED;
+	dir->next  = NULL;
+	if (walk->tail) {
+		walk->tail->next = dir;
+	} else {
+		walk->head = dir;
+	}
+	walk->tail = dir;
+	cond_signal(&walk->cond);
+	mutex_unlock(&walk->lock);
+
+	return 0;
+}
+
+static void scan_wait(walk_t *walk, walk_dir_t *dir)
+{
+	mutex_lock(&walk->lock);
+
+	if (dir->state == WALK_QUEUED) {
+		walk_dir_t *prev = NULL;
+		for (walk_dir_t *cur = walk->head; cur != dir; cur = cur->next) {
+			prev = cur;
+		}
+
+		if (prev) {
+			prev->next = dir->next;
+		} else {
+			walk->head = dir->next;
+		}
+		if (walk->tail == dir) {
+			walk->tail = prev;
+		}
+
+		dir->state = WALK_RUNNING;
+		mutex_unlock(&walk->lock);
+
+		dir_read(dir);
+
+		mutex_lock(&walk->lock);
+		dir->state = WALK_DONE;
+	}
+
+	while (dir->state == WALK_RUNNING) {
+		cond_wait(&walk->done, &walk->lock);
+	}
+
+	mutex_unlock(&walk->lock);
+}
+
+static void dir_free(walk_t *walk, walk_dir_t *dir)
+{
+	scan_wait(walk, dir);
+
+	if (dir->chunk) {
+		mem_free(dir->chunk, sizeof(walk_chunk_t));
+	}
+
+	walk_chunk_t *chunk = dir->chunks;
+	while (chunk != NULL) {
+		walk_chunk_t *next = chunk->next;
+		mem_free(chunk, sizeof(walk_chunk_t));
+		chunk = next;
+	}
+
+	walk_ent_t *ent;
+	arr_foreach(&dir->ents, ent)
+	{
+		if (ent->dir) {
+			dir_free(walk, ent->dir);
+		}
+	}
+	arr_free(&dir->ents);
+
+#if defined(C_WIN)
+	if (dir->find) {
+		FindClose(dir->find);
+	}
+#else
+	if (dir->d) {
+		closedir(dir->d);
+	} else if (dir->fd >= 0) {
+		close(dir->fd);
+	}
+#endif
+
+	if (dir->kept) {
+		walk->fds--;
+	}
+
+	mem_free(dir, sizeof(walk_dir_t) + dir->len + 3);
+}
+
+static int ent_cmp_cb(const void *a, const void *b)
+{
+	const walk_ent_t *l = a;
+	const walk_ent_t *r = b;
+
+	const int cmp = mem_cmp(l->name, r->name, l->len < r->len ? l->len : r->len);
+	if (cmp != 0) {
+		return cmp;
+	}
+
+	return l->len < r->len ? -1 : l->len > r->len ? 1 : 0;
+}
+
+static int dir_list(walk_t *walk, walk_dir_t *dir)
+{
+	if (dir->chunk == NULL && dir->last == NULL && scan_start(walk, dir)) {
+		return 1;
+	}
+
+	for (;;) {
+		scan_wait(walk, dir);
+
+		if (dir->last) {
+			dir->last->next = dir->chunk;
+		} else {
+			dir->chunks = dir->chunk;
+		}
+		dir->last  = dir->chunk;
+		dir->chunk = NULL;
+
+		if (dir->eof) {
+			break;
+		}
+
+		if (scan_start(walk, dir)) {
+			return 1;
+		}
+	}
+
+#if defined(C_WIN)
+	if (dir->find) {
+		FindClose(dir->find);
+		dir->find = NULL;
+	}
+#else
+	if (dir->d && walk->fds >= FWALK_MAX_FDS) {
+		closedir(dir->d);
+		dir->d = NULL;
+	} else if (dir->d) {
+		walk->fds++;
+		dir->kept = 1;
+	}
+#endif
+
+	if (arr_init(&dir->ents, 16, sizeof(walk_ent_t)) == NULL) {
+		return 1;
+	}
+
+	for (const walk_chunk_t *chunk = dir->chunks; chunk != NULL; chunk = chunk->next) {
+		size_t off = 0;
+		while (off < chunk->len) {
+			const walk_ent_t ent = {
+				.name	= chunk->data + off + 1,
+				.len	= strlen(chunk->data + off + 1),
+				.folder = chunk->data[off] == 1,
+			};
+			off += ent.len + 2;
+
+			if (ent_path(walk, dir, &ent)) {
+				continue;
+			}
+
+			if (walk->ignore && fglob_match(walk->ignore, walk->path.path + walk->root, walk->path.len - walk->root, ent.folder)) {
+				continue;
+			}
+
+			walk_ent_t *dst = arr_get(&dir->ents, arr_add(&dir->ents));
+			if (dst == NULL) {
+				log_error("cutils", "fwalk", NULL, "failed to add entry: %.*s", (int)walk->path.len, walk->path.path);
+				return 1;
+			}
+
+			*dst = ent;
+		}
+	}
+
+	if (walk->flags & FWALK_SORT) {
+		qsort(dir->ents.data, dir->ents.cnt, sizeof(walk_ent_t), ent_cmp_cb);
+	}
+
+	dir->listed = 1;
+	return 0;
+}
+
+static int dir_prefetch(walk_t *walk, walk_dir_t *dir)
+{
+	if (dir->ahead < dir->cur) {
+		dir->ahead = dir->cur;
+	}
+
+	while (walk->ahead < walk->ahead_max && dir->ahead < dir->ents.cnt) {
+		walk_ent_t *ent = arr_get(&dir->ents, dir->ahead++);
+		if (!ent->folder) {
+			continue;
+		}
+
+		ent->dir = dir_child(walk, dir, ent);
+		if (ent->dir == NULL || scan_start(walk, ent->dir)) {
+			return 1;
+		}
+
+		walk->ahead++;
+	}
+
+	return 0;
+}
+
+static int walk_run(walk_t *walk, walk_dir_t *dir)
+{
+	int ret = 0;
+
+	while (dir != NULL) {
+		if (!dir->listed && dir_list(walk, dir)) {
+			ret = 1;
+			break;
+		}
+
+		if (dir_prefetch(walk, dir)) {
+			ret = 1;
+			break;
+		}
+
+		if (dir->cur == dir->ents.cnt) {
+			walk_dir_t *parent = dir->parent;
+			dir_free(walk, dir);
+			dir = parent;
+			continue;
+		}
+
+		walk_ent_t *ent = arr_get(&dir->ents, dir->cur++);
+		ent_path(walk, dir, ent);
+
+		files_foreach_cb cb = ent->folder ? walk->on_folder : walk->on_file;
+
+		const int res = cb ? cb(&walk->path, walk->path.path + dir->base, walk->priv) : 0;
+		if (res < 0) {
+			ret = res;
+			break;
+		}
+
+		if (!ent->folder) {
+			continue;
+		}
+
+		walk_dir_t *child = ent->dir;
+		ent->dir	  = NULL;
+		if (child) {
+			walk->ahead--;
+		}
+
+		if (res > 0) {
+			if (child) {
+				dir_free(walk, child);
+			}
+			continue;
+		}
+
+		if (child == NULL) {
+			child = dir_child(walk, dir, ent);
+			if (child == NULL) {
+				ret = 1;
+				break;
+			}
+		}
+
+		dir = child;
+	}
+
+	while (dir != NULL) {
+		walk_dir_t *parent = dir->parent;
+		dir_free(walk, dir);
+		dir = parent;
+	}
+
+	return ret;
+}
+
+int fwalk(const path_t *path, uint threads, int flags, const fglob_t *ignore, files_foreach_cb on_folder, files_foreach_cb on_file, void *priv)
+{
+	if (path == NULL) {
+		return 1;
+	}
+
+	int fd = -1;
+#if defined(C_WIN)
+	if (!folder_exists(path->path)) {
+		return 1;
+	}
+#else
+	fd = open(path->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0) {
+		return 1;
+	}
+#endif
+
+	walk_dir_t *root = dir_new(NULL, path->path, path->len);
+	if (root == NULL) {
+#if defined(C_WIN)
+#else
+		close(fd);
+#endif
+		return 1;
+	}
+
+	root->fd = fd;
+
+	if (threads == 0) {
+		threads = thread_cpu_cnt();
+	}
+
+	walk_t walk = {
+		.flags	   = flags,
+		.ignore	   = ignore,
+		.root	   = root->base,
+		.on_folder = on_folder,
+		.on_file   = on_file,
+		.priv	   = priv,
+	};
+
+	mutex_init(&walk.lock);
+	cond_init(&walk.cond);
+	cond_init(&walk.done);
+
+	if (threads > 1) {
+		walk.workers = mem_calloc(threads - 1, sizeof(thread_t));
+		if (walk.workers == NULL) {
+			log_error("cutils", "fwalk", NULL, "failed to allocate workers");
+		}
+	}
+
+	while (walk.workers && walk.workers_cnt < threads - 1 && thread_create(&walk.workers[walk.workers_cnt], worker_run, &walk) == 0) {
+		walk.workers_cnt++;
+	}
+
+	walk.ahead_max = walk.workers_cnt * FWALK_AHEAD;
+
+	const int ret = walk_run(&walk, root);
+
+	mutex_lock(&walk.lock);
+	walk.stop = 1;
+	cond_broadcast(&walk.cond);
+	mutex_unlock(&walk.lock);
+
+	for (uint i = 0; i < walk.workers_cnt; i++) {
+		thread_join(&walk.workers[i]);
+	}
+
+	if (walk.workers) {
+		mem_free(walk.workers, (threads - 1) * sizeof(thread_t));
+	}
+
+	cond_free(&walk.done);
+	cond_free(&walk.cond);
+	mutex_free(&walk.lock);
+
+	return ret;
+}
@@ -0,0 +1,162 @@
+#include "hash128.h"
+
+#include "digest.h"
+#include "mem.h"
+
+#define HASH128_C1 0x87c37b91114253d5ULL
+#define HASH128_C2 0x4cf5ad432745937fULL
+
+#define HASH128_ROL(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static inline u64 hash128_load(const byte *p)
+{
+	u64 v = 0;
+	for (int i = 7; i >= 0; i--) {
+		v = v << 8 | p[i];
+	}
+	return v;
+}
+
+static inline u64 hash128_mix(u64 k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+static void hash128_blocks(u64 *h, const byte *data, size_t cnt)
+{
+	u64 h1 = h[0];
+	u64 h2 = h[1];
+
+	for (; cnt > 0; cnt--, data += 16) {
+		u64 k1 = hash128_load(data);
+		u64 k2 = hash128_load(data + 8);
+
+		k1 *= HASH128_C1;
+		k1 = HASH128_ROL(k1, 31);
+		k1 *= HASH128_C2;
+		h1 ^= k1;
+
+		h1 = HASH128_ROL(h1, 27);
+		h1 += h2;
+		h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= HASH128_C2;
+		k2 = HASH128_ROL(k2, 33);
+		k2 *= HASH128_C1;
+		h2 ^= k2;
+
+		h2 = HASH128_ROL(h2, 31);
+		h2 += h1;
+		h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	h[0] = h1;
+	h[1] = h2;
+}
+
+static void hash128_blocks_cb(void *h, const byte *data, size_t cnt)
+{
+	hash128_blocks(h, data, cnt);
+}
+
+hash128_t *hash128_init(hash128_t *ctx)
+{
+	if (ctx == NULL) {
+		return NULL;
+	}
+
+	ctx->h[0] = 0;
+	ctx->h[1] = 0;
+	ctx->len  = 0;
+
+	return ctx;
+}
+
+void hash128_update(hash128_t *ctx, const void *data, size_t len)
+{
+	if (ctx == NULL || data == NULL) {
+		return;
+	}
+
+	digest_update(ctx->h, ctx->block, sizeof(ctx->block), &ctx->len, data, len, hash128_blocks_cb);
+}
+
+void hash128_final(hash128_t *ctx, byte *digest)
+{
+	if (ctx == NULL || digest == NULL) {
+		return;
+	}
+
+	const size_t tail = ctx->len % 16;
+
+	u64 h1 = ctx->h[0];
+	u64 h2 = ctx->h[1];
+	u64 k1 = 0;
+	u64 k2 = 0;
+
+	for (size_t i = tail; i > 8; i--) {
+		k2 = k2 << 8 | ctx->block[i - 1];
+	}
+
+	for (size_t i = tail < 8 ? tail : 8; i > 0; i--) {
+		k1 = k1 << 8 | ctx->block[i - 1];
+	}
+
+	if (tail > 8) {
+		k2 *= HASH128_C2;
+		k2 = HASH128_ROL(k2, 33);
+		k2 *= HASH128_C1;
+		h2 ^= k2;
+	}
+
+	if (tail > 0) {
+		k1 *= HASH128_C1;
+		k1 = HASH128_ROL(k1, 31);
+		k1 *= HASH128_C2;
+		h1 ^= k1;
+	}
+
+	h1 ^= ctx->len;
+	h2 ^= ctx->len;
+
+	h1 += h2;
+	h2 += h1;
+
+	h1 = hash128_mix(h1);
+	h2 = hash128_mix(h2);
+
+	h1 += h2;
+	h2 += h1;
+
+	for (int i = 0; i < 8; i++) {
+		digest[i]     = (byte)(h1 >> (i * 8));
+		digest[i + 8] = (byte)(h2 >> (i * 8));
+	}
+}
+
+static void hash128_update_cb(void *ctx, const void *data, size_t len)
+{
+	hash128_update(ctx, data, len);
+}
+
+int hash128_file(const char *path, byte *digest)
+{
+	if (path == NULL || digest == NULL) {
+		return 1;
+	}
+
+	hash128_t ctx;
+	hash128_init(&ctx);
+
+	if (digest_file(path, &ctx, hash128_update_cb)) {
+		return 1;
+	}
+
+	hash128_final(&ctx, digest);
+	return 0;
+}
@@ -1,7 +1,26 @@
 #include "json.h"
 
+#include "cstr.h"
+#include "dbuf.h"
 #include "log.h"
-#include "print.h"
+#include "mem.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define JSON_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#if defined(__SIZEOF_INT128__)
+	#define JSON_U128
+__extension__ typedef unsigned __int128 json_u128;
+#endif
 
 json_t *json_init(json_t *json, uint values_cap)
 {
@@ -13,6 +32,22 @@ json_t *json_init(json_t *json, uint values_cap)
 		return NULL;
 	}
 
+	json->arena = (arena_t){ 0 };
+
+	return json;
+}
+
+json_t *json_init_arena(json_t *json, uint values_cap, size_t chunk_size)
+{
+	if (json_init(json, values_cap) == NULL) {
+		return NULL;
+	}
+
+	if (arena_init(&json->arena, chunk_size) == NULL) {
+		list_free(&json->values);
+		return NULL;
+	}
+
 	return json;
 }
 
@@ -22,6 +57,13 @@ void json_free(json_t *json)
 		return;
 	}
 
+	if (json->arena.chunk_size) {
+		arena_free(&json->arena);
+		json->arena = (arena_t){ 0 };
+		list_free(&json->values);
+		return;
+	}
+
 	json_mem_t *mem;
 	list_foreach_all(&json->values, mem)
 	{
@@ -34,6 +76,63 @@ void json_free(json_t *json)
 	list_free(&json->values);
 }
 
+str_t json_strz(json_t *json, size_t size)
+{
+	if (json == NULL) {
+		return str_null();
+	}
+
+	if (!json->arena.chunk_size) {
+		return strz(size);
+	}
+
+	char *data = arena_alloc(&json->arena, size);
+	if (data != NULL && size > 0) {
+		data[0] = '\0';
+	}
+
+	return (str_t){
+		.data = data,
+		.size = size,
+		.len  = 0,
+		.ref  = 1,
+	};
+}
+
+str_t json_strn(json_t *json, const char *data, size_t len)
+{
+	if (json == NULL || data == NULL) {
+		return str_null();
+	}
+
+	if (!json->arena.chunk_size) {
+		return strn(data, len, len + 1);
+	}
+
+	const char *copy = arena_strn(&json->arena, data, len);
+	return copy ? strc(copy, len) : str_null();
+}
+
+static int json_own(json_t *json, str_t str, str_t *copy)
+{
+	*copy = str;
+	if (!json->arena.chunk_size || str.ref || str.data == NULL) {
+		return 0;
+	}
+
+	*copy = json_strn(json, str.data, str.len);
+	return copy->data == NULL;
+}
+
+static str_t json_take(str_t str, str_t copy)
+{
+	if (copy.data != str.data) {
+		str_free(&str);
+	}
+
+	return copy;
+}
+
 static json_mem_t *json_get_mem(const json_t *json, json_val_t val)
 {
 	return list_get_data(&json->values, val);
@@ -45,6 +144,11 @@ json_val_t json_add_val(json_t *json, json_val_t parent, str_t name, json_val_da
 		return JSON_END;
 	}
 
+	str_t sname, sval = { 0 };
+	if (json_own(json, name, &sname) || (value.type == JSON_VAL_STR && json_own(json, value.val.s, &sval))) {
+		return JSON_END;
+	}
+
 	json_val_t val;
 
 	if (parent == JSON_END) {
@@ -67,89 +171,975 @@ json_val_t json_add_val(json_t *json, json_val_t parent, str_t name, json_val_da
 		return JSON_END;
 	}
 
+	if (value.type == JSON_VAL_STR) {
+		value.val.s = json_take(value.val.s, sval);
+	}
+
 	*mem = (json_mem_t){
-		.name  = name,
+		.name  = json_take(name, sname),
 		.value = value,
 	};
 
 	return val;
 }
 
-static int json_mem_print(const json_t *json, json_mem_t *mem, print_dst_t dst, int name, int depth, const char *indent)
+json_val_t json_add_val_next(json_t *json, json_val_t parent, json_val_t last, str_t name, json_val_data_t value)
 {
+	if (json == NULL) {
+		return JSON_END;
+	}
+
+	json_mem_t *pmem = NULL;
+	if (parent != JSON_END) {
+		pmem = json_get_mem(json, parent);
+		if (pmem == NULL || (pmem->value.type != JSON_VAL_OBJ && pmem->value.type != JSON_VAL_ARR)) {
+			return JSON_END;
+		}
+	}
+
+	str_t sname, sval = { 0 };
+	if (json_own(json, name, &sname) || (value.type == JSON_VAL_STR && json_own(json, value.val.s, &sval))) {
+		return JSON_END;
+	}
+
+	const json_val_t val = list_add(&json->values);
+
+	json_mem_t *mem = list_get_data(&json->values, val);
 	if (mem == NULL) {
-		return 0;
+		return JSON_END;
 	}
 
-	int off = dst.off;
+	if (value.type == JSON_VAL_STR) {
+		value.val.s = json_take(value.val.s, sval);
+	}
 
-	for (int i = 0; i < depth; i++) {
-		dst.off += dprintf(dst, "%s", indent);
+	*mem = (json_mem_t){
+		.name  = json_take(name, sname),
+		.value = value,
+	};
+
+	if (parent == JSON_END) {
+		return val;
 	}
 
-	if (name) {
-		dst.off += dprintf(dst, "\"%.*s\": ", mem->name.len, mem->name.data);
+	if (last != JSON_END) {
+		list_set_next(&json->values, last, val);
+	} else {
+		pmem = json_get_mem(json, parent);
+		if (pmem->value.type == JSON_VAL_OBJ) {
+			pmem->value.val.o.values = val;
+		} else {
+			pmem->value.val.a.values = val;
+		}
 	}
 
-	json_mem_t *child;
+	return val;
+}
+
+typedef struct json_cpy_s {
+	json_val_t src;
+	json_val_t dst;
+	json_val_t last;
+} json_cpy_t;
 
-	switch (mem->value.type) {
-	case JSON_VAL_INT: dst.off += dprintf(dst, "%d", mem->value.val.i); break;
-	case JSON_VAL_FLOAT: dst.off += dprintf(dst, "%.7f", mem->value.val.f); break;
-	case JSON_VAL_DOUBLE: dst.off += dprintf(dst, "%.15f", mem->value.val.d); break;
-	case JSON_VAL_BOOL: dst.off += dprintf(dst, "%s", mem->value.val.b ? "true" : "false"); break;
-	case JSON_VAL_STR: dst.off += dprintf(dst, "\"%.*s\"", mem->value.val.s.len, mem->value.val.s.data); break;
+static json_val_t json_cpy_val(json_t *dst, json_val_t parent, json_val_t last, const json_mem_t *mem, json_val_t *first)
+{
+	json_val_data_t value = mem->value;
+
+	*first = JSON_END;
+	switch (value.type) {
+	case JSON_VAL_STR: value.val.s = json_strn(dst, value.val.s.data, value.val.s.len); break;
 	case JSON_VAL_OBJ:
-		if (mem->value.val.o.values == LIST_END) {
-			dst.off += dprintf(dst, "{}");
+		*first = value.val.o.values;
+		value  = JSON_OBJ();
+		break;
+	case JSON_VAL_ARR:
+		*first = value.val.a.values;
+		value  = JSON_ARR();
+		break;
+	default: break;
+	}
+
+	str_t name = json_strn(dst, mem->name.data, mem->name.len);
+
+	const json_val_t node = json_add_val_next(dst, parent, last, name, value);
+	if (node == JSON_END) {
+		str_free(&name);
+		if (value.type == JSON_VAL_STR) {
+			str_free(&value.val.s);
+		}
+	}
+
+	return node;
+}
+
+json_val_t json_copy(json_t *dst, json_val_t parent, const json_t *src, json_val_t val)
+{
+	if (dst == NULL || src == NULL || dst == src) {
+		return JSON_END;
+	}
+
+	const json_mem_t *mem = json_get_mem(src, val);
+	if (mem == NULL) {
+		return JSON_END;
+	}
+
+	json_val_t last = JSON_END;
+	if (parent != JSON_END) {
+		const json_mem_t *pmem = json_get_mem(dst, parent);
+		if (pmem == NULL || (pmem->value.type != JSON_VAL_OBJ && pmem->value.type != JSON_VAL_ARR)) {
+			return JSON_END;
+		}
+
+		json_val_t node = pmem->value.type == JSON_VAL_OBJ ? pmem->value.val.o.values : pmem->value.val.a.values;
+		while (node != JSON_END) {
+			last = node;
+			node = list_get_next(&dst->values, node);
+		}
+	}
+
+	json_val_t first;
+	const json_val_t root = json_cpy_val(dst, parent, last, mem, &first);
+	if (root == JSON_END || first == JSON_END) {
+		return root;
+	}
+
+	arr_t stack;
+	if (arr_init(&stack, 16, sizeof(json_cpy_t)) == NULL) {
+		return JSON_END;
+	}
+
+	json_cpy_t *top = arr_get(&stack, arr_add(&stack));
+	*top		= (json_cpy_t){ .src = first, .dst = root, .last = JSON_END };
+
+	int ret = 0;
+	while (stack.cnt > 0) {
+		top = arr_get(&stack, stack.cnt - 1);
+		if (top->src == JSON_END) {
+			stack.cnt--;
+			continue;
+		}
+
+		mem	  = json_get_mem(src, top->src);
+		top->src  = list_get_next(&src->values, top->src);
+		top->last = json_cpy_val(dst, top->dst, top->last, mem, &first);
+		if (top->last == JSON_END) {
+			ret = 1;
 			break;
 		}
-		dst.off += dprintf(dst, "{\n");
-		list_foreach(&json->values, mem->value.val.o.values, child)
-		{
-			dst.off += json_mem_print(json, child, dst, 1, depth + 1, indent);
-			if (list_get_next(&json->values, _i) != LIST_END) {
-				dst.off += dprintf(dst, ",");
+
+		if (first != JSON_END) {
+			const json_val_t node = top->last;
+
+			json_cpy_t *next = arr_get(&stack, arr_add(&stack));
+			if (next == NULL) {
+				ret = 1;
+				break;
+			}
+
+			*next = (json_cpy_t){ .src = first, .dst = node, .last = JSON_END };
+		}
+	}
+
+	arr_free(&stack);
+
+	if (ret) {
+		log_error("cutils", "json", NULL, "failed to copy value");
+		return JSON_END;
+	}
+
+	return root;
+}
+
+json_val_t json_get(const json_t *json, json_val_t obj, const char *name, size_t len)
+{
+	if (json == NULL || name == NULL) {
+		return JSON_END;
+	}
+
+	const json_mem_t *mem = list_get_data(&json->values, obj);
+	if (mem == NULL || mem->value.type != JSON_VAL_OBJ) {
+		return JSON_END;
+	}
+
+	const json_mem_t *child;
+	list_foreach(&json->values, mem->value.val.o.values, child)
+	{
+		if (child->name.len == len && mem_cmp(child->name.data, name, len) == 0) {
+			return _i;
+		}
+	}
+
+	return JSON_END;
+}
+
+json_val_t json_get_at(const json_t *json, json_val_t arr, uint index)
+{
+	if (json == NULL) {
+		return JSON_END;
+	}
+
+	const json_mem_t *mem = list_get_data(&json->values, arr);
+	if (mem == NULL || mem->value.type != JSON_VAL_ARR) {
+		return JSON_END;
+	}
+
+	const json_val_t val = list_get_at(&json->values, mem->value.val.a.values, index);
+	return val < json->values.cnt ? val : JSON_END;
+}
+
+static uint ptr_index(const char *tok, size_t len)
+{
+	if (len == 0 || len > 9 || (tok[0] == '0' && len > 1)) {
+		return JSON_END;
+	}
+
+	uint index = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (tok[i] < '0' || tok[i] > '9') {
+			return JSON_END;
+		}
+		index = index * 10 + (uint)(tok[i] - '0');
+	}
+
+	return index;
+}
+
+static size_t ptr_unescape(const char *tok, size_t len, char *out)
+{
+	size_t o = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (tok[i] != '~') {
+			out[o++] = tok[i];
+			continue;
+		}
+
+		if (++i >= len || (tok[i] != '0' && tok[i] != '1')) {
+			return (size_t)-1;
+		}
+
+		out[o++] = tok[i] == '0' ? '~' : '/';
+	}
+
+	return o;
+}
+
+uint json_ptr_walk(const char *ptr, size_t len, uint node, json_ptr_cb cb, const void *priv)
+{
+	if (ptr == NULL || cb == NULL || (len > 0 && ptr[0] != '/')) {
+		return JSON_END;
+	}
+
+	char *buf = memchr(ptr, '~', len) ? mem_alloc(len) : NULL;
+
+	size_t off = 0;
+	while (off < len && node != JSON_END) {
+		const char *tok = ptr + off + 1;
+		const char *sep = memchr(tok, '/', len - off - 1);
+		size_t tok_len	= sep ? (size_t)(sep - tok) : len - off - 1;
+
+		off += tok_len + 1;
+
+		if (buf && memchr(tok, '~', tok_len)) {
+			tok_len = ptr_unescape(tok, tok_len, buf);
+			tok	= buf;
+			if (tok_len == (size_t)-1) {
+				node = JSON_END;
+				break;
 			}
-			dst.off += dprintf(dst, "\n");
 		}
-		for (int i = 0; i < depth; i++) {
-			dst.off += dprintf(dst, "%s", indent);
+
+		node = cb(priv, node, tok, tok_len, ptr_index(tok, tok_len));
+	}
+
+	if (buf) {
+		mem_free(buf, len);
+	}
+
+	return node;
+}
+
+static uint json_ptr_step(const void *priv, uint node, const char *name, size_t len, uint index)
+{
+	const json_t *json = priv;
+
+	const json_mem_t *mem = list_get_data(&json->values, node);
+	if (mem != NULL && mem->value.type == JSON_VAL_ARR) {
+		return index == JSON_END ? JSON_END : json_get_at(json, node, index);
+	}
+
+	return json_get(json, node, name, len);
+}
+
+json_val_t json_pointer(const json_t *json, json_val_t root, const char *ptr, size_t len)
+{
+	if (json == NULL) {
+		return JSON_END;
+	}
+
+	return json_ptr_walk(ptr, len, root, json_ptr_step, json);
+}
+
+json_lookup_t *json_lookup_init(json_lookup_t *lookup, const json_t *json, json_val_t obj)
+{
+	if (lookup == NULL || json == NULL) {
+		return NULL;
+	}
+
+	const json_mem_t *mem = list_get_data(&json->values, obj);
+	if (mem == NULL || mem->value.type != JSON_VAL_OBJ) {
+		return NULL;
+	}
+
+	int cnt = 0;
+
+	const json_mem_t *child;
+	list_foreach(&json->values, mem->value.val.o.values, child)
+	{
+		cnt++;
+	}
+
+	if (dict_init(&lookup->dict, cnt * 2 + 1) == NULL) {
+		log_error("cutils", "json", NULL, "failed to create lookup");
+		return NULL;
+	}
+
+	list_foreach(&json->values, mem->value.val.o.values, child)
+	{
+		if (child->name.data != NULL && dict_get(&lookup->dict, child->name.data, child->name.len, NULL)) {
+			dict_set(&lookup->dict, child->name.data, child->name.len, (void *)(uintptr_t)_i);
 		}
+	}
 
-		dst.off += dprintf(dst, "}");
-		break;
+	lookup->json = json;
+
+	return lookup;
+}
+
+void json_lookup_free(json_lookup_t *lookup)
+{
+	if (lookup == NULL) {
+		return;
+	}
+
+	dict_free(&lookup->dict);
+	lookup->json = NULL;
+}
+
+json_val_t json_lookup_get(const json_lookup_t *lookup, const char *name, size_t len)
+{
+	if (lookup == NULL || lookup->json == NULL || name == NULL) {
+		return JSON_END;
+	}
+
+	void *val;
+	if (dict_get(&lookup->dict, name, len, &val)) {
+		return JSON_END;
+	}
+
+	return (json_val_t)(uintptr_t)val;
+}
+
+typedef struct json_lvl_s {
+	json_val_t next;
+	bool obj;
+} json_lvl_t;
+
+static const char s_digits[] = "00010203040506070809"
+			       "10111213141516171819"
+			       "20212223242526272829"
+			       "30313233343536373839"
+			       "40414243444546474849"
+			       "50515253545556575859"
+			       "60616263646566676869"
+			       "70717273747576777879"
+			       "80818283848586878889"
+			       "90919293949596979899";
+
+static inline uint json_ctz(uint val)
+{
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward(&idx, val);
+	return (uint)idx;
+#else
+	return (uint)__builtin_ctz(val);
+#endif
+}
+
+static inline int json_esc(unsigned char c)
+{
+	return c < 0x20 || c == '"' || c == '\\';
+}
+
+static inline int json_room(dbuf_t *buf, size_t len)
+{
+	return buf->size - buf->len >= len ? 0 : dbuf_reserve(buf, len);
+}
+
+static inline void json_put(dbuf_t *buf, const char *data, size_t len)
+{
+	if (json_room(buf, len)) {
+		return;
+	}
+
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+}
+
+static size_t json_str_clean(const char *data, size_t len)
+{
+	size_t i = 0;
+
+#if defined(JSON_SSE2)
+	const __m128i quote  = _mm_set1_epi8('"');
+	const __m128i bslash = _mm_set1_epi8('\\');
+	const __m128i ctrl   = _mm_set1_epi8(0x1f);
+	const __m128i zero   = _mm_setzero_si128();
+
+	for (; i + 16 <= len; i += 16) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+		const __m128i quot  = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, bslash));
+		const __m128i esc   = _mm_or_si128(quot, _mm_cmpeq_epi8(_mm_subs_epu8(chunk, ctrl), zero));
+
+		const uint mask = (uint)_mm_movemask_epi8(esc);
+		if (mask) {
+			return i + json_ctz(mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		if (json_esc((unsigned char)data[i])) {
+			return i;
+		}
+	}
+
+	return len;
+}
+
+static void json_str_print(dbuf_t *buf, const char *data, size_t len)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	if (json_room(buf, len + 2)) {
+		return;
+	}
+
+	char *p = buf->data + buf->len;
+	*p++	= '"';
+
+	for (;;) {
+		const size_t clean = json_str_clean(data, len);
+		if (clean > 0) {
+			memcpy(p, data, clean);
+			p += clean;
+		}
+
+		if (clean == len) {
+			break;
+		}
+
+		buf->len = (size_t)(p - buf->data);
+		if (json_room(buf, len - clean + 6)) {
+			return;
+		}
+
+		p = buf->data + buf->len;
+
+		const unsigned char c = (unsigned char)data[clean];
+
+		*p++ = '\\';
+		switch (c) {
+		case '"':
+		case '\\': *p++ = (char)c; break;
+		case '\b': *p++ = 'b'; break;
+		case '\f': *p++ = 'f'; break;
+		case '\n': *p++ = 'n'; break;
+		case '\r': *p++ = 'r'; break;
+		case '\t': *p++ = 't'; break;
+		default:
+			*p++ = 'u';
+			*p++ = '0';
+			*p++ = '0';
+			*p++ = hex[c >> 4];
+			*p++ = hex[c & 0xf];
+			break;
+		}
+
+		data += clean + 1;
+		len -= clean + 1;
+	}
+
+	*p++	 = '"';
+	buf->len = (size_t)(p - buf->data);
+}
+
+static char *json_u64_fmt(char *end, u64 val)
+{
+	while (val >= 100) {
+		const uint d = (uint)(val % 100) * 2;
+		val /= 100;
+		*--end = s_digits[d + 1];
+		*--end = s_digits[d];
+	}
+
+	if (val >= 10) {
+		*--end = s_digits[val * 2 + 1];
+		*--end = s_digits[val * 2];
+	} else {
+		*--end = (char)('0' + val);
+	}
+
+	return end;
+}
+
+static void json_int_print(dbuf_t *buf, int val)
+{
+	char tmp[16];
+	char *end   = tmp + sizeof(tmp);
+	char *start = json_u64_fmt(end, val < 0 ? 0 - (u64)val : (u64)val);
+
+	if (val < 0) {
+		*--start = '-';
+	}
+
+	json_put(buf, start, (size_t)(end - start));
+}
+
+static int json_real_split(double val, u64 scale, u64 *ip, u64 *fp)
+{
+	u64 bits;
+	mem_cpy(&bits, sizeof(bits), &val, sizeof(val));
+
+	const uint exp = (uint)(bits >> 52) & 0x7ff;
+	if (exp == 0x7ff) {
+		return 1;
+	}
+
+	const u64 mant = exp ? (bits & 0xfffffffffffffULL) | (1ULL << 52) : bits & 0xfffffffffffffULL;
+	const int e    = exp ? (int)exp - 1075 : -1074;
+
+	if (e >= 0) {
+		if (e > 11) {
+			return 1;
+		}
+
+		*ip = mant << e;
+		*fp = 0;
+		return 0;
+	}
+
+#if defined(JSON_U128)
+	const uint sh  = (uint)-e;
+	const u64 frac = sh < 64 ? mant & ((1ULL << sh) - 1) : mant;
+
+	*ip = sh < 64 ? mant >> sh : 0;
+	*fp = 0;
+
+	if (sh >= 128) {
+		return 0;
+	}
+
+	const json_u128 num  = (json_u128)frac * scale;
+	const json_u128 half = (json_u128)1 << (sh - 1);
+	json_u128 q	     = num >> sh;
+	const json_u128 rem  = num - (q << sh);
+
+	if (rem > half || (rem == half && (q & 1))) {
+		q++;
+	}
+
+	if (q == scale) {
+		(*ip)++;
+		q = 0;
+	}
+
+	*fp = (u64)q;
+	return 0;
+#else
+	const double scaled = (bits >> 63 ? -val : val) * (double)scale;
+	if (!(scaled < 9007199254740992.0) || scaled != (double)(u64)scaled) {
+		return 1;
+	}
+
+	*ip = (u64)scaled / scale;
+	*fp = (u64)scaled % scale;
+	return 0;
+#endif
+}
+
+static void json_real_print(dbuf_t *buf, double val, uint prec, u64 scale, const char *fmt)
+{
+	u64 bits;
+	mem_cpy(&bits, sizeof(bits), &val, sizeof(val));
+
+	u64 ip;
+	u64 fp;
+	if (json_real_split(val, scale, &ip, &fp)) {
+		dbuf_printf(buf, fmt, val);
+		return;
+	}
+
+	char tmp[48];
+	char *end = tmp + sizeof(tmp);
+	char *p	  = end;
+
+	for (uint i = 0; i < prec; i += 2) {
+		const uint d = (uint)(fp % 100) * 2;
+		fp /= 100;
+		*--p = s_digits[d + 1];
+		*--p = s_digits[d];
+	}
+
+	p += prec & 1;
+	*--p = '.';
+	p    = json_u64_fmt(p, ip);
+
+	if (bits >> 63) {
+		*--p = '-';
+	}
+
+	json_put(buf, p, (size_t)(end - p));
+}
+
+static json_val_t json_val_print(dbuf_t *buf, const json_val_data_t *val, int pretty)
+{
+	switch (val->type) {
+	case JSON_VAL_INT: json_int_print(buf, val->val.i); break;
+	case JSON_VAL_FLOAT: json_real_print(buf, val->val.f, 7, 10000000ULL, "%.7f"); break;
+	case JSON_VAL_DOUBLE: json_real_print(buf, val->val.d, 15, 1000000000000000ULL, "%.15f"); break;
+	case JSON_VAL_BOOL: json_put(buf, val->val.b ? "true" : "false", val->val.b ? 4 : 5); break;
+	case JSON_VAL_STR: json_str_print(buf, val->val.s.data, val->val.s.len); break;
+	case JSON_VAL_OBJ:
+		if (val->val.o.values == JSON_END) {
+			json_put(buf, CSTR("{}"));
+			break;
+		}
+		json_put(buf, "{\n", pretty ? 2 : 1);
+		return val->val.o.values;
 	case JSON_VAL_ARR:
-		if (mem->value.val.a.values == LIST_END) {
-			dst.off += dprintf(dst, "[]");
+		if (val->val.a.values == JSON_END) {
+			json_put(buf, CSTR("[]"));
 			break;
 		}
-		dst.off += dprintf(dst, "[\n");
+		json_put(buf, "[\n", pretty ? 2 : 1);
+		return val->val.a.values;
+	case JSON_VAL_NULL: json_put(buf, CSTR("null")); break;
+	default: break;
+	}
+
+	return JSON_END;
+}
+
+int json_print(const json_t *json, json_val_t val, print_dst_t dst, const char *indent)
+{
+	if (json == NULL || list_get_data(&json->values, val) == NULL) {
+		return 0;
+	}
+
+	const int pretty	= indent != NULL;
+	const size_t indent_len = pretty ? cstr_len(indent) : 0;
+
+	char data[DBUF_STACK_SIZE];
+	dbuf_t buf;
+	if (dbuf_init_ext(&buf, data, sizeof(data), dst) == NULL) {
+		return 0;
+	}
+
+	char pad_data[256];
+	dbuf_t pad;
+	dbuf_init_ext(&pad, pad_data, sizeof(pad_data), PRINT_DST_NONE());
+
+	arr_t stack;
+	if (arr_init(&stack, 16, sizeof(json_lvl_t)) == NULL) {
+		dbuf_free(&pad);
+		dbuf_free(&buf);
+		return 0;
+	}
+
+	json_val_t node = val;
+	int named	= 0;
+
+	while (node != JSON_END) {
+		const json_mem_t *mem = list_get_data(&json->values, node);
+		json_val_t first      = JSON_END;
 
-		list_foreach(&json->values, mem->value.val.a.values, child)
-		{
-			dst.off += json_mem_print(json, child, dst, 0, depth + 1, indent);
-			if (list_get_next(&json->values, _i) != LIST_END) {
-				dst.off += dprintf(dst, ",");
+		if ((uint)mem->value.type > JSON_VAL_NULL) {
+			log_warn("cutils", "json", NULL, "unknown value type: %d", mem->value.type);
+		} else {
+			if (pretty) {
+				json_put(&buf, pad.data, pad.len);
 			}
-			dst.off += dprintf(dst, "\n");
+
+			if (named) {
+				json_str_print(&buf, mem->name.data, mem->name.len);
+				json_put(&buf, ": ", pretty ? 2 : 1);
+			}
+
+			first = json_val_print(&buf, &mem->value, pretty);
 		}
-		for (int i = 0; i < depth; i++) {
-			dst.off += dprintf(dst, "%s", indent);
+
+		if (first != JSON_END) {
+			json_lvl_t *lvl = arr_get(&stack, arr_add(&stack));
+			if (lvl == NULL) {
+				break;
+			}
+
+			lvl->next = list_get_next(&json->values, first);
+			lvl->obj  = mem->value.type == JSON_VAL_OBJ;
+
+			dbuf_cat(&pad, indent, indent_len);
+			node  = first;
+			named = lvl->obj;
+			continue;
 		}
 
-		dst.off += dprintf(dst, "]");
-		break;
-	default:
-		dst.off = off;
-		log_warn("cutils", "json", NULL, "unknown value type: %d", mem->value.type);
-		break;
+		node = JSON_END;
+		while (stack.cnt > 0) {
+			json_lvl_t *lvl = arr_get(&stack, stack.cnt - 1);
+			if (lvl->next != JSON_END) {
+				json_put(&buf, ",\n", pretty ? 2 : 1);
+				node	  = lvl->next;
+				named	  = lvl->obj;
+				lvl->next = list_get_next(&json->values, node);
+				break;
+			}
+
+			if (pretty) {
+				pad.len -= indent_len;
+				json_put(&buf, CSTR("\n"));
+				json_put(&buf, pad.data, pad.len);
+			}
+
+			json_put(&buf, lvl->obj ? "}" : "]", 1);
+			stack.cnt--;
+		}
+	}
+
+	dbuf_flush(&buf);
+
+	const int off = buf.dst.off - dst.off;
+	arr_free(&stack);
+	dbuf_free(&pad);
+	dbuf_free(&buf);
+	return off;
+}
+
+json_writer_t *json_writer_init(json_writer_t *writer, print_dst_t dst, const char *indent)
+{
+	if (writer == NULL) {
+		return NULL;
 	}
 
-	return dst.off - off;
+	if (dbuf_init_dst(&writer->buf, DBUF_SIZE, dst) == NULL) {
+		return NULL;
+	}
+
+	if (dbuf_init(&writer->pad, 256) == NULL) {
+		dbuf_free(&writer->buf);
+		return NULL;
+	}
+
+	writer->indent	   = indent;
+	writer->indent_len = indent ? cstr_len(indent) : 0;
+	writer->depth	   = 0;
+	writer->first	   = 0;
+	writer->key	   = 0;
+	writer->done	   = 0;
+
+	return writer;
 }
 
-int json_print(const json_t *json, json_val_t val, print_dst_t dst, const char *indent)
+int json_writer_close(json_writer_t *writer)
 {
-	return json_mem_print(json, list_get_data(&json->values, val), dst, 0, 0, indent);
+	if (writer == NULL) {
+		return 1;
+	}
+
+	int ret = 0;
+	if (writer->depth > 0 || !writer->done) {
+		log_error("cutils", "json", NULL, "incomplete document");
+		ret = 1;
+	}
+
+	dbuf_flush(&writer->buf);
+	dbuf_free(&writer->pad);
+	dbuf_free(&writer->buf);
+
+	return ret;
+}
+
+static inline int writer_in_obj(const json_writer_t *writer)
+{
+	return writer->stack[(writer->depth - 1) / 8] >> ((writer->depth - 1) % 8) & 1;
+}
+
+static int writer_next(json_writer_t *writer, int key)
+{
+	if (writer->depth == 0) {
+		if (writer->done || key) {
+			log_error("cutils", "json", NULL, "%s", key ? "key outside of object" : "document already complete");
+			return 1;
+		}
+		return 0;
+	}
+
+	const int obj = writer_in_obj(writer);
+
+	if (key && !obj) {
+		log_error("cutils", "json", NULL, "key outside of object");
+		return 1;
+	}
+
+	if (key && writer->key) {
+		log_error("cutils", "json", NULL, "expected value");
+		return 1;
+	}
+
+	if (!key && obj && !writer->key) {
+		log_error("cutils", "json", NULL, "expected key");
+		return 1;
+	}
+
+	if (writer->key) {
+		writer->key = 0;
+		return 0;
+	}
+
+	const int pretty = writer->indent != NULL;
+
+	if (writer->first) {
+		json_put(&writer->buf, "\n", pretty ? 1 : 0);
+	} else {
+		json_put(&writer->buf, ",\n", pretty ? 2 : 1);
+	}
+
+	writer->first = 0;
+	json_put(&writer->buf, writer->pad.data, writer->pad.len);
+
+	return 0;
+}
+
+static int writer_begin(json_writer_t *writer, int obj)
+{
+	if (writer->depth >= JSON_MAX_DEPTH) {
+		log_error("cutils", "json", NULL, "maximum depth exceeded");
+		return 1;
+	}
+
+	if (writer_next(writer, 0)) {
+		return 1;
+	}
+
+	const byte bit = (byte)(1 << (writer->depth % 8));
+	if (obj) {
+		writer->stack[writer->depth / 8] |= bit;
+	} else {
+		writer->stack[writer->depth / 8] &= (byte)~bit;
+	}
+
+	json_put(&writer->buf, obj ? "{" : "[", 1);
+	dbuf_cat(&writer->pad, writer->indent, writer->indent_len);
+
+	writer->depth++;
+	writer->first = 1;
+
+	return 0;
+}
+
+int json_write_obj(json_writer_t *writer)
+{
+	if (writer == NULL) {
+		return 1;
+	}
+
+	return writer_begin(writer, 1);
+}
+
+int json_write_arr(json_writer_t *writer)
+{
+	if (writer == NULL) {
+		return 1;
+	}
+
+	return writer_begin(writer, 0);
+}
+
+int json_write_key(json_writer_t *writer, const char *key, size_t len)
+{
+	if (writer == NULL || (key == NULL && len > 0)) {
+		return 1;
+	}
+
+	if (writer_next(writer, 1)) {
+		return 1;
+	}
+
+	json_str_print(&writer->buf, key, len);
+	json_put(&writer->buf, ": ", writer->indent ? 2 : 1);
+	writer->key = 1;
+
+	return 0;
+}
+
+int json_write_val(json_writer_t *writer, json_val_data_t val)
+{
+	if (writer == NULL) {
+		return 1;
+	}
+
+	switch (val.type) {
+	case JSON_VAL_OBJ: return writer_begin(writer, 1);
+	case JSON_VAL_ARR: return writer_begin(writer, 0);
+	default: break;
+	}
+
+	if ((uint)val.type > JSON_VAL_NULL) {
+		log_error("cutils", "json", NULL, "unknown value type: %d", val.type);
+		return 1;
+	}
+
+	if (writer_next(writer, 0)) {
+		return 1;
+	}
+
+	json_val_print(&writer->buf, &val, 0);
+
+	if (writer->depth == 0) {
+		writer->done = 1;
+	}
+
+	return 0;
+}
+
+int json_write_end(json_writer_t *writer)
+{
+	if (writer == NULL) {
+		return 1;
+	}
+
+	if (writer->depth == 0 || writer->key) {
+		log_error("cutils", "json", NULL, "%s", writer->depth == 0 ? "no open container" : "expected value");
+		return 1;
+	}
+
+	const int obj = writer_in_obj(writer);
+
+	writer->depth--;
+	writer->pad.len -= writer->indent_len;
+
+	if (!writer->first && writer->indent) {
+		json_put(&writer->buf, "\n", 1);
+		json_put(&writer->buf, writer->pad.data, writer->pad.len);
+	}
+
+	json_put(&writer->buf, obj ? "}" : "]", 1);
+	writer->first = 0;
+
+	if (writer->depth == 0) {
+		writer->done = 1;
+	}
+
+	return 0;
 }
@@ -0,0 +1,595 @@
+#include "json_bin.h"
+
+#include "arr.h"
+#include "log.h"
+#include "mem.h"
+
+#include <string.h>
+
+#define JSON_BIN_MAGIC "JSB1"
+#define JSON_BIN_HDR   4
+#define JSON_BIN_CONT  9
+
+enum {
+	JSON_BIN_NULL,
+	JSON_BIN_FALSE,
+	JSON_BIN_TRUE,
+	JSON_BIN_INT,
+	JSON_BIN_FLOAT,
+	JSON_BIN_DOUBLE,
+	JSON_BIN_STR,
+	JSON_BIN_OBJ,
+	JSON_BIN_ARR,
+};
+
+typedef struct json_bin_lvl_s {
+	json_val_t node;
+	json_val_t last;
+	size_t hdr;
+	uint pos;
+	uint end;
+	u32 cnt;
+	bool obj;
+} json_bin_lvl_t;
+
+static inline void put_u32(byte *out, u32 val)
+{
+	out[0] = (byte)val;
+	out[1] = (byte)(val >> 8);
+	out[2] = (byte)(val >> 16);
+	out[3] = (byte)(val >> 24);
+}
+
+static inline u32 get_u32(const byte *data)
+{
+	return (u32)data[0] | (u32)data[1] << 8 | (u32)data[2] << 16 | (u32)data[3] << 24;
+}
+
+static inline size_t put_var(byte *out, u32 val)
+{
+	size_t len = 0;
+	while (val >= 0x80) {
+		out[len++] = (byte)(val | 0x80);
+		val >>= 7;
+	}
+
+	out[len++] = (byte)val;
+	return len;
+}
+
+static inline int get_var(const byte *data, uint *pos, uint end, u32 *val)
+{
+	*val = 0;
+	for (uint shift = 0; shift < 35 && *pos < end; shift += 7) {
+		const byte b = data[(*pos)++];
+		*val |= (u32)(b & 0x7f) << shift;
+		if (b < 0x80) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static inline byte *bin_room(dbuf_t *buf, size_t len)
+{
+	if (buf->size - buf->len < len && dbuf_reserve(buf, len)) {
+		return NULL;
+	}
+
+	return (byte *)buf->data + buf->len;
+}
+
+static int bin_put_str(dbuf_t *buf, str_t str)
+{
+	if (str.len > (u32)-1) {
+		return 1;
+	}
+
+	byte *out = bin_room(buf, str.len + 5);
+	if (out == NULL) {
+		return 1;
+	}
+
+	const size_t len = put_var(out, (u32)str.len);
+	if (str.len > 0) {
+		memcpy(out + len, str.data, str.len);
+	}
+
+	buf->len += len + str.len;
+	return 0;
+}
+
+static int bin_put_val(dbuf_t *buf, const json_val_data_t *val)
+{
+	if (val->type == JSON_VAL_STR) {
+		byte *out = bin_room(buf, 1);
+		if (out == NULL) {
+			return 1;
+		}
+
+		*out = JSON_BIN_STR;
+		buf->len++;
+		return bin_put_str(buf, val->val.s);
+	}
+
+	byte *out = bin_room(buf, JSON_BIN_CONT);
+	if (out == NULL) {
+		return 1;
+	}
+
+	u32 bits;
+	u64 bits64;
+	size_t len = 1;
+
+	switch (val->type) {
+	case JSON_VAL_INT:
+		out[0] = JSON_BIN_INT;
+		len += put_var(out + 1, val->val.i < 0 ? ~((u32)val->val.i << 1) : (u32)val->val.i << 1);
+		break;
+	case JSON_VAL_FLOAT:
+		memcpy(&bits, &val->val.f, sizeof(bits));
+		out[0] = JSON_BIN_FLOAT;
+		put_u32(out + 1, bits);
+		len += 4;
+		break;
+	case JSON_VAL_DOUBLE:
+		memcpy(&bits64, &val->val.d, sizeof(bits64));
+		out[0] = JSON_BIN_DOUBLE;
+		put_u32(out + 1, (u32)bits64);
+		put_u32(out + 5, (u32)(bits64 >> 32));
+		len += 8;
+		break;
+	case JSON_VAL_BOOL: out[0] = val->val.b ? JSON_BIN_TRUE : JSON_BIN_FALSE; break;
+	case JSON_VAL_OBJ:
+	case JSON_VAL_ARR:
+		out[0] = val->type == JSON_VAL_OBJ ? JSON_BIN_OBJ : JSON_BIN_ARR;
+		put_u32(out + 1, 0);
+		put_u32(out + 5, 0);
+		len = JSON_BIN_CONT;
+		break;
+	default: out[0] = JSON_BIN_NULL; break;
+	}
+
+	buf->len += len;
+	return 0;
+}
+
+static int bin_push(arr_t *stack, const json_val_data_t *val, size_t hdr)
+{
+	if (val->type != JSON_VAL_OBJ && val->type != JSON_VAL_ARR) {
+		return 0;
+	}
+
+	json_bin_lvl_t *lvl = arr_get(stack, arr_add(stack));
+	if (lvl == NULL) {
+		return 1;
+	}
+
+	*lvl = (json_bin_lvl_t){
+		.node = val->type == JSON_VAL_OBJ ? val->val.o.values : val->val.a.values,
+		.last = JSON_END,
+		.hdr  = hdr,
+		.obj  = val->type == JSON_VAL_OBJ,
+	};
+
+	return 0;
+}
+
+int json_bin_write(const json_t *json, json_val_t val, dbuf_t *buf)
+{
+	if (json == NULL || buf == NULL) {
+		return 1;
+	}
+
+	if (buf->sink) {
+		log_error("cutils", "json", NULL, "binary output requires a memory buffer");
+		return 1;
+	}
+
+	const json_mem_t *mem = list_get_data(&json->values, val);
+	if (mem == NULL) {
+		return 1;
+	}
+
+	byte *out = bin_room(buf, JSON_BIN_HDR);
+	if (out == NULL) {
+		return 1;
+	}
+
+	memcpy(out, JSON_BIN_MAGIC, JSON_BIN_HDR);
+	buf->len += JSON_BIN_HDR;
+
+	const size_t start = buf->len;
+
+	arr_t stack;
+	if (arr_init(&stack, 16, sizeof(json_bin_lvl_t)) == NULL) {
+		return 1;
+	}
+
+	int ret = bin_put_val(buf, &mem->value) || bin_push(&stack, &mem->value, start);
+
+	while (ret == 0 && stack.cnt > 0) {
+		json_bin_lvl_t *top = arr_get(&stack, stack.cnt - 1);
+		if (top->node == JSON_END) {
+			const size_t size = buf->len - top->hdr - JSON_BIN_CONT;
+			if (size > (u32)-1) {
+				ret = 1;
+				break;
+			}
+
+			put_u32((byte *)buf->data + top->hdr + 1, (u32)size);
+			put_u32((byte *)buf->data + top->hdr + 5, top->cnt);
+			stack.cnt--;
+			continue;
+		}
+
+		mem	  = list_get_data(&json->values, top->node);
+		top->node = list_get_next(&json->values, top->node);
+		top->cnt++;
+
+		if (top->obj && bin_put_str(buf, mem->name)) {
+			ret = 1;
+			break;
+		}
+
+		const size_t hdr = buf->len;
+		ret		 = bin_put_val(buf, &mem->value) || bin_push(&stack, &mem->value, hdr);
+	}
+
+	arr_free(&stack);
+
+	if (ret == 0 && buf->len >= JSON_END) {
+		ret = 1;
+	}
+
+	if (ret) {
+		log_error("cutils", "json", NULL, "failed to write binary value");
+		buf->len = start - JSON_BIN_HDR;
+		return 1;
+	}
+
+	return 0;
+}
+
+static uint bin_read(const byte *data, uint pos, uint end, json_val_data_t *val, uint *body)
+{
+	if (pos >= end) {
+		return JSON_END;
+	}
+
+	u32 len = 0;
+	u32 bits;
+	u64 bits64;
+
+	switch (data[pos++]) {
+	case JSON_BIN_NULL: *val = JSON_NULL(); break;
+	case JSON_BIN_FALSE: *val = JSON_BOOL(0); break;
+	case JSON_BIN_TRUE: *val = JSON_BOOL(1); break;
+	case JSON_BIN_INT:
+		if (get_var(data, &pos, end, &bits)) {
+			return JSON_END;
+		}
+		*val = JSON_INT(bits & 1 ? -(int)(bits >> 1) - 1 : (int)(bits >> 1));
+		break;
+	case JSON_BIN_FLOAT:
+		if (end - pos < 4) {
+			return JSON_END;
+		}
+		bits	  = get_u32(data + pos);
+		val->type = JSON_VAL_FLOAT;
+		memcpy(&val->val.f, &bits, sizeof(bits));
+		len = 4;
+		break;
+	case JSON_BIN_DOUBLE:
+		if (end - pos < 8) {
+			return JSON_END;
+		}
+		bits64	  = (u64)get_u32(data + pos) | (u64)get_u32(data + pos + 4) << 32;
+		val->type = JSON_VAL_DOUBLE;
+		memcpy(&val->val.d, &bits64, sizeof(bits64));
+		len = 8;
+		break;
+	case JSON_BIN_STR:
+		if (get_var(data, &pos, end, &len) || len > end - pos) {
+			return JSON_END;
+		}
+		*val = JSON_STR(strc((const char *)data + pos, len));
+		break;
+	case JSON_BIN_OBJ:
+	case JSON_BIN_ARR:
+		if (end - pos < JSON_BIN_CONT - 1) {
+			return JSON_END;
+		}
+		*val = data[pos - 1] == JSON_BIN_OBJ ? JSON_OBJ() : JSON_ARR();
+		len  = get_u32(data + pos);
+		pos += JSON_BIN_CONT - 1;
+		if (body) {
+			*body = pos;
+		}
+		break;
+	default: return JSON_END;
+	}
+
+	return len <= end - pos ? pos + len : JSON_END;
+}
+
+static inline uint bin_skip(const byte *data, uint pos, uint end)
+{
+	json_val_data_t val;
+	return bin_read(data, pos, end, &val, NULL);
+}
+
+static uint bin_key(const byte *data, uint pos, uint end, str_t *key)
+{
+	u32 len;
+	if (pos >= end || get_var(data, &pos, end, &len) || len > end - pos) {
+		return JSON_END;
+	}
+
+	*key = strc((const char *)data + pos, len);
+	return pos + len;
+}
+
+static int bin_body(json_bin_t bin, json_val_type_t type, uint *pos, uint *end)
+{
+	if (bin.data == NULL || bin.pos >= bin.len) {
+		return 1;
+	}
+
+	json_val_data_t val;
+	*end = bin_read(bin.data, bin.pos, bin.len, &val, pos);
+	return *end == JSON_END || val.type != type;
+}
+
+json_bin_t json_bin_root(const void *data, size_t len)
+{
+	json_bin_t bin = {
+		.data = data,
+		.pos  = JSON_END,
+	};
+
+	if (data == NULL || len <= JSON_BIN_HDR || len >= JSON_END || mem_cmp(data, JSON_BIN_MAGIC, JSON_BIN_HDR) != 0) {
+		return bin;
+	}
+
+	bin.len = (uint)len;
+	bin.pos = bin_skip(bin.data, JSON_BIN_HDR, bin.len) == bin.len ? JSON_BIN_HDR : JSON_END;
+	return bin;
+}
+
+json_bin_t json_bin_get(json_bin_t obj, const char *name, size_t len)
+{
+	json_bin_t ref = {
+		.data = obj.data,
+		.len  = obj.len,
+		.pos  = JSON_END,
+	};
+
+	uint pos, end;
+	if (name == NULL || bin_body(obj, JSON_VAL_OBJ, &pos, &end)) {
+		return ref;
+	}
+
+	while (pos < end) {
+		str_t key;
+		pos = bin_key(obj.data, pos, end, &key);
+		if (pos == JSON_END) {
+			break;
+		}
+
+		if (key.len == len && mem_cmp(key.data, name, len) == 0) {
+			ref.pos = pos < end ? pos : JSON_END;
+			break;
+		}
+
+		pos = bin_skip(obj.data, pos, end);
+	}
+
+	return ref;
+}
+
+json_bin_t json_bin_at(json_bin_t arr, uint index)
+{
+	json_bin_t ref = {
+		.data = arr.data,
+		.len  = arr.len,
+		.pos  = JSON_END,
+	};
+
+	uint pos, end;
+	if (bin_body(arr, JSON_VAL_ARR, &pos, &end)) {
+		return ref;
+	}
+
+	for (uint i = 0; i < index && pos < end; i++) {
+		pos = bin_skip(arr.data, pos, end);
+	}
+
+	ref.pos = pos < end ? pos : JSON_END;
+	return ref;
+}
+
+static uint bin_step(const void *priv, uint node, const char *name, size_t len, uint index)
+{
+	json_bin_t bin = *(const json_bin_t *)priv;
+	bin.pos	       = node;
+
+	if (node < bin.len && bin.data[node] == JSON_BIN_ARR) {
+		return index == JSON_END ? JSON_END : json_bin_at(bin, index).pos;
+	}
+
+	return json_bin_get(bin, name, len).pos;
+}
+
+json_bin_t json_bin_pointer(json_bin_t root, const char *ptr, size_t len)
+{
+	return (json_bin_t){
+		.data = root.data,
+		.len  = root.len,
+		.pos  = root.data ? json_ptr_walk(ptr, len, root.pos, bin_step, &root) : JSON_END,
+	};
+}
+
+static int bin_val(json_bin_t bin, json_val_data_t *val)
+{
+	return bin.data == NULL || bin.pos >= bin.len || bin_read(bin.data, bin.pos, bin.len, val, NULL) == JSON_END;
+}
+
+int json_bin_type(json_bin_t bin, json_val_type_t *type)
+{
+	json_val_data_t val;
+	if (type == NULL || bin_val(bin, &val)) {
+		return 1;
+	}
+
+	*type = val.type;
+	return 0;
+}
+
+int json_bin_cnt(json_bin_t bin, uint *cnt)
+{
+	json_val_data_t val;
+	if (cnt == NULL || bin_val(bin, &val) || (val.type != JSON_VAL_OBJ && val.type != JSON_VAL_ARR)) {
+		return 1;
+	}
+
+	*cnt = get_u32(bin.data + bin.pos + 5);
+	return 0;
+}
+
+int json_bin_str(json_bin_t bin, str_t *str)
+{
+	json_val_data_t val;
+	if (str == NULL || bin_val(bin, &val) || val.type != JSON_VAL_STR) {
+		return 1;
+	}
+
+	*str = val.val.s;
+	return 0;
+}
+
+int json_bin_int(json_bin_t bin, int *val)
+{
+	json_val_data_t num;
+	if (val == NULL || bin_val(bin, &num) || num.type != JSON_VAL_INT) {
+		return 1;
+	}
+
+	*val = num.val.i;
+	return 0;
+}
+
+int json_bin_double(json_bin_t bin, double *val)
+{
+	json_val_data_t num;
+	if (val == NULL || bin_val(bin, &num)) {
+		return 1;
+	}
+
+	switch (num.type) {
+	case JSON_VAL_INT: *val = num.val.i; break;
+	case JSON_VAL_FLOAT: *val = num.val.f; break;
+	case JSON_VAL_DOUBLE: *val = num.val.d; break;
+	default: return 1;
+	}
+
+	return 0;
+}
+
+int json_bin_bool(json_bin_t bin, int *val)
+{
+	json_val_data_t b;
+	if (val == NULL || bin_val(bin, &b) || b.type != JSON_VAL_BOOL) {
+		return 1;
+	}
+
+	*val = b.val.b;
+	return 0;
+}
+
+static int bin_load_push(arr_t *stack, const byte *data, json_val_t node, uint pos, uint body, uint end)
+{
+	json_bin_lvl_t *lvl = arr_get(stack, arr_add(stack));
+	if (lvl == NULL) {
+		return 1;
+	}
+
+	*lvl = (json_bin_lvl_t){
+		.node = node,
+		.last = JSON_END,
+		.pos  = body,
+		.end  = end,
+		.cnt  = get_u32(data + pos + 5),
+		.obj  = data[pos] == JSON_BIN_OBJ,
+	};
+
+	return 0;
+}
+
+json_val_t json_bin_load(json_bin_t bin, json_t *json)
+{
+	if (json == NULL || bin.data == NULL || bin.pos >= bin.len) {
+		return JSON_END;
+	}
+
+	json_val_data_t val;
+	uint body;
+	const uint end = bin_read(bin.data, bin.pos, bin.len, &val, &body);
+	if (end == JSON_END) {
+		log_error("cutils", "json", NULL, "invalid binary value at %u", bin.pos);
+		return JSON_END;
+	}
+
+	const json_val_t root = json_add_val(json, JSON_END, str_null(), val);
+	if (root == JSON_END || (val.type != JSON_VAL_OBJ && val.type != JSON_VAL_ARR)) {
+		return root;
+	}
+
+	arr_t stack;
+	if (arr_init(&stack, 16, sizeof(json_bin_lvl_t)) == NULL) {
+		return JSON_END;
+	}
+
+	int ret = bin_load_push(&stack, bin.data, root, bin.pos, body, end);
+
+	while (ret == 0 && stack.cnt > 0) {
+		json_bin_lvl_t *top = arr_get(&stack, stack.cnt - 1);
+		if (top->pos == top->end) {
+			ret = top->cnt != 0;
+			stack.cnt--;
+			continue;
+		}
+
+		str_t name     = str_null();
+		const uint pos = top->obj ? bin_key(bin.data, top->pos, top->end, &name) : top->pos;
+
+		const uint next = pos == JSON_END ? JSON_END : bin_read(bin.data, pos, top->end, &val, &body);
+		if (next == JSON_END || top->cnt == 0) {
+			ret = 1;
+			break;
+		}
+
+		top->pos  = next;
+		top->last = json_add_val_next(json, top->node, top->last, name, val);
+		top->cnt--;
+
+		if (top->last == JSON_END) {
+			ret = 1;
+			break;
+		}
+
+		if (val.type == JSON_VAL_OBJ || val.type == JSON_VAL_ARR) {
+			ret = bin_load_push(&stack, bin.data, top->last, pos, body, next);
+		}
+	}
+
+	arr_free(&stack);
+
+	if (ret) {
+		log_error("cutils", "json", NULL, "invalid binary value");
+		return JSON_END;
+	}
+
+	return root;
+}
@@ -0,0 +1,1444 @@
+#include "json_parse.h"
+
+#include "cstr.h"
+#include "log.h"
+#include "mem.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define JSON_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#define JSON_BLOCK    64
+#define JSON_NUM_SIZE 64
+
+typedef struct json_blk_s {
+	u64 quote;
+	u64 bslash;
+	u64 op;
+	u64 ws;
+} json_blk_t;
+
+typedef struct json_prs_s {
+	json_t *json;
+	const json_idx_t *idx;
+	uint cur;
+} json_prs_t;
+
+static const double s_pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline uint json_ctz(u64 val)
+{
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward64(&idx, val);
+	return (uint)idx;
+#else
+	return (uint)__builtin_ctzll(val);
+#endif
+}
+
+#if defined(JSON_SSE2)
+static inline u64 cmp_mask(const __m128i *chunks, char c)
+{
+	const __m128i needle = _mm_set1_epi8(c);
+	return (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[0], needle)) | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[1], needle)) << 16 |
+	       (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[2], needle)) << 32 | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[3], needle)) << 48;
+}
+
+static void classify(const byte *data, json_blk_t *blk)
+{
+	__m128i chunks[4];
+	__m128i lower[4];
+	for (int i = 0; i < 4; i++) {
+		chunks[i] = _mm_loadu_si128((const __m128i *)(data + i * 16));
+		lower[i]  = _mm_or_si128(chunks[i], _mm_set1_epi8(0x20));
+	}
+
+	blk->quote  = cmp_mask(chunks, '"');
+	blk->bslash = cmp_mask(chunks, '\\');
+	blk->op	    = cmp_mask(lower, '{') | cmp_mask(lower, '}') | cmp_mask(chunks, ':') | cmp_mask(chunks, ',');
+	blk->ws	    = cmp_mask(chunks, ' ') | cmp_mask(chunks, '\t') | cmp_mask(chunks, '\n') | cmp_mask(chunks, '\r');
+}
+#else
+static void classify(const byte *data, json_blk_t *blk)
+{
+	*blk = (json_blk_t){ 0 };
+	for (uint i = 0; i < JSON_BLOCK; i++) {
+		const u64 bit = (u64)1 << i;
+		switch (data[i]) {
+		case '"': blk->quote |= bit; break;
+		case '\\': blk->bslash |= bit; break;
+		case '{':
+		case '}':
+		case '[':
+		case ']':
+		case ':':
+		case ',': blk->op |= bit; break;
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r': blk->ws |= bit; break;
+		default: break;
+		}
+	}
+}
+#endif
+
+static inline u64 prefix_xor(u64 val)
+{
+	val ^= val << 1;
+	val ^= val << 2;
+	val ^= val << 4;
+	val ^= val << 8;
+	val ^= val << 16;
+	val ^= val << 32;
+	return val;
+}
+
+static inline u64 find_escaped(u64 bslash, u64 *carry)
+{
+	u64 escaped = *carry;
+
+	bslash &= ~*carry;
+	*carry = 0;
+
+	while (bslash) {
+		const uint i = json_ctz(bslash);
+		if (i == 63) {
+			*carry = 1;
+			break;
+		}
+
+		escaped |= (u64)2 << i;
+		bslash &= ~((u64)3 << i);
+	}
+
+	return escaped;
+}
+
+json_idx_t *json_idx_init(json_idx_t *idx, const char *data, size_t len)
+{
+	if (idx == NULL || (data == NULL && len > 0)) {
+		return NULL;
+	}
+
+	if (len >= (uint)-1) {
+		log_error("cutils", "json", NULL, "input too large: %zu", len);
+		return NULL;
+	}
+
+	idx->pos = mem_alloc((len + 1) * sizeof(uint));
+	if (idx->pos == NULL) {
+		log_error("cutils", "json", NULL, "failed to allocate index");
+		return NULL;
+	}
+
+	idx->data = data;
+	idx->len  = len;
+	idx->cnt  = 0;
+
+	u64 escaped  = 0;
+	u64 instring = 0;
+	u64 scalar   = 0;
+
+	byte tail[JSON_BLOCK];
+	for (size_t off = 0; off < len; off += JSON_BLOCK) {
+		const byte *block = (const byte *)data + off;
+		if (len - off < JSON_BLOCK) {
+			mem_set(tail, ' ', sizeof(tail));
+			mem_cpy(tail, sizeof(tail), block, len - off);
+			block = tail;
+		}
+
+		json_blk_t blk;
+		classify(block, &blk);
+
+		const u64 quotes = blk.quote & ~find_escaped(blk.bslash, &escaped);
+		const u64 str	 = prefix_xor(quotes) ^ instring;
+		const u64 chars	 = ~(blk.op | blk.ws | quotes) & ~str;
+		const u64 starts = chars & ~(chars << 1 | scalar);
+
+		instring = 0 - (str >> 63);
+		scalar	 = chars >> 63;
+
+		u64 bits = (blk.op & ~str) | quotes | starts;
+		while (bits) {
+			idx->pos[idx->cnt++] = (uint)off + json_ctz(bits);
+			bits &= bits - 1;
+		}
+	}
+
+	if (instring) {
+		log_error("cutils", "json", NULL, "unterminated string");
+		json_idx_free(idx);
+		return NULL;
+	}
+
+	return idx;
+}
+
+void json_idx_free(json_idx_t *idx)
+{
+	if (idx == NULL) {
+		return;
+	}
+
+	mem_free(idx->pos, (idx->len + 1) * sizeof(uint));
+	idx->pos = NULL;
+	idx->cnt = 0;
+}
+
+static int prs_error(const json_prs_t *prs, uint at, const char *msg)
+{
+	uint line = 1;
+	uint col  = 1;
+	for (uint i = 0; i < at && i < prs->idx->len; i++) {
+		if (prs->idx->data[i] == '\n') {
+			line++;
+			col = 1;
+		} else {
+			col++;
+		}
+	}
+
+	log_error("cutils", "json", NULL, "%u:%u: %s", line, col, msg);
+	return 1;
+}
+
+static inline uint prs_peek(const json_prs_t *prs)
+{
+	return prs->cur < prs->idx->cnt ? prs->idx->pos[prs->cur] : (uint)prs->idx->len;
+}
+
+static inline char prs_char(const json_prs_t *prs)
+{
+	return prs->cur < prs->idx->cnt ? prs->idx->data[prs->idx->pos[prs->cur]] : '\0';
+}
+
+static inline int is_boundary(const json_prs_t *prs, size_t at)
+{
+	if (at >= prs->idx->len) {
+		return 1;
+	}
+
+	switch (prs->idx->data[at]) {
+	case ' ':
+	case '\t':
+	case '\n':
+	case '\r':
+	case ',':
+	case ':':
+	case '{':
+	case '}':
+	case '[':
+	case ']':
+	case '"': return 1;
+	default: return 0;
+	}
+}
+
+static int hex4(const char *data, uint *val)
+{
+	*val = 0;
+	for (int i = 0; i < 4; i++) {
+		const char c = data[i];
+		uint digit;
+		if (c >= '0' && c <= '9') {
+			digit = (uint)(c - '0');
+		} else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+			digit = (uint)((c | 0x20) - 'a' + 10);
+		} else {
+			return 1;
+		}
+		*val = *val << 4 | digit;
+	}
+
+	return 0;
+}
+
+static size_t utf8_enc(char *out, uint cp)
+{
+	if (cp < 0x80) {
+		out[0] = (char)cp;
+		return 1;
+	}
+
+	if (cp < 0x800) {
+		out[0] = (char)(0xC0 | cp >> 6);
+		out[1] = (char)(0x80 | (cp & 0x3F));
+		return 2;
+	}
+
+	if (cp < 0x10000) {
+		out[0] = (char)(0xE0 | cp >> 12);
+		out[1] = (char)(0x80 | (cp >> 6 & 0x3F));
+		out[2] = (char)(0x80 | (cp & 0x3F));
+		return 3;
+	}
+
+	out[0] = (char)(0xF0 | cp >> 18);
+	out[1] = (char)(0x80 | (cp >> 12 & 0x3F));
+	out[2] = (char)(0x80 | (cp >> 6 & 0x3F));
+	out[3] = (char)(0x80 | (cp & 0x3F));
+	return 4;
+}
+
+static size_t unescape_to(const char *src, size_t len, char *out)
+{
+	size_t o = 0;
+
+	for (size_t i = 0; i < len; i++) {
+		if (src[i] != '\\') {
+			out[o++] = src[i];
+			continue;
+		}
+
+		if (++i >= len) {
+			return (size_t)-1;
+		}
+
+		switch (src[i]) {
+		case '"': out[o++] = '"'; break;
+		case '\\': out[o++] = '\\'; break;
+		case '/': out[o++] = '/'; break;
+		case 'b': out[o++] = '\b'; break;
+		case 'f': out[o++] = '\f'; break;
+		case 'n': out[o++] = '\n'; break;
+		case 'r': out[o++] = '\r'; break;
+		case 't': out[o++] = '\t'; break;
+		case 'u': {
+			uint cp;
+			if (i + 4 >= len || hex4(&src[i + 1], &cp)) {
+				return (size_t)-1;
+			}
+			i += 4;
+
+			if (cp >= 0xD800 && cp < 0xDC00) {
+				uint lo;
+				if (i + 6 >= len || src[i + 1] != '\\' || src[i + 2] != 'u' || hex4(&src[i + 3], &lo) || lo < 0xDC00 || lo > 0xDFFF) {
+					return (size_t)-1;
+				}
+				i += 6;
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+			}
+
+			o += utf8_enc(&out[o], cp);
+			break;
+		}
+		default: return (size_t)-1;
+		}
+	}
+
+	return o;
+}
+
+static int unescape(json_t *json, const char *src, size_t len, str_t *str)
+{
+	*str = json ? json_strz(json, len + 1) : strz(len + 1);
+	if (str->data == NULL) {
+		return 1;
+	}
+
+	char *out = (char *)str->data;
+
+	const size_t o = unescape_to(src, len, out);
+	if (o == (size_t)-1) {
+		str_free(str);
+		return 1;
+	}
+
+	out[o]	 = '\0';
+	str->len = o;
+	return 0;
+}
+
+static int has_ctrl(const char *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if ((byte)data[i] < 0x20) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int parse_str(json_prs_t *prs, str_t *str)
+{
+	const uint start = prs_peek(prs);
+	prs->cur++;
+	const uint end = prs_peek(prs);
+	prs->cur++;
+
+	const char *data = prs->idx->data + start + 1;
+	const size_t len = end - start - 1;
+
+	if (has_ctrl(data, len)) {
+		return prs_error(prs, start, "invalid control character");
+	}
+
+	if (memchr(data, '\\', len) == NULL) {
+		*str = strc(data, len);
+		return 0;
+	}
+
+	if (unescape(prs->json, data, len, str)) {
+		return prs_error(prs, start, "invalid escape sequence");
+	}
+
+	return 0;
+}
+
+static int num_parse(const char *start, const char *end, json_val_data_t *val, const char **stop)
+{
+	const char *p = start;
+
+	const int neg = p < end && *p == '-';
+	if (neg) {
+		p++;
+	}
+
+	if (p >= end || *p < '0' || *p > '9') {
+		return 1;
+	}
+
+	u64 mant   = 0;
+	int digits = 0;
+	int exp	   = 0;
+
+	if (*p == '0') {
+		p++;
+	} else {
+		for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+			mant = mant * 10 + (u64)(*p - '0');
+		}
+	}
+
+	int real = 0;
+	if (p < end && *p == '.') {
+		real = 1;
+		p++;
+		const char *frac = p;
+		for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+			mant = mant * 10 + (u64)(*p - '0');
+		}
+		if (p == frac) {
+			return 1;
+		}
+		exp = -(int)(p - frac);
+	}
+
+	if (p < end && (*p | 0x20) == 'e') {
+		real = 1;
+		p++;
+		const int eneg = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+')) {
+			p++;
+		}
+
+		const char *digs = p;
+		int e		 = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (e < 100000) {
+				e = e * 10 + (*p - '0');
+			}
+		}
+		if (p == digs) {
+			return 1;
+		}
+		exp += eneg ? -e : e;
+	}
+
+	*stop = p;
+
+	if (!real && digits <= 10 && mant <= (neg ? 2147483648ULL : 2147483647ULL)) {
+		*val = JSON_INT(neg ? (int)-(long long)mant : (int)mant);
+		return 0;
+	}
+
+	double d;
+	if (digits <= 19 && mant <= ((u64)1 << 53) && exp >= -22 && exp <= 22) {
+		d = exp < 0 ? (double)mant / s_pow10[-exp] : (double)mant * s_pow10[exp];
+		d = neg ? -d : d;
+	} else {
+		const size_t len = (size_t)(p - start);
+
+		char buf[JSON_NUM_SIZE];
+		char *num = len < sizeof(buf) ? buf : mem_alloc(len + 1);
+		if (num == NULL) {
+			return 1;
+		}
+
+		mem_cpy(num, len + 1, start, len);
+		num[len] = '\0';
+		d	 = strtod(num, NULL);
+
+		if (num != buf) {
+			mem_free(num, len + 1);
+		}
+	}
+
+	if (d - d != 0) {
+		return 1;
+	}
+
+	*val = JSON_DOUBLE(d);
+	return 0;
+}
+
+static int parse_num(json_prs_t *prs, uint at, json_val_data_t *val)
+{
+	const char *stop;
+	if (num_parse(prs->idx->data + at, prs->idx->data + prs->idx->len, val, &stop) || !is_boundary(prs, (size_t)(stop - prs->idx->data))) {
+		return prs_error(prs, at, "invalid number");
+	}
+
+	return 0;
+}
+
+static int parse_lit(json_prs_t *prs, uint at, const char *lit, size_t len)
+{
+	if (prs->idx->len - at < len || memcmp(prs->idx->data + at, lit, len) != 0 || !is_boundary(prs, at + len)) {
+		return prs_error(prs, at, "invalid value");
+	}
+
+	return 0;
+}
+
+static json_val_t add_val(json_prs_t *prs, json_val_t parent, json_val_t *last, str_t name, json_val_data_t value)
+{
+	const json_val_t node = json_add_val_next(prs->json, parent, last ? *last : JSON_END, name, value);
+	if (node == JSON_END) {
+		str_free(&name);
+		if (value.type == JSON_VAL_STR) {
+			str_free(&value.val.s);
+		}
+		return JSON_END;
+	}
+
+	if (last) {
+		*last = node;
+	}
+
+	return node;
+}
+
+static int parse_val(json_prs_t *prs, json_val_t parent, json_val_t *last, str_t name, uint depth, json_val_t *out);
+
+static int parse_obj(json_prs_t *prs, json_val_t node, uint depth)
+{
+	json_val_t last = JSON_END;
+
+	if (prs_char(prs) == '}') {
+		prs->cur++;
+		return 0;
+	}
+
+	for (;;) {
+		if (prs_char(prs) != '"') {
+			return prs_error(prs, prs_peek(prs), "expected member name");
+		}
+
+		str_t name;
+		if (parse_str(prs, &name)) {
+			return 1;
+		}
+
+		if (prs_char(prs) != ':') {
+			str_free(&name);
+			return prs_error(prs, prs_peek(prs), "expected ':'");
+		}
+		prs->cur++;
+
+		if (parse_val(prs, node, &last, name, depth + 1, NULL)) {
+			return 1;
+		}
+
+		const char c = prs_char(prs);
+		if (c == '}') {
+			prs->cur++;
+			return 0;
+		}
+
+		if (c != ',') {
+			return prs_error(prs, prs_peek(prs), "expected ',' or '}'");
+		}
+		prs->cur++;
+	}
+}
+
+static int parse_arr(json_prs_t *prs, json_val_t node, uint depth)
+{
+	json_val_t last = JSON_END;
+
+	if (prs_char(prs) == ']') {
+		prs->cur++;
+		return 0;
+	}
+
+	for (;;) {
+		if (parse_val(prs, node, &last, str_null(), depth + 1, NULL)) {
+			return 1;
+		}
+
+		const char c = prs_char(prs);
+		if (c == ']') {
+			prs->cur++;
+			return 0;
+		}
+
+		if (c != ',') {
+			return prs_error(prs, prs_peek(prs), "expected ',' or ']'");
+		}
+		prs->cur++;
+	}
+}
+
+static int parse_val(json_prs_t *prs, json_val_t parent, json_val_t *last, str_t name, uint depth, json_val_t *out)
+{
+	const uint at = prs_peek(prs);
+
+	if (prs->cur >= prs->idx->cnt) {
+		str_free(&name);
+		return prs_error(prs, at, "unexpected end of input");
+	}
+
+	if (depth >= JSON_MAX_DEPTH) {
+		str_free(&name);
+		return prs_error(prs, at, "maximum depth exceeded");
+	}
+
+	json_val_data_t value;
+	int ret = 0;
+
+	switch (prs->idx->data[at]) {
+	case '{': value = JSON_OBJ(); break;
+	case '[': value = JSON_ARR(); break;
+	case '"':
+		value.type = JSON_VAL_STR;
+		ret	   = parse_str(prs, &value.val.s);
+		break;
+	case 't':
+		value = JSON_BOOL(1);
+		ret   = parse_lit(prs, at, CSTR("true"));
+		break;
+	case 'f':
+		value = JSON_BOOL(0);
+		ret   = parse_lit(prs, at, CSTR("false"));
+		break;
+	case 'n':
+		value = JSON_NULL();
+		ret   = parse_lit(prs, at, CSTR("null"));
+		break;
+	case '-':
+	case '0':
+	case '1':
+	case '2':
+	case '3':
+	case '4':
+	case '5':
+	case '6':
+	case '7':
+	case '8':
+	case '9': ret = parse_num(prs, at, &value); break;
+	default: ret = prs_error(prs, at, "unexpected character"); break;
+	}
+
+	if (ret) {
+		str_free(&name);
+		return 1;
+	}
+
+	if (value.type != JSON_VAL_STR) {
+		prs->cur++;
+	}
+
+	const json_val_t node = add_val(prs, parent, last, name, value);
+	if (node == JSON_END) {
+		return prs_error(prs, at, "failed to add value");
+	}
+
+	if (out) {
+		*out = node;
+	}
+
+	switch (value.type) {
+	case JSON_VAL_OBJ: return parse_obj(prs, node, depth);
+	case JSON_VAL_ARR: return parse_arr(prs, node, depth);
+	default: return 0;
+	}
+}
+
+json_val_t json_parse(json_t *json, const char *data, size_t len)
+{
+	if (json == NULL || data == NULL) {
+		return JSON_END;
+	}
+
+	json_idx_t idx;
+	if (json_idx_init(&idx, data, len) == NULL) {
+		return JSON_END;
+	}
+
+	json_prs_t prs = {
+		.json = json,
+		.idx  = &idx,
+	};
+
+	json_val_t root = JSON_END;
+	if (parse_val(&prs, JSON_END, NULL, str_null(), 0, &root)) {
+		root = JSON_END;
+	} else if (prs.cur < idx.cnt) {
+		prs_error(&prs, prs_peek(&prs), "unexpected data after value");
+		root = JSON_END;
+	}
+
+	json_idx_free(&idx);
+	return root;
+}
+
+json_ref_t json_ref_root(const json_idx_t *idx)
+{
+	return (json_ref_t){
+		.idx = idx,
+		.pos = idx && idx->cnt > 0 ? 0 : JSON_END,
+	};
+}
+
+static inline char ref_char(const json_idx_t *idx, uint i)
+{
+	return idx != NULL && i < idx->cnt ? idx->data[idx->pos[i]] : '\0';
+}
+
+static uint ref_skip(const json_idx_t *idx, uint i)
+{
+	const char c = ref_char(idx, i);
+	if (c == '"') {
+		return i + 2;
+	}
+
+	if (c != '{' && c != '[') {
+		return c == '\0' ? JSON_END : i + 1;
+	}
+
+	uint depth = 0;
+	for (; i < idx->cnt; i++) {
+		switch (idx->data[idx->pos[i]]) {
+		case '{':
+		case '[': depth++; break;
+		case '}':
+		case ']':
+			if (--depth == 0) {
+				return i + 1;
+			}
+			break;
+		default: break;
+		}
+	}
+
+	return JSON_END;
+}
+
+static int ref_key_eq(const json_idx_t *idx, uint i, const char *name, size_t len)
+{
+	json_prs_t prs = {
+		.idx = idx,
+		.cur = i,
+	};
+
+	str_t key;
+	if (parse_str(&prs, &key)) {
+		return 0;
+	}
+
+	const int eq = key.len == len && mem_cmp(key.data, name, len) == 0;
+	str_free(&key);
+	return eq;
+}
+
+json_ref_t json_ref_get(json_ref_t obj, const char *name, size_t len)
+{
+	json_ref_t ref = {
+		.idx = obj.idx,
+		.pos = JSON_END,
+	};
+
+	if (name == NULL || ref_char(obj.idx, obj.pos) != '{') {
+		return ref;
+	}
+
+	uint i = obj.pos + 1;
+	while (ref_char(obj.idx, i) == '"' && ref_char(obj.idx, i + 2) == ':') {
+		if (ref_key_eq(obj.idx, i, name, len)) {
+			ref.pos = ref_char(obj.idx, i + 3) ? i + 3 : JSON_END;
+			break;
+		}
+
+		i = ref_skip(obj.idx, i + 3);
+		if (ref_char(obj.idx, i) != ',') {
+			break;
+		}
+		i++;
+	}
+
+	return ref;
+}
+
+json_ref_t json_ref_at(json_ref_t arr, uint index)
+{
+	json_ref_t ref = {
+		.idx = arr.idx,
+		.pos = JSON_END,
+	};
+
+	if (ref_char(arr.idx, arr.pos) != '[' || ref_char(arr.idx, arr.pos + 1) == ']') {
+		return ref;
+	}
+
+	uint i = arr.pos + 1;
+	for (uint n = 0; n < index && i != JSON_END; n++) {
+		i = ref_skip(arr.idx, i);
+		i = ref_char(arr.idx, i) == ',' ? i + 1 : JSON_END;
+	}
+
+	ref.pos = ref_char(arr.idx, i) ? i : JSON_END;
+	return ref;
+}
+
+static uint ref_step(const void *priv, uint node, const char *name, size_t len, uint index)
+{
+	const json_ref_t ref = {
+		.idx = priv,
+		.pos = node,
+	};
+
+	if (ref_char(ref.idx, node) == '[') {
+		return index == JSON_END ? JSON_END : json_ref_at(ref, index).pos;
+	}
+
+	return json_ref_get(ref, name, len).pos;
+}
+
+json_ref_t json_ref_pointer(json_ref_t root, const char *ptr, size_t len)
+{
+	return (json_ref_t){
+		.idx = root.idx,
+		.pos = root.idx ? json_ptr_walk(ptr, len, root.pos, ref_step, root.idx) : JSON_END,
+	};
+}
+
+static int ref_num(json_ref_t ref, json_val_data_t *val)
+{
+	const char c = ref_char(ref.idx, ref.pos);
+	if (c != '-' && (c < '0' || c > '9')) {
+		return 1;
+	}
+
+	json_prs_t prs = {
+		.idx = ref.idx,
+		.cur = ref.pos,
+	};
+
+	return parse_num(&prs, ref.idx->pos[ref.pos], val);
+}
+
+int json_ref_type(json_ref_t ref, json_val_type_t *type)
+{
+	if (type == NULL) {
+		return 1;
+	}
+
+	json_val_data_t val;
+
+	switch (ref_char(ref.idx, ref.pos)) {
+	case '{': *type = JSON_VAL_OBJ; break;
+	case '[': *type = JSON_VAL_ARR; break;
+	case '"': *type = JSON_VAL_STR; break;
+	case 't':
+	case 'f': *type = JSON_VAL_BOOL; break;
+	case 'n': *type = JSON_VAL_NULL; break;
+	default:
+		if (ref_num(ref, &val)) {
+			return 1;
+		}
+		*type = val.type;
+		break;
+	}
+
+	return 0;
+}
+
+int json_ref_str(json_ref_t ref, str_t *str)
+{
+	if (str == NULL || ref_char(ref.idx, ref.pos) != '"') {
+		return 1;
+	}
+
+	json_prs_t prs = {
+		.idx = ref.idx,
+		.cur = ref.pos,
+	};
+
+	return parse_str(&prs, str);
+}
+
+int json_ref_int(json_ref_t ref, int *val)
+{
+	json_val_data_t num;
+	if (val == NULL || ref_num(ref, &num) || num.type != JSON_VAL_INT) {
+		return 1;
+	}
+
+	*val = num.val.i;
+	return 0;
+}
+
+int json_ref_double(json_ref_t ref, double *val)
+{
+	json_val_data_t num;
+	if (val == NULL || ref_num(ref, &num)) {
+		return 1;
+	}
+
+	*val = num.type == JSON_VAL_INT ? num.val.i : num.val.d;
+	return 0;
+}
+
+int json_ref_bool(json_ref_t ref, int *val)
+{
+	if (val == NULL) {
+		return 1;
+	}
+
+	json_prs_t prs = {
+		.idx = ref.idx,
+		.cur = ref.pos,
+	};
+
+	switch (ref_char(ref.idx, ref.pos)) {
+	case 't': *val = 1; return parse_lit(&prs, ref.idx->pos[ref.pos], CSTR("true"));
+	case 'f': *val = 0; return parse_lit(&prs, ref.idx->pos[ref.pos], CSTR("false"));
+	default: return 1;
+	}
+}
+
+json_val_t json_ref_load(json_ref_t ref, json_t *json)
+{
+	if (json == NULL || ref_char(ref.idx, ref.pos) == '\0') {
+		return JSON_END;
+	}
+
+	json_prs_t prs = {
+		.json = json,
+		.idx  = ref.idx,
+		.cur  = ref.pos,
+	};
+
+	json_val_t val = JSON_END;
+	if (parse_val(&prs, JSON_END, NULL, str_null(), 0, &val)) {
+		return JSON_END;
+	}
+
+	return val;
+}
+
+enum {
+	JSON_LEX_NONE,
+	JSON_LEX_STR,
+	JSON_LEX_NUM,
+	JSON_LEX_LIT,
+};
+
+enum {
+	JSON_ST_DONE,
+	JSON_ST_VAL,
+	JSON_ST_VAL_END,
+	JSON_ST_KEY,
+	JSON_ST_KEY_END,
+	JSON_ST_COLON,
+	JSON_ST_NEXT,
+	JSON_ST_ERROR,
+};
+
+json_pull_t *json_pull_init(json_pull_t *pull, size_t tok_size)
+{
+	if (pull == NULL || tok_size == 0) {
+		return NULL;
+	}
+
+	*pull = (json_pull_t){
+		.buf_size = tok_size,
+		.state	  = JSON_ST_DONE,
+		.evt	  = JSON_EVT_NONE,
+	};
+
+	pull->buf = mem_alloc(tok_size * 2);
+	if (pull->buf == NULL) {
+		log_error("cutils", "json", NULL, "failed to allocate token buffer");
+		return NULL;
+	}
+
+	return pull;
+}
+
+void json_pull_free(json_pull_t *pull)
+{
+	if (pull == NULL) {
+		return;
+	}
+
+	mem_free(pull->buf, pull->buf_size * 2);
+	pull->buf  = NULL;
+	pull->keep = NULL;
+}
+
+void json_pull_feed(json_pull_t *pull, const char *data, size_t len, bool last)
+{
+	if (pull == NULL || (data == NULL && len > 0)) {
+		return;
+	}
+
+	pull->pos += pull->len;
+	pull->data = data;
+	pull->len  = len;
+	pull->off  = 0;
+	pull->last = last;
+}
+
+static inline int pull_in_obj(const json_pull_t *pull, uint level)
+{
+	return pull->stack[level / 8] >> (level % 8) & 1;
+}
+
+static inline int pull_is_key(const json_pull_t *pull)
+{
+	return pull->state == JSON_ST_KEY || pull->state == JSON_ST_KEY_END;
+}
+
+static inline char *pull_tok(json_pull_t *pull)
+{
+	return pull_is_key(pull) ? pull->buf : pull->buf + pull->buf_size;
+}
+
+static json_evt_t pull_error(json_pull_t *pull, const char *msg)
+{
+	log_error("cutils", "json", NULL, "%zu: %s", pull->pos + pull->off, msg);
+	pull->state = JSON_ST_ERROR;
+	pull->lex   = JSON_LEX_NONE;
+	return JSON_EVT_ERROR;
+}
+
+static int pull_append(json_pull_t *pull, const char *data, size_t len)
+{
+	if (len > pull->buf_size - pull->buf_len) {
+		return 1;
+	}
+
+	mem_cpy(pull_tok(pull) + pull->buf_len, pull->buf_size - pull->buf_len, data, len);
+	pull->buf_len += len;
+	return 0;
+}
+
+static void pull_val_done(json_pull_t *pull)
+{
+	pull->state = pull->depth == 0 ? JSON_ST_DONE : JSON_ST_NEXT;
+}
+
+static json_evt_t pull_open(json_pull_t *pull, int obj)
+{
+	if (pull->depth >= JSON_MAX_DEPTH) {
+		return pull_error(pull, "maximum depth exceeded");
+	}
+
+	const byte bit = (byte)(1 << (pull->depth % 8));
+	if (obj) {
+		pull->stack[pull->depth / 8] |= bit;
+	} else {
+		pull->stack[pull->depth / 8] &= (byte)~bit;
+	}
+
+	pull->depth++;
+	pull->state = obj ? JSON_ST_KEY_END : JSON_ST_VAL_END;
+	return obj ? JSON_EVT_OBJ_START : JSON_EVT_ARR_START;
+}
+
+static json_evt_t pull_close(json_pull_t *pull)
+{
+	pull->depth--;
+	pull_val_done(pull);
+	return pull_in_obj(pull, pull->depth) ? JSON_EVT_OBJ_END : JSON_EVT_ARR_END;
+}
+
+static int lex_str(json_pull_t *pull, str_t *str)
+{
+	const char *start = pull->data + pull->off;
+	const char *end	  = pull->data + pull->len;
+	const char *p	  = start;
+
+	while (p < end) {
+		if (pull->esc) {
+			pull->esc = 0;
+			p++;
+			continue;
+		}
+
+		while (p < end && *p != '"' && *p != '\\' && (byte)*p >= 0x20) {
+			p++;
+		}
+
+		if (p == end) {
+			break;
+		}
+
+		if ((byte)*p < 0x20) {
+			pull->off = (size_t)(p - pull->data);
+			return -1;
+		}
+
+		if (*p == '\\') {
+			pull->esc     = 1;
+			pull->has_esc = 1;
+			p++;
+			continue;
+		}
+
+		pull->off = (size_t)(p + 1 - pull->data);
+
+		if (!pull_is_key(pull) && pull->buf_len == 0 && !pull->has_esc && (size_t)(p - start) <= pull->buf_size) {
+			*str = strc(start, (size_t)(p - start));
+			return 0;
+		}
+
+		if (pull_append(pull, start, (size_t)(p - start))) {
+			return -1;
+		}
+
+		char *tok  = pull_tok(pull);
+		size_t len = pull->has_esc ? unescape_to(tok, pull->buf_len, tok) : pull->buf_len;
+		if (len == (size_t)-1) {
+			return -1;
+		}
+
+		*str = strc(tok, len);
+		return 0;
+	}
+
+	pull->off = pull->len;
+	return pull_append(pull, start, (size_t)(end - start)) ? -1 : 1;
+}
+
+static inline int is_num_char(char c)
+{
+	return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static int lex_scalar(json_pull_t *pull, const char **tok, size_t *len)
+{
+	const char *start = pull->data + pull->off;
+	const char *end	  = pull->data + pull->len;
+	const char *p	  = start;
+
+	if (pull->lex == JSON_LEX_NUM) {
+		while (p < end && is_num_char(*p)) {
+			p++;
+		}
+	} else {
+		while (p < end && *p >= 'a' && *p <= 'z') {
+			p++;
+		}
+	}
+
+	pull->off = (size_t)(p - pull->data);
+
+	if (p == end && !pull->last) {
+		return pull_append(pull, start, (size_t)(p - start)) ? -1 : 1;
+	}
+
+	if (pull->buf_len == 0 && (size_t)(p - start) <= pull->buf_size) {
+		*tok = start;
+		*len = (size_t)(p - start);
+		return 0;
+	}
+
+	if (pull_append(pull, start, (size_t)(p - start))) {
+		return -1;
+	}
+
+	*tok = pull_tok(pull);
+	*len = pull->buf_len;
+	return 0;
+}
+
+static json_evt_t pull_lex(json_pull_t *pull)
+{
+	if (pull->lex == JSON_LEX_STR) {
+		str_t str;
+		const int ret = lex_str(pull, &str);
+		if (ret > 0) {
+			return pull->last ? pull_error(pull, "unterminated string") : JSON_EVT_NONE;
+		}
+
+		if (ret < 0) {
+			return pull_error(pull, "invalid string");
+		}
+
+		pull->lex = JSON_LEX_NONE;
+
+		if (pull_is_key(pull)) {
+			pull->key   = str;
+			pull->state = JSON_ST_COLON;
+			return JSON_EVT_KEY;
+		}
+
+		pull->val = JSON_STR(str);
+		pull_val_done(pull);
+		return JSON_EVT_VAL;
+	}
+
+	const char *tok;
+	size_t len;
+	const int ret = lex_scalar(pull, &tok, &len);
+	if (ret > 0) {
+		return JSON_EVT_NONE;
+	}
+
+	if (ret < 0) {
+		return pull_error(pull, "token too long");
+	}
+
+	if (pull->lex == JSON_LEX_NUM) {
+		const char *stop;
+		if (num_parse(tok, tok + len, &pull->val, &stop) || stop != tok + len) {
+			return pull_error(pull, "invalid number");
+		}
+	} else if (len == 4 && memcmp(tok, "true", 4) == 0) {
+		pull->val = JSON_BOOL(1);
+	} else if (len == 5 && memcmp(tok, "false", 5) == 0) {
+		pull->val = JSON_BOOL(0);
+	} else if (len == 4 && memcmp(tok, "null", 4) == 0) {
+		pull->val = JSON_NULL();
+	} else {
+		return pull_error(pull, "invalid literal");
+	}
+
+	pull->lex = JSON_LEX_NONE;
+	pull_val_done(pull);
+	return JSON_EVT_VAL;
+}
+
+static json_evt_t pull_val(json_pull_t *pull, char c)
+{
+	pull->buf_len = 0;
+
+	switch (c) {
+	case '{': pull->off++; return pull_open(pull, 1);
+	case '[': pull->off++; return pull_open(pull, 0);
+	case '"':
+		pull->off++;
+		pull->lex     = JSON_LEX_STR;
+		pull->esc     = 0;
+		pull->has_esc = 0;
+		return pull_lex(pull);
+	case 't':
+	case 'f':
+	case 'n': pull->lex = JSON_LEX_LIT; return pull_lex(pull);
+	case '-':
+	case '0':
+	case '1':
+	case '2':
+	case '3':
+	case '4':
+	case '5':
+	case '6':
+	case '7':
+	case '8':
+	case '9': pull->lex = JSON_LEX_NUM; return pull_lex(pull);
+	default: return pull_error(pull, "unexpected character");
+	}
+}
+
+static json_evt_t pull_next(json_pull_t *pull)
+{
+	if (pull->state == JSON_ST_ERROR) {
+		return JSON_EVT_ERROR;
+	}
+
+	if (pull->lex != JSON_LEX_NONE) {
+		return pull_lex(pull);
+	}
+
+	for (;;) {
+		while (pull->off < pull->len && (pull->data[pull->off] == ' ' || pull->data[pull->off] == '\t' || pull->data[pull->off] == '\n' || pull->data[pull->off] == '\r')) {
+			pull->off++;
+		}
+
+		if (pull->off == pull->len) {
+			if (!pull->last) {
+				return JSON_EVT_NONE;
+			}
+
+			return pull->state == JSON_ST_DONE ? JSON_EVT_END : pull_error(pull, "unexpected end of input");
+		}
+
+		const char c = pull->data[pull->off];
+
+		switch (pull->state) {
+		case JSON_ST_DONE:
+		case JSON_ST_VAL: return pull_val(pull, c);
+		case JSON_ST_VAL_END:
+			if (c == ']') {
+				pull->off++;
+				return pull_close(pull);
+			}
+			return pull_val(pull, c);
+		case JSON_ST_KEY_END:
+			if (c == '}') {
+				pull->off++;
+				return pull_close(pull);
+			}
+			/* falls through */
+		case JSON_ST_KEY:
+			if (c != '"') {
+				return pull_error(pull, "expected member name");
+			}
+			pull->off++;
+			pull->lex     = JSON_LEX_STR;
+			pull->esc     = 0;
+			pull->has_esc = 0;
+			pull->buf_len = 0;
+			return pull_lex(pull);
+		case JSON_ST_COLON:
+			if (c != ':') {
+				return pull_error(pull, "expected ':'");
+			}
+			pull->off++;
+			pull->state = JSON_ST_VAL;
+			break;
+		default:
+			if (c == ',') {
+				pull->off++;
+				pull->state = pull_in_obj(pull, pull->depth - 1) ? JSON_ST_KEY : JSON_ST_VAL;
+				break;
+			}
+
+			if (c != (pull_in_obj(pull, pull->depth - 1) ? '}' : ']')) {
+				return pull_error(pull, "expected ',' or closing bracket");
+			}
+			pull->off++;
+			return pull_close(pull);
+		}
+	}
+}
+
+static str_t keep_name(const json_pull_t *pull, json_t *json, uint level)
+{
+	if (level == 0 || !pull_in_obj(pull, level - 1)) {
+		return str_null();
+	}
+
+	return json_strn(json, pull->key.data, pull->key.len);
+}
+
+static json_val_data_t keep_val(const json_pull_t *pull, json_t *json)
+{
+	if (pull->val.type != JSON_VAL_STR) {
+		return pull->val;
+	}
+
+	return JSON_STR(json_strn(json, pull->val.val.s.data, pull->val.val.s.len));
+}
+
+static json_val_t keep_add(json_pull_t *pull, json_t *json, json_val_t parent, json_val_t *last, uint level, json_val_data_t value)
+{
+	str_t name	      = keep_name(pull, json, level);
+	const json_val_t node = last ? json_add_val_next(json, parent, *last, name, value) : json_add_val(json, parent, name, value);
+	if (node == JSON_END) {
+		str_free(&name);
+		if (value.type == JSON_VAL_STR) {
+			str_free(&value.val.s);
+		}
+		return JSON_END;
+	}
+
+	if (last) {
+		*last = node;
+	}
+
+	return node;
+}
+
+static void keep_open(json_pull_t *pull, json_val_data_t value)
+{
+	const uint level = pull->depth - 1;
+
+	pull->nodes[level] = keep_add(pull, pull->keep, pull->nodes[level - 1], &pull->lasts[level - 1], level, value);
+	pull->lasts[level] = JSON_END;
+}
+
+static void keep_evt(json_pull_t *pull, json_evt_t evt)
+{
+	switch (evt) {
+	case JSON_EVT_OBJ_START: keep_open(pull, JSON_OBJ()); break;
+	case JSON_EVT_ARR_START: keep_open(pull, JSON_ARR()); break;
+	case JSON_EVT_VAL: keep_add(pull, pull->keep, pull->nodes[pull->depth - 1], &pull->lasts[pull->depth - 1], pull->depth, keep_val(pull, pull->keep)); break;
+	case JSON_EVT_OBJ_END:
+	case JSON_EVT_ARR_END:
+		if (pull->depth < pull->keep_depth) {
+			pull->keep = NULL;
+		}
+		break;
+	case JSON_EVT_ERROR: pull->keep = NULL; break;
+	default: break;
+	}
+}
+
+json_evt_t json_pull_next(json_pull_t *pull)
+{
+	if (pull == NULL || pull->buf == NULL) {
+		return JSON_EVT_ERROR;
+	}
+
+	pull->evt = pull_next(pull);
+
+	if (pull->keep) {
+		keep_evt(pull, pull->evt);
+	}
+
+	return pull->evt;
+}
+
+json_val_t json_pull_keep(json_pull_t *pull, json_t *json, json_val_t parent)
+{
+	if (pull == NULL || json == NULL || pull->keep) {
+		return JSON_END;
+	}
+
+	switch (pull->evt) {
+	case JSON_EVT_VAL: return keep_add(pull, json, parent, NULL, pull->depth, keep_val(pull, json));
+	case JSON_EVT_OBJ_START:
+	case JSON_EVT_ARR_START: break;
+	default: return JSON_END;
+	}
+
+	const json_val_t node = keep_add(pull, json, parent, NULL, pull->depth - 1, pull->evt == JSON_EVT_OBJ_START ? JSON_OBJ() : JSON_ARR());
+	if (node == JSON_END) {
+		return JSON_END;
+	}
+
+	pull->keep		     = json;
+	pull->keep_depth	     = pull->depth;
+	pull->nodes[pull->depth - 1] = node;
+	pull->lasts[pull->depth - 1] = JSON_END;
+
+	return node;
+}
@@ -0,0 +1,568 @@
+#include "lz.h"
+
+#include "dbuf.h"
+#include "log.h"
+#include "mem.h"
+
+#include <string.h>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#define LZ_MAGIC "LZF1"
+
+#define LZ_MIN_MATCH	 4
+#define LZ_LAST_LITERALS 5
+#define LZ_MF_LIMIT	 12
+#define LZ_MAX_OFFSET	 65535
+#define LZ_HASH_LOG	 12
+#define LZ_SKIP_TRIGGER	 6
+
+#define LZ_FRAME_RAW 0x80000000U
+
+typedef struct lz_hdr_s {
+	char magic[4];
+	u32 block;
+} lz_hdr_t;
+
+static inline u32 read32(const byte *p)
+{
+	u32 val;
+	memcpy(&val, p, sizeof(val));
+	return val;
+}
+
+static inline u64 read64(const byte *p)
+{
+	u64 val;
+	memcpy(&val, p, sizeof(val));
+	return val;
+}
+
+static inline uint lz_ctz(u64 val)
+{
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward64(&idx, val);
+	return (uint)idx;
+#else
+	return (uint)__builtin_ctzll(val);
+#endif
+}
+
+static inline u32 lz_hash(u32 seq)
+{
+	return (seq * 2654435761U) >> (32 - LZ_HASH_LOG);
+}
+
+static size_t match_len(const byte *ip, const byte *ref, const byte *limit)
+{
+	const byte *start = ip;
+
+	while (ip + sizeof(u64) <= limit) {
+		const u64 diff = read64(ip) ^ read64(ref);
+		if (diff) {
+			return (size_t)(ip - start) + (lz_ctz(diff) >> 3);
+		}
+		ip += sizeof(u64);
+		ref += sizeof(u64);
+	}
+
+	while (ip < limit && *ip == *ref) {
+		ip++;
+		ref++;
+	}
+
+	return (size_t)(ip - start);
+}
+
+static byte *put_len(byte *op, size_t len)
+{
+	for (; len >= 255; len -= 255) {
+		*op++ = 255;
+	}
+	*op++ = (byte)len;
+	return op;
+}
+
+static byte *put_literals(byte *op, const byte *lit, size_t len, size_t match)
+{
+	*op++ = (byte)(((len < 15 ? len : 15) << 4) | (match < 15 ? match : 15));
+	if (len >= 15) {
+		op = put_len(op, len - 15);
+	}
+
+	memcpy(op, lit, len);
+	return op + len;
+}
+
+size_t lz_bound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t lz_compress(const void *src, size_t src_size, void *dst, size_t dst_size)
+{
+	if ((src == NULL && src_size > 0) || dst == NULL || src_size > LZ_MAX_INPUT || dst_size < lz_bound(src_size)) {
+		return LZ_ERR;
+	}
+
+	const byte *base   = src;
+	const byte *ip	   = base;
+	const byte *anchor = base;
+	const byte *end	   = base + src_size;
+	byte *op	   = dst;
+
+	if (src_size > LZ_MF_LIMIT) {
+		const byte *mflimit = end - LZ_MF_LIMIT;
+		const byte *mlimit  = end - LZ_LAST_LITERALS;
+
+		u32 table[1 << LZ_HASH_LOG] = { 0 };
+
+		ip++;
+		while (ip < mflimit) {
+			const u32 seq	= read32(ip);
+			const u32 hash	= lz_hash(seq);
+			const byte *ref = base + table[hash];
+
+			table[hash] = (u32)(ip - base);
+
+			if (ip - ref > LZ_MAX_OFFSET || read32(ref) != seq) {
+				ip += 1 + ((size_t)(ip - anchor) >> LZ_SKIP_TRIGGER);
+				continue;
+			}
+
+			while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+				ip--;
+				ref--;
+			}
+
+			const size_t match = match_len(ip + LZ_MIN_MATCH, ref + LZ_MIN_MATCH, mlimit);
+			const size_t off   = (size_t)(ip - ref);
+
+			op    = put_literals(op, anchor, (size_t)(ip - anchor), match);
+			*op++ = (byte)off;
+			*op++ = (byte)(off >> 8);
+			if (match >= 15) {
+				op = put_len(op, match - 15);
+			}
+
+			ip     = ip + LZ_MIN_MATCH + match;
+			anchor = ip;
+
+			if (ip < mflimit) {
+				table[lz_hash(read32(ip - 2))] = (u32)(ip - 2 - base);
+			}
+		}
+	}
+
+	op = put_literals(op, anchor, (size_t)(end - anchor), 0);
+
+	return (size_t)(op - (byte *)dst);
+}
+
+static inline void copy16(byte *dst, const byte *src, const byte *end)
+{
+	do {
+		memcpy(dst, src, 16);
+		dst += 16;
+		src += 16;
+	} while (dst < end);
+}
+
+static inline void copy8(byte *dst, const byte *src, const byte *end)
+{
+	do {
+		memcpy(dst, src, 8);
+		dst += 8;
+		src += 8;
+	} while (dst < end);
+}
+
+static int get_len(const byte **ip, const byte *end, size_t *len)
+{
+	uint val;
+	do {
+		if (*ip >= end) {
+			return 1;
+		}
+		val = *(*ip)++;
+		*len += val;
+	} while (val == 255);
+
+	return 0;
+}
+
+size_t lz_decompress(const void *src, size_t src_size, void *dst, size_t dst_size)
+{
+	if (src == NULL || (dst == NULL && dst_size > 0)) {
+		return LZ_ERR;
+	}
+
+	const byte *ip	 = src;
+	const byte *iend = ip + src_size;
+	byte *op	 = dst;
+	byte *oend	 = op + dst_size;
+
+	while (ip < iend) {
+		const uint token = *ip++;
+
+		size_t lit = token >> 4;
+		if (lit < 15 && iend - ip >= 32 && oend - op >= 32) {
+			memcpy(op, ip, 16);
+		} else {
+			if (lit == 15 && get_len(&ip, iend, &lit)) {
+				return LZ_ERR;
+			}
+
+			if (lit > (size_t)(iend - ip) || lit > (size_t)(oend - op)) {
+				return LZ_ERR;
+			}
+
+			if ((size_t)(iend - ip) >= lit + 16 && (size_t)(oend - op) >= lit + 16) {
+				copy16(op, ip, op + lit);
+			} else {
+				memcpy(op, ip, lit);
+			}
+		}
+		ip += lit;
+		op += lit;
+
+		if (ip == iend) {
+			break;
+		}
+
+		if (iend - ip < 2) {
+			return LZ_ERR;
+		}
+
+		const size_t off = (size_t)ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+
+		if (off == 0 || off > (size_t)(op - (byte *)dst)) {
+			return LZ_ERR;
+		}
+
+		size_t match = token & 15;
+		if (match < 15 && off >= 8 && oend - op >= 18) {
+			const byte *ref = op - off;
+			memcpy(op, ref, 8);
+			memcpy(op + 8, ref + 8, 8);
+			memcpy(op + 16, ref + 16, 2);
+			op += match + LZ_MIN_MATCH;
+			continue;
+		}
+
+		if (match == 15 && get_len(&ip, iend, &match)) {
+			return LZ_ERR;
+		}
+		match += LZ_MIN_MATCH;
+
+		if (match > (size_t)(oend - op)) {
+			return LZ_ERR;
+		}
+
+		const byte *ref = op - off;
+		byte *mend	= op + match;
+
+		if (off >= 16 && oend - mend >= 16) {
+			copy16(op, ref, mend);
+		} else if (off >= 8 && oend - mend >= 8) {
+			copy8(op, ref, mend);
+		} else if (off == 1) {
+			memset(op, *ref, match);
+		} else {
+			for (byte *cur = op; cur < mend; cur++) {
+				*cur = *ref++;
+			}
+		}
+		op = mend;
+	}
+
+	return (size_t)(op - (byte *)dst);
+}
+
+lz_writer_t *lz_writer_init(lz_writer_t *writer, FILE *file)
+{
+	if (writer == NULL || file == NULL) {
+		return NULL;
+	}
+
+	writer->buf = mem_alloc(LZ_BLOCK_SIZE);
+	if (writer->buf == NULL) {
+		log_error("cutils", "lz", NULL, "failed to allocate buffers");
+		return NULL;
+	}
+
+	writer->out = mem_alloc(lz_bound(LZ_BLOCK_SIZE));
+	if (writer->out == NULL) {
+		log_error("cutils", "lz", NULL, "failed to allocate buffers");
+		mem_free(writer->buf, LZ_BLOCK_SIZE);
+		return NULL;
+	}
+
+	writer->file = file;
+	writer->len  = 0;
+	writer->err  = 0;
+	hash128_init(&writer->hash);
+
+	lz_hdr_t hdr = { .block = LZ_BLOCK_SIZE };
+	mem_cpy(hdr.magic, sizeof(hdr.magic), LZ_MAGIC, sizeof(hdr.magic));
+	if (fwrite(&hdr, sizeof(hdr), 1, file) != 1) {
+		writer->err = 1;
+	}
+
+	return writer;
+}
+
+static int writer_flush(lz_writer_t *writer)
+{
+	if (writer->len == 0) {
+		return writer->err;
+	}
+
+	hash128_update(&writer->hash, writer->buf, writer->len);
+
+	const size_t size = lz_compress(writer->buf, writer->len, writer->out, lz_bound(LZ_BLOCK_SIZE));
+
+	u32 hdr;
+	const byte *data;
+	if (size < writer->len) {
+		hdr  = (u32)size;
+		data = writer->out;
+	} else {
+		hdr  = (u32)writer->len | LZ_FRAME_RAW;
+		data = writer->buf;
+	}
+
+	const size_t len = hdr & ~LZ_FRAME_RAW;
+	if (fwrite(&hdr, sizeof(hdr), 1, writer->file) != 1 || fwrite(data, 1, len, writer->file) != len) {
+		writer->err = 1;
+	}
+
+	writer->len = 0;
+	return writer->err;
+}
+
+int lz_write(lz_writer_t *writer, const void *data, size_t size)
+{
+	if (writer == NULL || writer->file == NULL || (data == NULL && size > 0)) {
+		return 1;
+	}
+
+	const byte *cur = data;
+	while (size > 0) {
+		size_t len = LZ_BLOCK_SIZE - writer->len;
+		if (len > size) {
+			len = size;
+		}
+
+		mem_cpy(writer->buf + writer->len, LZ_BLOCK_SIZE - writer->len, cur, len);
+		writer->len += len;
+		cur += len;
+		size -= len;
+
+		if (writer->len == LZ_BLOCK_SIZE && writer_flush(writer)) {
+			return 1;
+		}
+	}
+
+	return writer->err;
+}
+
+int lz_writer_close(lz_writer_t *writer)
+{
+	if (writer == NULL || writer->file == NULL) {
+		return 1;
+	}
+
+	int ret = writer_flush(writer);
+
+	byte digest[16];
+	hash128_final(&writer->hash, digest);
+
+	const u32 end = 0;
+	if (fwrite(&end, sizeof(end), 1, writer->file) != 1 || fwrite(digest, sizeof(u64), 1, writer->file) != 1) {
+		ret = 1;
+	}
+
+	if (ret) {
+		log_error("cutils", "lz", NULL, "failed to write frame");
+	}
+
+	mem_free(writer->buf, LZ_BLOCK_SIZE);
+	mem_free(writer->out, lz_bound(LZ_BLOCK_SIZE));
+	writer->buf  = NULL;
+	writer->out  = NULL;
+	writer->file = NULL;
+
+	return ret;
+}
+
+lz_reader_t *lz_reader_init(lz_reader_t *reader, FILE *file)
+{
+	if (reader == NULL || file == NULL) {
+		return NULL;
+	}
+
+	lz_hdr_t hdr;
+	if (fread(&hdr, sizeof(hdr), 1, file) != 1 || mem_cmp(hdr.magic, LZ_MAGIC, sizeof(hdr.magic)) != 0 || hdr.block != LZ_BLOCK_SIZE) {
+		log_error("cutils", "lz", NULL, "invalid frame header");
+		return NULL;
+	}
+
+	reader->buf = mem_alloc(LZ_BLOCK_SIZE);
+	if (reader->buf == NULL) {
+		log_error("cutils", "lz", NULL, "failed to allocate buffers");
+		return NULL;
+	}
+
+	reader->in = mem_alloc(LZ_BLOCK_SIZE);
+	if (reader->in == NULL) {
+		log_error("cutils", "lz", NULL, "failed to allocate buffers");
+		mem_free(reader->buf, LZ_BLOCK_SIZE);
+		return NULL;
+	}
+
+	reader->file = file;
+	reader->len  = 0;
+	reader->pos  = 0;
+	reader->end  = 0;
+	hash128_init(&reader->hash);
+
+	return reader;
+}
+
+static int reader_fill(lz_reader_t *reader)
+{
+	u32 hdr;
+	if (fread(&hdr, sizeof(hdr), 1, reader->file) != 1) {
+		log_error("cutils", "lz", NULL, "unexpected end of frame");
+		return 1;
+	}
+
+	reader->len = 0;
+	reader->pos = 0;
+
+	if (hdr == 0) {
+		byte digest[16];
+		hash128_final(&reader->hash, digest);
+
+		byte check[sizeof(u64)];
+		if (fread(check, sizeof(check), 1, reader->file) != 1 || mem_cmp(check, digest, sizeof(check)) != 0) {
+			log_error("cutils", "lz", NULL, "checksum mismatch");
+			return 1;
+		}
+
+		reader->end = 1;
+		return 0;
+	}
+
+	const size_t size = hdr & ~LZ_FRAME_RAW;
+	if (size > LZ_BLOCK_SIZE) {
+		log_error("cutils", "lz", NULL, "invalid block size: %zu", size);
+		return 1;
+	}
+
+	if (hdr & LZ_FRAME_RAW) {
+		if (fread(reader->buf, 1, size, reader->file) != size) {
+			log_error("cutils", "lz", NULL, "unexpected end of frame");
+			return 1;
+		}
+		reader->len = size;
+	} else {
+		if (fread(reader->in, 1, size, reader->file) != size) {
+			log_error("cutils", "lz", NULL, "unexpected end of frame");
+			return 1;
+		}
+
+		reader->len = lz_decompress(reader->in, size, reader->buf, LZ_BLOCK_SIZE);
+		if (reader->len == LZ_ERR) {
+			log_error("cutils", "lz", NULL, "corrupted block");
+			reader->len = 0;
+			return 1;
+		}
+	}
+
+	hash128_update(&reader->hash, reader->buf, reader->len);
+	return 0;
+}
+
+size_t lz_read(lz_reader_t *reader, void *data, size_t size)
+{
+	if (reader == NULL || reader->file == NULL || (data == NULL && size > 0)) {
+		return LZ_ERR;
+	}
+
+	byte *cur = data;
+	size_t rd = 0;
+	while (rd < size) {
+		if (reader->pos == reader->len) {
+			if (reader->end) {
+				break;
+			}
+
+			if (reader_fill(reader)) {
+				return LZ_ERR;
+			}
+			continue;
+		}
+
+		size_t len = reader->len - reader->pos;
+		if (len > size - rd) {
+			len = size - rd;
+		}
+
+		mem_cpy(cur + rd, size - rd, reader->buf + reader->pos, len);
+		reader->pos += len;
+		rd += len;
+	}
+
+	return rd;
+}
+
+size_t lz_print(lz_reader_t *reader, print_dst_t dst)
+{
+	if (reader == NULL || reader->file == NULL) {
+		return LZ_ERR;
+	}
+
+	char data[DBUF_STACK_SIZE];
+	dbuf_t buf;
+	dbuf_init_ext(&buf, data, sizeof(data), dst);
+
+	int ret = 0;
+	while (!reader->end || reader->pos < reader->len) {
+		if (reader->pos == reader->len) {
+			if (reader_fill(reader)) {
+				ret = 1;
+				break;
+			}
+			continue;
+		}
+
+		if (buf.sink) {
+			dbuf_cat(&buf, (const char *)reader->buf + reader->pos, reader->len - reader->pos);
+		}
+		reader->pos = reader->len;
+	}
+
+	dbuf_flush(&buf);
+	dbuf_free(&buf);
+
+	return ret ? LZ_ERR : (size_t)(buf.dst.off - dst.off);
+}
+
+void lz_reader_free(lz_reader_t *reader)
+{
+	if (reader == NULL || reader->file == NULL) {
+		return;
+	}
+
+	mem_free(reader->buf, LZ_BLOCK_SIZE);
+	mem_free(reader->in, LZ_BLOCK_SIZE);
+	reader->buf  = NULL;
+	reader->in   = NULL;
+	reader->file = NULL;
+}
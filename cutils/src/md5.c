@@ -1,102 +1,387 @@
 #include "md5.h"
 
+#include "digest.h"
 #include "mem.h"
 
-#include <stdio.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define MD5_SSE2
+	#include <emmintrin.h>
+#endif
 
-u32 func0(u32 B, u32 C, u32 D)
+#define MD5_FF(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_GG(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_HH(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_II(x, y, z) ((y) ^ ((x) | ~(z)))
+#define MD5_ROL(x, n)   (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define MD5_STEPS(S)                          \
+	S(FF, A, B, C, D, 0, 0xd76aa478, 7)   \
+	S(FF, D, A, B, C, 1, 0xe8c7b756, 12)  \
+	S(FF, C, D, A, B, 2, 0x242070db, 17)  \
+	S(FF, B, C, D, A, 3, 0xc1bdceee, 22)  \
+	S(FF, A, B, C, D, 4, 0xf57c0faf, 7)   \
+	S(FF, D, A, B, C, 5, 0x4787c62a, 12)  \
+	S(FF, C, D, A, B, 6, 0xa8304613, 17)  \
+	S(FF, B, C, D, A, 7, 0xfd469501, 22)  \
+	S(FF, A, B, C, D, 8, 0x698098d8, 7)   \
+	S(FF, D, A, B, C, 9, 0x8b44f7af, 12)  \
+	S(FF, C, D, A, B, 10, 0xffff5bb1, 17) \
+	S(FF, B, C, D, A, 11, 0x895cd7be, 22) \
+	S(FF, A, B, C, D, 12, 0x6b901122, 7)  \
+	S(FF, D, A, B, C, 13, 0xfd987193, 12) \
+	S(FF, C, D, A, B, 14, 0xa679438e, 17) \
+	S(FF, B, C, D, A, 15, 0x49b40821, 22) \
+	S(GG, A, B, C, D, 1, 0xf61e2562, 5)   \
+	S(GG, D, A, B, C, 6, 0xc040b340, 9)   \
+	S(GG, C, D, A, B, 11, 0x265e5a51, 14) \
+	S(GG, B, C, D, A, 0, 0xe9b6c7aa, 20)  \
+	S(GG, A, B, C, D, 5, 0xd62f105d, 5)   \
+	S(GG, D, A, B, C, 10, 0x02441453, 9)  \
+	S(GG, C, D, A, B, 15, 0xd8a1e681, 14) \
+	S(GG, B, C, D, A, 4, 0xe7d3fbc8, 20)  \
+	S(GG, A, B, C, D, 9, 0x21e1cde6, 5)   \
+	S(GG, D, A, B, C, 14, 0xc33707d6, 9)  \
+	S(GG, C, D, A, B, 3, 0xf4d50d87, 14)  \
+	S(GG, B, C, D, A, 8, 0x455a14ed, 20)  \
+	S(GG, A, B, C, D, 13, 0xa9e3e905, 5)  \
+	S(GG, D, A, B, C, 2, 0xfcefa3f8, 9)   \
+	S(GG, C, D, A, B, 7, 0x676f02d9, 14)  \
+	S(GG, B, C, D, A, 12, 0x8d2a4c8a, 20) \
+	S(HH, A, B, C, D, 5, 0xfffa3942, 4)   \
+	S(HH, D, A, B, C, 8, 0x8771f681, 11)  \
+	S(HH, C, D, A, B, 11, 0x6d9d6122, 16) \
+	S(HH, B, C, D, A, 14, 0xfde5380c, 23) \
+	S(HH, A, B, C, D, 1, 0xa4beea44, 4)   \
+	S(HH, D, A, B, C, 4, 0x4bdecfa9, 11)  \
+	S(HH, C, D, A, B, 7, 0xf6bb4b60, 16)  \
+	S(HH, B, C, D, A, 10, 0xbebfbc70, 23) \
+	S(HH, A, B, C, D, 13, 0x289b7ec6, 4)  \
+	S(HH, D, A, B, C, 0, 0xeaa127fa, 11)  \
+	S(HH, C, D, A, B, 3, 0xd4ef3085, 16)  \
+	S(HH, B, C, D, A, 6, 0x04881d05, 23)  \
+	S(HH, A, B, C, D, 9, 0xd9d4d039, 4)   \
+	S(HH, D, A, B, C, 12, 0xe6db99e5, 11) \
+	S(HH, C, D, A, B, 15, 0x1fa27cf8, 16) \
+	S(HH, B, C, D, A, 2, 0xc4ac5665, 23)  \
+	S(II, A, B, C, D, 0, 0xf4292244, 6)   \
+	S(II, D, A, B, C, 7, 0x432aff97, 10)  \
+	S(II, C, D, A, B, 14, 0xab9423a7, 15) \
+	S(II, B, C, D, A, 5, 0xfc93a039, 21)  \
+	S(II, A, B, C, D, 12, 0x655b59c3, 6)  \
+	S(II, D, A, B, C, 3, 0x8f0ccc92, 10)  \
+	S(II, C, D, A, B, 10, 0xffeff47d, 15) \
+	S(II, B, C, D, A, 1, 0x85845dd1, 21)  \
+	S(II, A, B, C, D, 8, 0x6fa87e4f, 6)   \
+	S(II, D, A, B, C, 15, 0xfe2ce6e0, 10) \
+	S(II, C, D, A, B, 6, 0xa3014314, 15)  \
+	S(II, B, C, D, A, 13, 0x4e0811a1, 21) \
+	S(II, A, B, C, D, 4, 0xf7537e82, 6)   \
+	S(II, D, A, B, C, 11, 0xbd3af235, 10) \
+	S(II, C, D, A, B, 2, 0x2ad7d2bb, 15)  \
+	S(II, B, C, D, A, 9, 0xeb86d391, 21)
+
+#define MD5_STEP(f, a, b, c, d, i, t, s) a = b + MD5_ROL(a + MD5_##f(b, c, d) + w[i] + t, s);
+
+static const u32 s_iv[4] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+
+static inline u32 md5_load(const byte *p)
 {
-	return (B & C) | (~B & D);
+	return (u32)p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 | (u32)p[3] << 24;
 }
 
-u32 func1(u32 B, u32 C, u32 D)
+static void md5_block(u32 *h, const byte *block)
 {
-	return (D & B) | (~D & C);
+	u32 w[16];
+	for (int i = 0; i < 16; i++) {
+		w[i] = md5_load(block + i * 4);
+	}
+
+	u32 A = h[0];
+	u32 B = h[1];
+	u32 C = h[2];
+	u32 D = h[3];
+
+	MD5_STEPS(MD5_STEP)
+
+	h[0] += A;
+	h[1] += B;
+	h[2] += C;
+	h[3] += D;
 }
 
-u32 func2(u32 B, u32 C, u32 D)
+static void md5_blocks(void *h, const byte *data, size_t cnt)
 {
-	return B ^ C ^ D;
+	for (; cnt > 0; cnt--, data += 64) {
+		md5_block(h, data);
+	}
 }
 
-u32 func3(u32 B, u32 C, u32 D)
+static void md5_digest(const u32 *h, byte *digest)
 {
-	return C ^ (B | ~D);
+	for (int i = 0; i < 16; i++) {
+		digest[i] = (byte)(h[i / 4] >> (i % 4 * 8));
+	}
 }
 
-typedef u32 (*dgst_fn)(u32 B, u32 C, u32 D);
+md5_t *md5_init(md5_t *ctx)
+{
+	if (ctx == NULL) {
+		return NULL;
+	}
+
+	mem_cpy(ctx->h, sizeof(ctx->h), s_iv, sizeof(s_iv));
+	ctx->len = 0;
 
-u32 rol(u32 r, short N)
+	return ctx;
+}
+
+void md5_update(md5_t *ctx, const void *data, size_t len)
 {
-	u32 mask1 = (1 << N) - 1;
-	return ((r >> (32 - N)) & mask1) | ((r << N) & ~mask1);
+	if (ctx == NULL || data == NULL) {
+		return;
+	}
+
+	digest_update(ctx->h, ctx->block, sizeof(ctx->block), &ctx->len, data, len, md5_blocks);
 }
 
-static dgst_fn ff[]   = { func0, func1, func2, func3 };
-static u16 M[]	      = { 1, 5, 3, 7 };
-static u16 O[]	      = { 0, 1, 5, 0 };
-static u16 rots[4][4] = { { 7, 12, 17, 22 }, { 5, 9, 14, 20 }, { 4, 11, 16, 23 }, { 6, 10, 15, 21 } };
-static u32 k[64]      = {
-	     0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122,
-	     0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8, 0x21e1cde6, 0xc33707d6,
-	     0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60,
-	     0xbebfbc70, 0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665, 0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
-	     0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
-};
+void md5_final(md5_t *ctx, byte *digest)
+{
+	if (ctx == NULL || digest == NULL) {
+		return;
+	}
 
-int md5(const char *msg, size_t msg_len, byte *buf, size_t buf_size, char *out, size_t out_size)
+	size_t used    = ctx->len % 64;
+	const u64 bits = ctx->len * 8;
+
+	ctx->block[used++] = 0x80;
+	if (used > 56) {
+		mem_set(ctx->block + used, 0, 64 - used);
+		md5_block(ctx->h, ctx->block);
+		used = 0;
+	}
+
+	mem_set(ctx->block + used, 0, 56 - used);
+	for (int i = 0; i < 8; i++) {
+		ctx->block[56 + i] = (byte)(bits >> (i * 8));
+	}
+
+	md5_block(ctx->h, ctx->block);
+	md5_digest(ctx->h, digest);
+}
+
+static void md5_update_cb(void *ctx, const void *data, size_t len)
 {
-	if (msg == NULL || buf == NULL) {
+	md5_update(ctx, data, len);
+}
+
+int md5_file(const char *path, byte *digest)
+{
+	if (path == NULL || digest == NULL) {
 		return 1;
 	}
 
-	union {
-		u32 h[4];
-		u8 b[16];
-	} o = { .h = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 } };
+	md5_t ctx;
+	md5_init(&ctx);
 
-	size_t chunk_cnt = 1 + (msg_len + 8) / 64;
-	if (64 * chunk_cnt > buf_size) {
+	if (digest_file(path, &ctx, md5_update_cb)) {
 		return 1;
 	}
 
-	mem_cpy(buf, buf_size, msg, msg_len);
-	buf[msg_len] = (byte)0x80;
-	size_t bits  = 8 * msg_len;
-	mem_cpy(buf + 64 * chunk_cnt - 8, buf_size, &bits, 4);
-
-	for (size_t chunk = 0; chunk < chunk_cnt; chunk++) {
-		u32 *w = (u32 *)(buf + chunk * 64);
-		u32 A  = o.h[0];
-		u32 B  = o.h[1];
-		u32 C  = o.h[2];
-		u32 D  = o.h[3];
-
-		for (int i = 0; i < 4; i++) {
-			dgst_fn fctn = ff[i];
-			u16 *rotn    = rots[i];
-			u16 m	     = M[i];
-			u16 o	     = O[i];
-			for (u16 j = 0; j < 16; j++) {
-				u16 g = (m * j + o) % 16;
-				u32 f = B + rol(A + fctn(B, C, D) + k[j + 16 * i] + w[g], rotn[j % 4]);
-
-				A = D;
-				D = C;
-				C = B;
-				B = f;
+	md5_final(&ctx, digest);
+	return 0;
+}
+
+#if defined(MD5_SSE2)
+	#define MD5_LANES 4
+
+	#define MD5_SSE_FF(x, y, z) _mm_xor_si128(z, _mm_and_si128(x, _mm_xor_si128(y, z)))
+	#define MD5_SSE_GG(x, y, z) _mm_xor_si128(y, _mm_and_si128(z, _mm_xor_si128(x, y)))
+	#define MD5_SSE_HH(x, y, z) _mm_xor_si128(_mm_xor_si128(x, y), z)
+	#define MD5_SSE_II(x, y, z) _mm_xor_si128(y, _mm_or_si128(x, _mm_xor_si128(z, ones)))
+	#define MD5_SSE_STEP(f, a, b, c, d, i, t, s)                                                                    \
+		a = _mm_add_epi32(_mm_add_epi32(a, MD5_SSE_##f(b, c, d)), _mm_add_epi32(w[i], _mm_set1_epi32((int)t))); \
+		a = _mm_add_epi32(b, _mm_or_si128(_mm_slli_epi32(a, s), _mm_srli_epi32(a, 32 - s)));
+
+typedef struct md5_lane_s {
+	md5_msg_t *msg;
+	size_t block;
+	size_t full;
+	size_t blocks;
+	u32 h[4];
+	byte tail[128];
+} md5_lane_t;
+
+static void md5_lane_init(md5_lane_t *lane, md5_msg_t *msg)
+{
+	const size_t rem = msg->len % 64;
+
+	lane->msg    = msg;
+	lane->block  = 0;
+	lane->full   = msg->len / 64;
+	lane->blocks = lane->full + (rem < 56 ? 1 : 2);
+	mem_cpy(lane->h, sizeof(lane->h), s_iv, sizeof(s_iv));
+
+	const size_t size = (lane->blocks - lane->full) * 64;
+	const u64 bits	  = (u64)msg->len * 8;
+
+	mem_set(lane->tail, 0, size);
+	if (rem > 0) {
+		mem_cpy(lane->tail, sizeof(lane->tail), (const byte *)msg->data + lane->full * 64, rem);
+	}
+
+	lane->tail[rem] = 0x80;
+	for (int i = 0; i < 8; i++) {
+		lane->tail[size - 8 + i] = (byte)(bits >> (i * 8));
+	}
+}
+
+static inline const byte *md5_lane_block(const md5_lane_t *lane)
+{
+	return lane->block < lane->full ? (const byte *)lane->msg->data + lane->block * 64 : lane->tail + (lane->block - lane->full) * 64;
+}
+
+static void md5_block_x4(md5_lane_t *lanes)
+{
+	const __m128i ones = _mm_set1_epi32(-1);
+
+	const byte *p0 = md5_lane_block(&lanes[0]);
+	const byte *p1 = md5_lane_block(&lanes[1]);
+	const byte *p2 = md5_lane_block(&lanes[2]);
+	const byte *p3 = md5_lane_block(&lanes[3]);
+
+	__m128i w[16];
+	for (int i = 0; i < 4; i++) {
+		const __m128i r0 = _mm_loadu_si128((const __m128i *)(p0 + i * 16));
+		const __m128i r1 = _mm_loadu_si128((const __m128i *)(p1 + i * 16));
+		const __m128i r2 = _mm_loadu_si128((const __m128i *)(p2 + i * 16));
+		const __m128i r3 = _mm_loadu_si128((const __m128i *)(p3 + i * 16));
+
+		const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+		const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+		const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+		const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+		w[i * 4 + 0] = _mm_unpacklo_epi64(t0, t1);
+		w[i * 4 + 1] = _mm_unpackhi_epi64(t0, t1);
+		w[i * 4 + 2] = _mm_unpacklo_epi64(t2, t3);
+		w[i * 4 + 3] = _mm_unpackhi_epi64(t2, t3);
+	}
+
+	__m128i h[4];
+	for (int i = 0; i < 4; i++) {
+		h[i] = _mm_set_epi32((int)lanes[3].h[i], (int)lanes[2].h[i], (int)lanes[1].h[i], (int)lanes[0].h[i]);
+	}
+
+	__m128i A = h[0];
+	__m128i B = h[1];
+	__m128i C = h[2];
+	__m128i D = h[3];
+
+	MD5_STEPS(MD5_SSE_STEP)
+
+	h[0] = _mm_add_epi32(h[0], A);
+	h[1] = _mm_add_epi32(h[1], B);
+	h[2] = _mm_add_epi32(h[2], C);
+	h[3] = _mm_add_epi32(h[3], D);
+
+	for (int i = 0; i < 4; i++) {
+		u32 out[MD5_LANES];
+		_mm_storeu_si128((__m128i *)out, h[i]);
+		for (int l = 0; l < MD5_LANES; l++) {
+			lanes[l].h[i] = out[l];
+		}
+	}
+}
+#endif
+
+int md5_batch(md5_msg_t *msgs, uint cnt)
+{
+	if (msgs == NULL) {
+		return 1;
+	}
+
+	for (uint i = 0; i < cnt; i++) {
+		if (msgs[i].data == NULL && msgs[i].len > 0) {
+			return 1;
+		}
+	}
+
+#if defined(MD5_SSE2)
+	md5_lane_t lanes[MD5_LANES];
+	uint active = 0;
+	uint next   = 0;
+
+	for (uint l = 0; l < MD5_LANES; l++) {
+		lanes[l].msg = NULL;
+		if (next < cnt) {
+			md5_lane_init(&lanes[l], &msgs[next++]);
+			active++;
+		}
+	}
+
+	while (active == MD5_LANES) {
+		md5_block_x4(lanes);
+
+		for (uint l = 0; l < MD5_LANES; l++) {
+			md5_lane_t *lane = &lanes[l];
+			if (++lane->block < lane->blocks) {
+				continue;
+			}
+
+			md5_digest(lane->h, lane->msg->digest);
+			if (next < cnt) {
+				md5_lane_init(lane, &msgs[next++]);
+			} else {
+				lane->msg = NULL;
+				active--;
 			}
 		}
+	}
 
-		o.h[0] += A;
-		o.h[1] += B;
-		o.h[2] += C;
-		o.h[3] += D;
+	for (uint l = 0; l < MD5_LANES; l++) {
+		md5_lane_t *lane = &lanes[l];
+		if (lane->msg == NULL) {
+			continue;
+		}
+
+		for (; lane->block < lane->blocks; lane->block++) {
+			md5_block(lane->h, md5_lane_block(lane));
+		}
+
+		md5_digest(lane->h, lane->msg->digest);
+	}
+#else
+	for (uint i = 0; i < cnt; i++) {
+		md5_t ctx;
+		md5_init(&ctx);
+		md5_update(&ctx, msgs[i].data, msgs[i].len);
+		md5_final(&ctx, msgs[i].digest);
 	}
+#endif
+
+	return 0;
+}
+
+int md5(const char *msg, size_t msg_len, byte *buf, size_t buf_size, char *out, size_t out_size)
+{
+	if (msg == NULL || buf == NULL) {
+		return 1;
+	}
+
+	size_t chunk_cnt = 1 + (msg_len + 8) / 64;
+	if (64 * chunk_cnt > buf_size) {
+		return 1;
+	}
+
+	md5_t ctx;
+	byte o[16];
+
+	md5_init(&ctx);
+	md5_update(&ctx, msg, msg_len);
+	md5_final(&ctx, o);
 
 	if (out) {
-		snprintf(out, out_size, "%02X%02X%02X%02X-%02X%02X-%02X%02X-%02X%02X-%02X%02X%02X%02X%02X%02X", o.b[0], o.b[1], o.b[2], o.b[3], o.b[4], o.b[5], o.b[6],
-			 o.b[7], o.b[8], o.b[9], o.b[10], o.b[11], o.b[12], o.b[13], o.b[14], o.b[15]);
+		digest_guid(o, out, out_size);
 	}
 
 	return 0;
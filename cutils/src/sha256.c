@@ -0,0 +1,245 @@
+#include "sha256.h"
+
+#include "digest.h"
+#include "mem.h"
+#include "thread.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define SHA256_X86
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define SHA256_TARGET
+	#else
+		#include <cpuid.h>
+		#define SHA256_TARGET __attribute__((target("sha,sse4.1")))
+	#endif
+	#include <immintrin.h>
+#endif
+
+#define SHA256_ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+typedef void (*sha256_blocks_fn)(u32 *h, const byte *data, size_t cnt);
+
+static const u32 s_iv[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+static const u32 s_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74,
+	0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d,
+	0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e,
+	0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static void sha256_blocks_c(u32 *h, const byte *data, size_t cnt)
+{
+	for (; cnt > 0; cnt--, data += 64) {
+		u32 w[64];
+		for (int i = 0; i < 16; i++) {
+			w[i] = (u32)data[i * 4] << 24 | (u32)data[i * 4 + 1] << 16 | (u32)data[i * 4 + 2] << 8 | (u32)data[i * 4 + 3];
+		}
+
+		for (int i = 16; i < 64; i++) {
+			const u32 s0 = SHA256_ROR(w[i - 15], 7) ^ SHA256_ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			const u32 s1 = SHA256_ROR(w[i - 2], 17) ^ SHA256_ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i]	     = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		u32 a = h[0];
+		u32 b = h[1];
+		u32 c = h[2];
+		u32 d = h[3];
+		u32 e = h[4];
+		u32 f = h[5];
+		u32 g = h[6];
+		u32 k = h[7];
+
+		for (int i = 0; i < 64; i++) {
+			const u32 t1 = k + (SHA256_ROR(e, 6) ^ SHA256_ROR(e, 11) ^ SHA256_ROR(e, 25)) + ((e & f) ^ (~e & g)) + s_k[i] + w[i];
+			const u32 t2 = (SHA256_ROR(a, 2) ^ SHA256_ROR(a, 13) ^ SHA256_ROR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+			k = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+		h[5] += f;
+		h[6] += g;
+		h[7] += k;
+	}
+}
+
+#if defined(SHA256_X86)
+SHA256_TARGET static void sha256_blocks_ni(u32 *h, const byte *data, size_t cnt)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	__m128i tmp    = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&h[0]), 0xB1);
+	__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&h[4]), 0x1B);
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1	       = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	for (; cnt > 0; cnt--, data += 64) {
+		const __m128i abef = state0;
+		const __m128i cdgh = state1;
+
+		__m128i w[4];
+		for (int i = 0; i < 16; i++) {
+			if (i < 4) {
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + i * 16)), mask);
+			} else {
+				const __m128i w7 = _mm_alignr_epi8(w[(i + 3) % 4], w[(i + 2) % 4], 4);
+				w[i % 4]	 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w[i % 4], w[(i + 1) % 4]), w7), w[(i + 3) % 4]);
+			}
+
+			__m128i msg = _mm_add_epi32(w[i % 4], _mm_loadu_si128((const __m128i *)&s_k[i * 4]));
+			state1	    = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg	    = _mm_shuffle_epi32(msg, 0x0E);
+			state0	    = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+	}
+
+	tmp    = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+	_mm_storeu_si128((__m128i *)&h[0], state0);
+	_mm_storeu_si128((__m128i *)&h[4], state1);
+}
+
+static int sha256_has_ni()
+{
+	#if defined(_MSC_VER)
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] < 7) {
+		return 0;
+	}
+
+	__cpuid(regs, 1);
+	const int sse41 = (regs[2] >> 19) & 1;
+
+	__cpuidex(regs, 7, 0);
+	return sse41 && ((regs[1] >> 29) & 1);
+	#else
+	unsigned int a, b, c, d;
+	if (__get_cpuid_max(0, NULL) < 7 || !__get_cpuid(1, &a, &b, &c, &d)) {
+		return 0;
+	}
+
+	const int sse41 = (c >> 19) & 1;
+
+	__cpuid_count(7, 0, a, b, c, d);
+	return sse41 && ((b >> 29) & 1);
+	#endif
+}
+#endif
+
+static once_t s_once		 = ONCE_INIT;
+static sha256_blocks_fn s_blocks = sha256_blocks_c;
+
+static void sha256_detect()
+{
+#if defined(SHA256_X86)
+	if (sha256_has_ni()) {
+		s_blocks = sha256_blocks_ni;
+	}
+#endif
+}
+
+static sha256_blocks_fn sha256_blocks()
+{
+	thread_once(&s_once, sha256_detect);
+	return s_blocks;
+}
+
+static void sha256_blocks_cb(void *h, const byte *data, size_t cnt)
+{
+	sha256_blocks()(h, data, cnt);
+}
+
+sha256_t *sha256_init(sha256_t *ctx)
+{
+	if (ctx == NULL) {
+		return NULL;
+	}
+
+	mem_cpy(ctx->h, sizeof(ctx->h), s_iv, sizeof(s_iv));
+	ctx->len = 0;
+
+	return ctx;
+}
+
+void sha256_update(sha256_t *ctx, const void *data, size_t len)
+{
+	if (ctx == NULL || data == NULL) {
+		return;
+	}
+
+	digest_update(ctx->h, ctx->block, sizeof(ctx->block), &ctx->len, data, len, sha256_blocks_cb);
+}
+
+void sha256_final(sha256_t *ctx, byte *digest)
+{
+	if (ctx == NULL || digest == NULL) {
+		return;
+	}
+
+	const sha256_blocks_fn blocks = sha256_blocks();
+
+	size_t used    = ctx->len % 64;
+	const u64 bits = ctx->len * 8;
+
+	ctx->block[used++] = 0x80;
+	if (used > 56) {
+		mem_set(ctx->block + used, 0, 64 - used);
+		blocks(ctx->h, ctx->block, 1);
+		used = 0;
+	}
+
+	mem_set(ctx->block + used, 0, 56 - used);
+	for (int i = 0; i < 8; i++) {
+		ctx->block[56 + i] = (byte)(bits >> (56 - i * 8));
+	}
+
+	blocks(ctx->h, ctx->block, 1);
+
+	for (int i = 0; i < 32; i++) {
+		digest[i] = (byte)(ctx->h[i / 4] >> (24 - i % 4 * 8));
+	}
+}
+
+static void sha256_update_cb(void *ctx, const void *data, size_t len)
+{
+	sha256_update(ctx, data, len);
+}
+
+int sha256_file(const char *path, byte *digest)
+{
+	if (path == NULL || digest == NULL) {
+		return 1;
+	}
+
+	sha256_t ctx;
+	sha256_init(&ctx);
+
+	if (digest_file(path, &ctx, sha256_update_cb)) {
+		return 1;
+	}
+
+	sha256_final(&ctx, digest);
+	return 0;
+}
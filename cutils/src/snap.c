@@ -0,0 +1,348 @@
+#include "snap.h"
+
+#include "file.h"
+#include "fsink.h"
+#include "log.h"
+#include "mem.h"
+#include "str.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SNAP_MAGIC "SNP2"
+#define SNAP_ORDER 0x01020304
+
+#define SNAP_ALIGN(_off) (((_off) + 7) & ~(u64)7)
+
+typedef struct snap_hdr_s {
+	char magic[4];
+	u32 cnt;
+	u32 order;
+	u16 ptr_size;
+	u16 str_size;
+} snap_hdr_t;
+
+typedef struct snap_ent_s {
+	u64 off;
+	u64 size;
+	u32 cnt;
+	u32 strs_cnt;
+	u64 strs;
+} snap_ent_t;
+
+typedef struct snap_arr_s {
+	const arr_t *arr;
+	size_t strs[SNAP_MAX_STRS];
+	uint strs_cnt;
+} snap_arr_t;
+
+static const snap_ent_t *get_ents(const snap_t *snap)
+{
+	return (const snap_ent_t *)(snap->data + sizeof(snap_hdr_t));
+}
+
+static int ent_valid(const snap_t *snap, const snap_ent_t *ent)
+{
+	if (ent->off > snap->size || ent->strs > snap->size || ent->strs_cnt > SNAP_MAX_STRS) {
+		return 0;
+	}
+
+	if (ent->size > 0 && ent->cnt > (snap->size - ent->off) / ent->size) {
+		return 0;
+	}
+
+	if (ent->strs_cnt * sizeof(u64) > snap->size - ent->strs) {
+		return 0;
+	}
+
+	u64 strs[SNAP_MAX_STRS];
+	mem_cpy(strs, sizeof(strs), snap->data + ent->strs, ent->strs_cnt * sizeof(u64));
+
+	for (uint i = 0; i < ent->strs_cnt; i++) {
+		if (strs[i] + sizeof(str_t) > ent->size) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+snap_t *snap_open(snap_t *snap, const char *path)
+{
+	if (snap == NULL || path == NULL) {
+		return NULL;
+	}
+
+	snap->data = file_map(path, &snap->size);
+	if (snap->data == NULL) {
+		return NULL;
+	}
+
+	snap_hdr_t hdr = { 0 };
+	if (snap->size >= sizeof(hdr)) {
+		mem_cpy(&hdr, sizeof(hdr), snap->data, sizeof(hdr));
+	}
+
+	int valid = mem_cmp(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic)) == 0;
+	if (valid && (hdr.order != SNAP_ORDER || hdr.ptr_size != sizeof(void *) || hdr.str_size != sizeof(str_t))) {
+		log_error("cutils", "snap", NULL, "incompatible byte order or pointer size: %s", path);
+		file_unmap(snap->data, snap->size);
+		snap->data = NULL;
+		return NULL;
+	}
+
+	valid = valid && hdr.cnt <= (snap->size - sizeof(hdr)) / sizeof(snap_ent_t);
+
+	snap->cnt = valid ? hdr.cnt : 0;
+
+	const snap_ent_t *ents = get_ents(snap);
+	for (uint i = 0; valid && i < snap->cnt; i++) {
+		valid = ent_valid(snap, &ents[i]);
+	}
+
+	if (!valid) {
+		log_error("cutils", "snap", NULL, "invalid file: %s", path);
+		file_unmap(snap->data, snap->size);
+		snap->data = NULL;
+		return NULL;
+	}
+
+	return snap;
+}
+
+void snap_close(snap_t *snap)
+{
+	if (snap == NULL || snap->data == NULL) {
+		return;
+	}
+
+	file_unmap(snap->data, snap->size);
+	snap->data = NULL;
+	snap->size = 0;
+	snap->cnt  = 0;
+}
+
+arr_t *snap_get(const snap_t *snap, uint index, arr_t *arr)
+{
+	if (snap == NULL || snap->data == NULL || index >= snap->cnt || arr == NULL) {
+		return NULL;
+	}
+
+	const snap_ent_t *ent = &get_ents(snap)[index];
+
+	arr->data = snap->data + ent->off;
+	arr->cap  = ent->cnt;
+	arr->cnt  = ent->cnt;
+	arr->size = (size_t)ent->size;
+
+	return arr;
+}
+
+str_t snap_str(const snap_t *snap, str_t str)
+{
+	if (snap == NULL || snap->data == NULL || str.data == NULL) {
+		return str_null();
+	}
+
+	const u64 off = (u64)(uintptr_t)str.data;
+	if (off >= snap->size || str.len >= snap->size - off || snap->data[off + str.len] != '\0') {
+		return str_null();
+	}
+
+	return strc((const char *)snap->data + off, str.len);
+}
+
+snap_writer_t *snap_writer_init(snap_writer_t *writer, uint cap)
+{
+	if (writer == NULL) {
+		return NULL;
+	}
+
+	if (arr_init(&writer->arrs, cap, sizeof(snap_arr_t)) == NULL) {
+		log_error("cutils", "snap", NULL, "failed to create writer");
+		return NULL;
+	}
+
+	return writer;
+}
+
+void snap_writer_free(snap_writer_t *writer)
+{
+	if (writer == NULL) {
+		return;
+	}
+
+	arr_free(&writer->arrs);
+}
+
+static uint writer_add(snap_writer_t *writer, const arr_t *arr, size_t off, const size_t *strs, uint strs_cnt)
+{
+	if (writer == NULL || arr == NULL || (strs == NULL && strs_cnt > 0)) {
+		return ARR_END;
+	}
+
+	if (strs_cnt > SNAP_MAX_STRS) {
+		log_error("cutils", "snap", NULL, "too many strings: %u", strs_cnt);
+		return ARR_END;
+	}
+
+	snap_arr_t ent = {
+		.arr	  = arr,
+		.strs_cnt = strs_cnt,
+	};
+
+	for (uint i = 0; i < strs_cnt; i++) {
+		if (off + strs[i] + sizeof(str_t) > arr->size) {
+			log_error("cutils", "snap", NULL, "string offset out of range: %zu", strs[i]);
+			return ARR_END;
+		}
+		ent.strs[i] = off + strs[i];
+	}
+
+	return arr_app(&writer->arrs, &ent);
+}
+
+uint snap_writer_arr(snap_writer_t *writer, const arr_t *arr, const size_t *strs, uint strs_cnt)
+{
+	return writer_add(writer, arr, 0, strs, strs_cnt);
+}
+
+uint snap_writer_list(snap_writer_t *writer, const list_t *list, const size_t *strs, uint strs_cnt)
+{
+	const size_t off = list && list->cnt > 0 ? (size_t)((byte *)list_get_data(list, 0) - (byte *)arr_get(list, 0)) : 0;
+	return writer_add(writer, list, off, strs, strs_cnt);
+}
+
+uint snap_writer_tree(snap_writer_t *writer, const tree_t *tree, const size_t *strs, uint strs_cnt)
+{
+	const size_t off = tree && tree->cnt > 0 ? (size_t)((byte *)tree_get_data(tree, 0) - (byte *)arr_get(tree, 0)) : 0;
+	return writer_add(writer, tree, off, strs, strs_cnt);
+}
+
+static int write_pad(FILE *file, u64 *off)
+{
+	static const byte zero[8] = { 0 };
+
+	const u64 pad = SNAP_ALIGN(*off) - *off;
+	*off += pad;
+
+	return pad > 0 && fwrite(zero, 1, (size_t)pad, file) != pad;
+}
+
+static int write_arrs(const snap_writer_t *writer, FILE *file)
+{
+	const uint cnt = writer->arrs.cnt;
+
+	snap_hdr_t hdr = {
+		.cnt	  = cnt,
+		.order	  = SNAP_ORDER,
+		.ptr_size = sizeof(void *),
+		.str_size = sizeof(str_t),
+	};
+	mem_cpy(hdr.magic, sizeof(hdr.magic), SNAP_MAGIC, sizeof(hdr.magic));
+
+	int ret = fwrite(&hdr, sizeof(hdr), 1, file) != 1;
+
+	u64 off = sizeof(hdr) + (u64)cnt * sizeof(snap_ent_t);
+	for (uint i = 0; i < cnt; i++) {
+		const snap_arr_t *arr = arr_get(&writer->arrs, i);
+
+		snap_ent_t ent = {
+			.size	  = arr->arr->size,
+			.cnt	  = arr->arr->cnt,
+			.strs_cnt = arr->strs_cnt,
+		};
+
+		ent.off	 = SNAP_ALIGN(off);
+		ent.strs = SNAP_ALIGN(ent.off + ent.size * ent.cnt);
+		off	 = ent.strs + ent.strs_cnt * sizeof(u64);
+
+		ret |= fwrite(&ent, sizeof(ent), 1, file) != 1;
+	}
+
+	u64 heap = off;
+	off	 = sizeof(hdr) + (u64)cnt * sizeof(snap_ent_t);
+
+	for (uint i = 0; i < cnt && ret == 0; i++) {
+		const snap_arr_t *arr = arr_get(&writer->arrs, i);
+		const size_t size     = arr->arr->size;
+
+		byte *elem = mem_alloc(size);
+		if (elem == NULL) {
+			log_error("cutils", "snap", NULL, "failed to allocate element");
+			return 1;
+		}
+
+		ret |= write_pad(file, &off);
+
+		for (uint j = 0; j < arr->arr->cnt && ret == 0; j++) {
+			mem_cpy(elem, size, arr_get(arr->arr, j), size);
+			for (uint k = 0; k < arr->strs_cnt; k++) {
+				str_t str;
+				mem_cpy(&str, sizeof(str), elem + arr->strs[k], sizeof(str));
+				if (str.data == NULL) {
+					continue;
+				}
+
+				str.data = (const char *)(uintptr_t)heap;
+				str.size = str.len + 1;
+				str.ref	 = 1;
+
+				heap += str.size;
+				mem_cpy(elem + arr->strs[k], sizeof(str), &str, sizeof(str));
+			}
+
+			ret |= fwrite(elem, 1, size, file) != size;
+		}
+
+		mem_free(elem, size);
+
+		off += (u64)size * arr->arr->cnt;
+		ret |= write_pad(file, &off);
+
+		for (uint k = 0; k < arr->strs_cnt; k++) {
+			const u64 str_off = arr->strs[k];
+			ret |= fwrite(&str_off, sizeof(str_off), 1, file) != 1;
+		}
+		off += arr->strs_cnt * sizeof(u64);
+	}
+
+	for (uint i = 0; i < cnt && ret == 0; i++) {
+		const snap_arr_t *arr = arr_get(&writer->arrs, i);
+		for (uint j = 0; j < arr->arr->cnt; j++) {
+			const byte *elem = arr_get(arr->arr, j);
+			for (uint k = 0; k < arr->strs_cnt; k++) {
+				str_t str;
+				mem_cpy(&str, sizeof(str), elem + arr->strs[k], sizeof(str));
+				if (str.data == NULL) {
+					continue;
+				}
+
+				ret |= fwrite(str.data, 1, str.len, file) != str.len || fputc('\0', file) == EOF;
+			}
+		}
+	}
+
+	return ret;
+}
+
+int snap_writer_save(const snap_writer_t *writer, const char *path)
+{
+	if (writer == NULL || path == NULL) {
+		return 1;
+	}
+
+	fsink_t sink;
+	FILE *file = fsink_open(&sink, path, NULL);
+	if (file == NULL) {
+		return 1;
+	}
+
+	if (write_arrs(writer, file)) {
+		log_error("cutils", "snap", NULL, "failed to write file: %s", path);
+		fsink_abort(&sink);
+		return 1;
+	}
+
+	return fsink_close(&sink);
+}
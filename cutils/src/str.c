@@ -427,17 +427,29 @@ int str_print(str_t str, print_dst_t dst)
 		return 0;
 	}
 
-	int off = dst.off;
+	int off	     = dst.off;
+	size_t start = 0;
 
 	for (size_t i = 0; i < str.len; i++) {
-		const char c = str.data[i];
-		switch (c) {
-		case '\t': dst.off += dprintf(dst, "\\t"); break;
-		case '\n': dst.off += dprintf(dst, "\\n"); break;
-		case '\r': dst.off += dprintf(dst, "\\r"); break;
-		case '\0': dst.off += dprintf(dst, "\\0"); break;
-		default: dst.off += dprintf(dst, "%c", c); break;
+		const char *esc;
+		switch (str.data[i]) {
+		case '\t': esc = "\\t"; break;
+		case '\n': esc = "\\n"; break;
+		case '\r': esc = "\\r"; break;
+		case '\0': esc = "\\0"; break;
+		default: continue;
 		}
+
+		if (i > start) {
+			dst.off += dprintf(dst, "%.*s", (int)(i - start), str.data + start);
+		}
+
+		dst.off += dprintf(dst, "%s", esc);
+		start = i + 1;
+	}
+
+	if (str.len > start) {
+		dst.off += dprintf(dst, "%.*s", (int)(str.len - start), str.data + start);
 	}
 
 	return dst.off - off;
@@ -0,0 +1,207 @@
+#if !defined(_WIN32)
+	#define _GNU_SOURCE
+#endif
+
+#include "thread.h"
+
+#include "log.h"
+
+#if defined(C_WIN)
+#else
+	#include <unistd.h>
+#endif
+
+#if defined(C_WIN)
+static DWORD WINAPI thread_main(LPVOID arg)
+#else
+static void *thread_main(void *arg)
+#endif
+{
+	thread_t *thread = arg;
+	thread->fn(thread->priv);
+
+#if defined(C_WIN)
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
+int thread_create(thread_t *thread, thread_fn fn, void *priv)
+{
+	if (thread == NULL || fn == NULL) {
+		return 1;
+	}
+
+	thread->fn   = fn;
+	thread->priv = priv;
+
+#if defined(C_WIN)
+	thread->handle = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+	if (thread->handle == NULL) {
+#else
+	if (pthread_create(&thread->handle, NULL, thread_main, thread)) {
+#endif
+		log_error("cutils", "thread", NULL, "failed to create thread");
+		return 1;
+	}
+
+	return 0;
+}
+
+int thread_join(thread_t *thread)
+{
+	if (thread == NULL) {
+		return 1;
+	}
+
+#if defined(C_WIN)
+	if (WaitForSingleObject(thread->handle, INFINITE) != WAIT_OBJECT_0) {
+		return 1;
+	}
+	CloseHandle(thread->handle);
+	return 0;
+#else
+	return pthread_join(thread->handle, NULL) ? 1 : 0;
+#endif
+}
+
+uint thread_cpu_cnt()
+{
+#if defined(C_WIN)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (uint)info.dwNumberOfProcessors : 1;
+#else
+	const long cnt = sysconf(_SC_NPROCESSORS_ONLN);
+	return cnt > 0 ? (uint)cnt : 1;
+#endif
+}
+
+mutex_t *mutex_init(mutex_t *mutex)
+{
+	if (mutex == NULL) {
+		return NULL;
+	}
+
+#if defined(C_WIN)
+	InitializeSRWLock(&mutex->lock);
+#else
+	if (pthread_mutex_init(&mutex->lock, NULL)) {
+		log_error("cutils", "thread", NULL, "failed to create mutex");
+		return NULL;
+	}
+#endif
+
+	return mutex;
+}
+
+void mutex_free(mutex_t *mutex)
+{
+	if (mutex == NULL) {
+		return;
+	}
+
+#if defined(C_WIN)
+#else
+	pthread_mutex_destroy(&mutex->lock);
+#endif
+}
+
+void mutex_lock(mutex_t *mutex)
+{
+#if defined(C_WIN)
+	AcquireSRWLockExclusive(&mutex->lock);
+#else
+	pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void mutex_unlock(mutex_t *mutex)
+{
+#if defined(C_WIN)
+	ReleaseSRWLockExclusive(&mutex->lock);
+#else
+	pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+cond_t *cond_init(cond_t *cond)
+{
+	if (cond == NULL) {
+		return NULL;
+	}
+
+#if defined(C_WIN)
+	InitializeConditionVariable(&cond->cond);
+#else
+	if (pthread_cond_init(&cond->cond, NULL)) {
+		log_error("cutils", "thread", NULL, "failed to create condition variable");
+		return NULL;
+	}
+#endif
+
+	return cond;
+}
+
+void cond_free(cond_t *cond)
+{
+	if (cond == NULL) {
+		return;
+	}
+
+#if defined(C_WIN)
+#else
+	pthread_cond_destroy(&cond->cond);
+#endif
+}
+
+void cond_wait(cond_t *cond, mutex_t *mutex)
+{
+#if defined(C_WIN)
+	SleepConditionVariableSRW(&cond->cond, &mutex->lock, INFINITE, 0);
+#else
+	pthread_cond_wait(&cond->cond, &mutex->lock);
+#endif
+}
+
+void cond_signal(cond_t *cond)
+{
+#if defined(C_WIN)
+	WakeConditionVariable(&cond->cond);
+#else
+	pthread_cond_signal(&cond->cond);
+#endif
+}
+
+void cond_broadcast(cond_t *cond)
+{
+#if defined(C_WIN)
+	WakeAllConditionVariable(&cond->cond);
+#else
+	pthread_cond_broadcast(&cond->cond);
+#endif
+}
+
+#if defined(C_WIN)
+static BOOL CALLBACK once_main(PINIT_ONCE once, PVOID param, PVOID *ctx)
+{
+	(void)once;
+	(void)ctx;
+	(*(once_fn *)param)();
+	return TRUE;
+}
+#endif
+
+void thread_once(once_t *once, once_fn fn)
+{
+	if (once == NULL || fn == NULL) {
+		return;
+	}
+
+#if defined(C_WIN)
+	InitOnceExecuteOnce(&once->once, once_main, &fn, NULL);
+#else
+	pthread_once(&once->once, fn);
+#endif
+}
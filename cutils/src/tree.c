@@ -175,17 +175,28 @@ int tree_print(const tree_t *tree, tnode_t node, tree_print_cb cb, print_dst_t d
 		return 0;
 	}
 
+	char prefix[TREE_MAX_DEPTH * 6];
+
 	int off = dst.off;
 	tnode_t cur;
 	int depth;
 	tree_foreach(tree, node, cur, depth)
 	{
+		size_t len = 0;
 		for (int i = 0; i < depth - 1; i++) {
-			dst.off += dprintf(dst, tree_get_next(tree, _it.stack[i + 1]) < tree->cnt ? "│ " : "  ");
+			const int next = tree_get_next(tree, _it.stack[i + 1]) < tree->cnt;
+			mem_cpy(prefix + len, sizeof(prefix) - len, next ? "│ " : "  ", next ? 4 : 2);
+			len += next ? 4 : 2;
 		}
 
 		if (depth > 0) {
-			dst.off += dprintf(dst, tree_get_next(tree, _it.stack[depth]) < tree->cnt ? "├─" : "└─");
+			const int next = tree_get_next(tree, _it.stack[depth]) < tree->cnt;
+			mem_cpy(prefix + len, sizeof(prefix) - len, next ? "├─" : "└─", 6);
+			len += 6;
+		}
+
+		if (len > 0) {
+			dst.off += dprintf(dst, "%.*s", (int)len, prefix);
 		}
 
 		dst.off += cb(tree_get_data(tree, cur), dst, priv);
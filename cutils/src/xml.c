@@ -1,7 +1,21 @@
 #include "xml.h"
 
+#include "arr.h"
+#include "cstr.h"
+#include "dbuf.h"
+#include "log.h"
 #include "mem.h"
-#include "print.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define XML_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
 
 typedef struct xml_tag_data_s {
 	str_t name;
@@ -94,6 +108,48 @@ xml_tag_t xml_add_tag(xml_t *xml, xml_tag_t tag, str_t name)
 	return xml_add_tag_val(xml, tag, name, str_null());
 }
 
+xml_tag_t xml_add_tag_next(xml_t *xml, xml_tag_t tag, xml_tag_t last, str_t name, str_t val)
+{
+	if (xml == NULL) {
+		return XML_END;
+	}
+
+	if (last == XML_END) {
+		return xml_add_tag_val(xml, tag, name, val);
+	}
+
+	const xml_tag_t next = tree_add_next(&xml->tags, last);
+	xml_tag_data_t *data = get_tag(&xml->tags, next);
+	if (data == NULL) {
+		return XML_END;
+	}
+
+	*data = (xml_tag_data_t){
+		.name  = name,
+		.attrs = LIST_END,
+		.val   = val,
+	};
+
+	return next;
+}
+
+int xml_set_val(xml_t *xml, xml_tag_t tag, str_t val)
+{
+	if (xml == NULL) {
+		return 1;
+	}
+
+	xml_tag_data_t *data = get_tag(&xml->tags, tag);
+	if (data == NULL) {
+		return 1;
+	}
+
+	str_free(&data->val);
+	data->val = val;
+
+	return 0;
+}
+
 int xml_remove_tag(xml_t *xml, xml_tag_t tag)
 {
 	if (xml == NULL) {
@@ -146,56 +202,365 @@ xml_attr_t xml_add_attr(xml_t *xml, xml_tag_t tag, str_t name, str_t val)
 	return attr;
 }
 
-static int xml_tag_print(const xml_t *xml, xml_tag_t tag, print_dst_t dst, uint depth)
+typedef struct xml_lvl_s {
+	xml_tag_t tag;
+	xml_tag_t next;
+} xml_lvl_t;
+
+static const char s_pad[] = "                                                                ";
+
+static inline uint xml_ctz(uint val)
 {
-	if (xml == NULL) {
-		return 0;
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward(&idx, val);
+	return (uint)idx;
+#else
+	return (uint)__builtin_ctz(val);
+#endif
+}
+
+static inline void xml_put(dbuf_t *buf, const char *data, size_t len)
+{
+	if (buf->size - buf->len < len && dbuf_reserve(buf, len)) {
+		return;
 	}
 
-	const xml_tag_data_t *data = get_tag(&xml->tags, tag);
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+}
 
-	if (data == NULL) {
-		return 0;
+static void xml_pad(dbuf_t *buf, uint depth)
+{
+	size_t len = (size_t)depth * 2;
+	while (len > 0) {
+		const size_t cnt = len < sizeof(s_pad) - 1 ? len : sizeof(s_pad) - 1;
+		xml_put(buf, s_pad, cnt);
+		len -= cnt;
+	}
+}
+
+static size_t xml_esc_clean(const char *data, size_t len, int attr)
+{
+	size_t i = 0;
+
+#if defined(XML_SSE2)
+	const __m128i amp  = _mm_set1_epi8('&');
+	const __m128i lt   = _mm_set1_epi8('<');
+	const __m128i gt   = _mm_set1_epi8('>');
+	const __m128i quot = _mm_set1_epi8(attr ? '"' : '&');
+
+	for (; i + 16 <= len; i += 16) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+		const __m128i tag   = _mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, gt));
+		const __m128i esc   = _mm_or_si128(tag, _mm_or_si128(_mm_cmpeq_epi8(chunk, amp), _mm_cmpeq_epi8(chunk, quot)));
+
+		const uint mask = (uint)_mm_movemask_epi8(esc);
+		if (mask) {
+			return i + xml_ctz(mask);
+		}
+	}
+#endif
+
+	for (; i < len; i++) {
+		const char c = data[i];
+		if (c == '&' || c == '<' || c == '>' || (attr && c == '"')) {
+			return i;
+		}
 	}
 
-	int off = dst.off;
-	dst.off += dprintf(dst, "%*s<%.*s", depth * 2, "", data->name.len, data->name.data);
+	return len;
+}
+
+static void xml_esc_print(dbuf_t *buf, const char *data, size_t len, int attr)
+{
+	for (;;) {
+		const size_t clean = xml_esc_clean(data, len, attr);
+		xml_put(buf, data, clean);
+
+		if (clean == len) {
+			break;
+		}
+
+		switch (data[clean]) {
+		case '&': xml_put(buf, CSTR("&amp;")); break;
+		case '<': xml_put(buf, CSTR("&lt;")); break;
+		case '>': xml_put(buf, CSTR("&gt;")); break;
+		default: xml_put(buf, CSTR("&quot;")); break;
+		}
+
+		data += clean + 1;
+		len -= clean + 1;
+	}
+}
+
+static void xml_close_print(dbuf_t *buf, const xml_tag_data_t *data)
+{
+	xml_put(buf, CSTR("</"));
+	xml_put(buf, data->name.data, data->name.len);
+	xml_put(buf, CSTR(">\n"));
+}
+
+static xml_tag_t xml_tag_print(const xml_t *xml, xml_tag_t tag, dbuf_t *buf, uint depth)
+{
+	const xml_tag_data_t *data = get_tag(&xml->tags, tag);
+
+	xml_pad(buf, depth);
+	xml_put(buf, CSTR("<"));
+	xml_put(buf, data->name.data, data->name.len);
 
 	if (data->attrs != LIST_END) {
 		xml_attr_data_t *attr;
 		list_foreach(&xml->attrs, data->attrs, attr)
 		{
-			dst.off += dprintf(dst, " %.*s=\"%.*s\"", attr->name.len, attr->name.data, attr->val.len, attr->val.data);
+			xml_put(buf, CSTR(" "));
+			xml_put(buf, attr->name.data, attr->name.len);
+			xml_put(buf, CSTR("=\""));
+			xml_esc_print(buf, attr->val.data, attr->val.len, 1);
+			xml_put(buf, CSTR("\""));
 		}
 	}
 
-	if (tree_get_child(&xml->tags, tag) != TREE_END) {
-		dst.off += dprintf(dst, ">\n");
-
-		xml_tag_t child;
-		tree_foreach_child(&xml->tags, tag, child)
-		{
-			dst.off += xml_tag_print(xml, child, dst, depth + 1);
-		}
+	const xml_tag_t child = tree_get_child(&xml->tags, tag);
+	if (child != TREE_END) {
+		xml_put(buf, CSTR(">\n"));
+		return child;
+	}
 
-		dst.off += dprintf(dst, "%*s</%.*s>\n", depth * 2, "", data->name.len, data->name.data);
-	} else if (data->val.data) {
+	if (data->val.data) {
+		xml_put(buf, CSTR(">"));
+		xml_esc_print(buf, data->val.data, data->val.len, 0);
 		if (data->val.len > 0 && data->val.data[data->val.len - 1] == '\n') {
-			dst.off += dprintf(dst, ">%.*s%*s</%.*s>\n", data->val.len, data->val.data, depth * 2, "", data->name.len, data->name.data);
-		} else {
-			dst.off += dprintf(dst, ">%.*s</%.*s>\n", data->val.len, data->val.data, data->name.len, data->name.data);
+			xml_pad(buf, depth);
 		}
+		xml_close_print(buf, data);
 	} else {
-		dst.off += dprintf(dst, " />\n");
+		xml_put(buf, CSTR(" />\n"));
 	}
 
-	return dst.off - off;
+	return TREE_END;
 }
 
 int xml_print(const xml_t *xml, xml_tag_t tag, print_dst_t dst)
 {
-	int off = dst.off;
-	dst.off += dprintf(dst, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
-	dst.off += xml_tag_print(xml, tag, dst, 0);
-	return dst.off - off;
+	char data[DBUF_STACK_SIZE];
+	dbuf_t buf;
+	if (dbuf_init_ext(&buf, data, sizeof(data), dst) == NULL) {
+		return 0;
+	}
+
+	arr_t stack;
+	if (arr_init(&stack, 16, sizeof(xml_lvl_t)) == NULL) {
+		dbuf_free(&buf);
+		return 0;
+	}
+
+	xml_put(&buf, CSTR("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"));
+
+	xml_tag_t node = xml != NULL && get_tag(&xml->tags, tag) != NULL ? tag : TREE_END;
+	while (node != TREE_END) {
+		const xml_tag_t child = xml_tag_print(xml, node, &buf, stack.cnt);
+		if (child != TREE_END) {
+			xml_lvl_t *lvl = arr_get(&stack, arr_add(&stack));
+			if (lvl == NULL) {
+				break;
+			}
+
+			lvl->tag  = node;
+			lvl->next = stack.cnt > 1 ? tree_get_next(&xml->tags, node) : TREE_END;
+			node	  = child;
+		} else {
+			node = stack.cnt > 0 ? tree_get_next(&xml->tags, node) : TREE_END;
+		}
+
+		while (node >= xml->tags.cnt && stack.cnt > 0) {
+			const xml_lvl_t *lvl = arr_get(&stack, stack.cnt - 1);
+			xml_pad(&buf, stack.cnt - 1);
+			xml_close_print(&buf, get_tag(&xml->tags, lvl->tag));
+			node = lvl->next;
+			stack.cnt--;
+		}
+
+		if (node >= xml->tags.cnt) {
+			node = TREE_END;
+		}
+	}
+
+	dbuf_flush(&buf);
+
+	const int off = buf.dst.off - dst.off;
+	arr_free(&stack);
+	dbuf_free(&buf);
+	return off;
+}
+
+xml_writer_t *xml_writer_init(xml_writer_t *writer, print_dst_t dst)
+{
+	if (writer == NULL) {
+		return NULL;
+	}
+
+	if (dbuf_init_dst(&writer->buf, DBUF_SIZE, dst) == NULL) {
+		return NULL;
+	}
+
+	if (dbuf_init(&writer->names, 256) == NULL) {
+		dbuf_free(&writer->buf);
+		return NULL;
+	}
+
+	if (arr_init(&writer->stack, 16, sizeof(size_t)) == NULL) {
+		dbuf_free(&writer->names);
+		dbuf_free(&writer->buf);
+		return NULL;
+	}
+
+	writer->start = 0;
+	writer->text  = 0;
+	writer->nl    = 0;
+	writer->done  = 0;
+
+	xml_put(&writer->buf, CSTR("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"));
+
+	return writer;
+}
+
+int xml_writer_close(xml_writer_t *writer)
+{
+	if (writer == NULL) {
+		return 1;
+	}
+
+	int ret = 0;
+	if (writer->stack.cnt > 0 || !writer->done) {
+		log_error("cutils", "xml", NULL, "incomplete document");
+		ret = 1;
+	}
+
+	dbuf_flush(&writer->buf);
+	arr_free(&writer->stack);
+	dbuf_free(&writer->names);
+	dbuf_free(&writer->buf);
+
+	return ret;
+}
+
+int xml_write_open(xml_writer_t *writer, const char *name, size_t len)
+{
+	if (writer == NULL || name == NULL || len == 0) {
+		return 1;
+	}
+
+	if (writer->done || writer->text) {
+		log_error("cutils", "xml", NULL, "%s", writer->done ? "document already complete" : "tag after text");
+		return 1;
+	}
+
+	size_t *off = arr_get(&writer->stack, arr_add(&writer->stack));
+	if (off == NULL) {
+		return 1;
+	}
+
+	*off = writer->names.len;
+	if (dbuf_cat(&writer->names, name, len) == 0) {
+		writer->stack.cnt--;
+		return 1;
+	}
+
+	if (writer->start) {
+		xml_put(&writer->buf, CSTR(">\n"));
+	}
+
+	xml_pad(&writer->buf, writer->stack.cnt - 1);
+	xml_put(&writer->buf, CSTR("<"));
+	xml_put(&writer->buf, name, len);
+
+	writer->start = 1;
+
+	return 0;
+}
+
+int xml_write_attr(xml_writer_t *writer, const char *name, size_t name_len, const char *val, size_t val_len)
+{
+	if (writer == NULL || name == NULL || name_len == 0 || (val == NULL && val_len > 0)) {
+		return 1;
+	}
+
+	if (!writer->start) {
+		log_error("cutils", "xml", NULL, "attribute outside of start tag");
+		return 1;
+	}
+
+	xml_put(&writer->buf, CSTR(" "));
+	xml_put(&writer->buf, name, name_len);
+	xml_put(&writer->buf, CSTR("=\""));
+	if (val_len > 0) {
+		xml_esc_print(&writer->buf, val, val_len, 1);
+	}
+	xml_put(&writer->buf, CSTR("\""));
+
+	return 0;
+}
+
+int xml_write_text(xml_writer_t *writer, const char *val, size_t len)
+{
+	if (writer == NULL || (val == NULL && len > 0)) {
+		return 1;
+	}
+
+	if (writer->stack.cnt == 0 || (!writer->start && !writer->text)) {
+		log_error("cutils", "xml", NULL, "%s", writer->stack.cnt == 0 ? "text outside of tag" : "text after tag");
+		return 1;
+	}
+
+	if (writer->start) {
+		xml_put(&writer->buf, CSTR(">"));
+		writer->start = 0;
+		writer->text  = 1;
+		writer->nl    = 0;
+	}
+
+	if (len > 0) {
+		xml_esc_print(&writer->buf, val, len, 0);
+		writer->nl = val[len - 1] == '\n';
+	}
+
+	return 0;
+}
+
+int xml_write_end(xml_writer_t *writer)
+{
+	if (writer == NULL) {
+		return 1;
+	}
+
+	if (writer->stack.cnt == 0) {
+		log_error("cutils", "xml", NULL, "no open tag");
+		return 1;
+	}
+
+	const size_t off = *(size_t *)arr_get(&writer->stack, writer->stack.cnt - 1);
+	writer->stack.cnt--;
+
+	if (writer->start) {
+		xml_put(&writer->buf, CSTR(" />\n"));
+	} else {
+		if (!writer->text || writer->nl) {
+			xml_pad(&writer->buf, writer->stack.cnt);
+		}
+		xml_put(&writer->buf, CSTR("</"));
+		xml_put(&writer->buf, writer->names.data + off, writer->names.len - off);
+		xml_put(&writer->buf, CSTR(">\n"));
+	}
+
+	writer->names.len = off;
+	writer->start	  = 0;
+	writer->text	  = 0;
+	writer->nl	  = 0;
+
+	if (writer->stack.cnt == 0) {
+		writer->done = 1;
+	}
+
+	return 0;
 }
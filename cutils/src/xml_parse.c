@@ -0,0 +1,680 @@
+#include "xml_parse.h"
+
+#include "arr.h"
+#include "log.h"
+#include "mem.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define XML_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+typedef struct xml_prs_s {
+	const char *data;
+	size_t len;
+	xml_parse_cb cb;
+	void *priv;
+	arr_t names;
+	char *buf;
+	size_t buf_size;
+	bool scratch;
+	bool leaf;
+} xml_prs_t;
+
+typedef struct xml_lvl_s {
+	xml_tag_t tag;
+	xml_tag_t last;
+	str_t text;
+} xml_lvl_t;
+
+typedef struct xml_bld_s {
+	xml_t *xml;
+	const xml_prs_t *prs;
+	arr_t stack;
+	xml_tag_t root;
+} xml_bld_t;
+
+static inline uint xml_ctz(uint val)
+{
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward(&idx, val);
+	return (uint)idx;
+#else
+	return (uint)__builtin_ctz(val);
+#endif
+}
+
+static size_t scan2(const char *data, size_t pos, size_t len, char a, char b)
+{
+#if defined(XML_SSE2)
+	const __m128i va = _mm_set1_epi8(a);
+	const __m128i vb = _mm_set1_epi8(b);
+
+	for (; pos + 16 <= len; pos += 16) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + pos));
+		const uint mask	    = (uint)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+		if (mask) {
+			return pos + xml_ctz(mask);
+		}
+	}
+#endif
+
+	for (; pos < len; pos++) {
+		if (data[pos] == a || data[pos] == b) {
+			return pos;
+		}
+	}
+
+	return len;
+}
+
+static size_t find(const char *data, size_t pos, size_t len, const char *str, size_t str_len)
+{
+	while (pos + str_len <= len) {
+		const char *c = memchr(data + pos, str[0], len - pos - str_len + 1);
+		if (c == NULL) {
+			break;
+		}
+
+		pos = (size_t)(c - data);
+		if (mem_cmp(c, str, str_len) == 0) {
+			return pos;
+		}
+		pos++;
+	}
+
+	return len;
+}
+
+static inline int is_ws(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline int is_name_end(char c)
+{
+	return is_ws(c) || c == '/' || c == '>' || c == '=' || c == '<';
+}
+
+static int prs_error(const xml_prs_t *prs, size_t at, const char *msg)
+{
+	uint line = 1;
+	uint col  = 1;
+	for (size_t i = 0; i < at && i < prs->len; i++) {
+		if (prs->data[i] == '\n') {
+			line++;
+			col = 1;
+		} else {
+			col++;
+		}
+	}
+
+	log_error("cutils", "xml", NULL, "%d:%d: %s", line, col, msg);
+	return 1;
+}
+
+static size_t skip_ws(const xml_prs_t *prs, size_t pos)
+{
+	while (pos < prs->len && is_ws(prs->data[pos])) {
+		pos++;
+	}
+
+	return pos;
+}
+
+static size_t parse_name(const xml_prs_t *prs, size_t pos, str_t *name)
+{
+	size_t end = pos;
+	while (end < prs->len && !is_name_end(prs->data[end])) {
+		end++;
+	}
+
+	*name = strc(prs->data + pos, end - pos);
+	return end;
+}
+
+static size_t utf8_enc(char *out, uint cp)
+{
+	if (cp < 0x80) {
+		out[0] = (char)cp;
+		return 1;
+	}
+
+	if (cp < 0x800) {
+		out[0] = (char)(0xc0 | (cp >> 6));
+		out[1] = (char)(0x80 | (cp & 0x3f));
+		return 2;
+	}
+
+	if (cp < 0x10000) {
+		out[0] = (char)(0xe0 | (cp >> 12));
+		out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+		out[2] = (char)(0x80 | (cp & 0x3f));
+		return 3;
+	}
+
+	out[0] = (char)(0xf0 | (cp >> 18));
+	out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+	out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+	out[3] = (char)(0x80 | (cp & 0x3f));
+	return 4;
+}
+
+static int char_ref(const char *ent, size_t len, uint *cp)
+{
+	const int hex = len > 1 && (ent[0] == 'x' || ent[0] == 'X');
+
+	*cp = 0;
+	for (size_t i = hex; i < len; i++) {
+		const char c = ent[i];
+
+		uint digit;
+		if (c >= '0' && c <= '9') {
+			digit = (uint)(c - '0');
+		} else if (hex && c >= 'a' && c <= 'f') {
+			digit = (uint)(c - 'a' + 10);
+		} else if (hex && c >= 'A' && c <= 'F') {
+			digit = (uint)(c - 'A' + 10);
+		} else {
+			return 1;
+		}
+
+		*cp = *cp * (hex ? 16 : 10) + digit;
+		if (*cp > 0x10ffff) {
+			return 1;
+		}
+	}
+
+	return len == (size_t)hex || *cp == 0 || (*cp >= 0xd800 && *cp <= 0xdfff);
+}
+
+static size_t decode_ent(const char *src, size_t len, char *out)
+{
+	const char *semi = memchr(src, ';', len < 12 ? len : 12);
+	if (semi == NULL) {
+		return 0;
+	}
+
+	const char *ent	     = src + 1;
+	const size_t ent_len = (size_t)(semi - ent);
+
+	char c = '\0';
+	if (ent_len == 2 && mem_cmp(ent, "lt", 2) == 0) {
+		c = '<';
+	} else if (ent_len == 2 && mem_cmp(ent, "gt", 2) == 0) {
+		c = '>';
+	} else if (ent_len == 3 && mem_cmp(ent, "amp", 3) == 0) {
+		c = '&';
+	} else if (ent_len == 4 && mem_cmp(ent, "quot", 4) == 0) {
+		c = '"';
+	} else if (ent_len == 4 && mem_cmp(ent, "apos", 4) == 0) {
+		c = '\'';
+	}
+
+	if (c != '\0') {
+		*out = c;
+		return 1;
+	}
+
+	uint cp;
+	if (ent_len < 2 || ent[0] != '#' || char_ref(ent + 1, ent_len - 1, &cp)) {
+		return 0;
+	}
+
+	return utf8_enc(out, cp);
+}
+
+static size_t decode(const char *src, size_t len, char *out)
+{
+	size_t n = 0;
+	for (size_t i = 0; i < len;) {
+		const char *amp	 = memchr(src + i, '&', len - i);
+		const size_t cnt = amp ? (size_t)(amp - src) - i : len - i;
+
+		memcpy(out + n, src + i, cnt);
+		n += cnt;
+		i += cnt;
+
+		if (i >= len) {
+			break;
+		}
+
+		const size_t dec = decode_ent(src + i, len - i, out + n);
+		if (dec == 0) {
+			out[n++] = src[i++];
+			continue;
+		}
+
+		n += dec;
+		i += (size_t)((const char *)memchr(src + i, ';', len - i) - (src + i)) + 1;
+	}
+
+	return n;
+}
+
+static int prs_val(xml_prs_t *prs, size_t start, size_t end, int amp, str_t *val)
+{
+	const size_t len = end - start;
+	prs->scratch	 = amp;
+	if (!amp) {
+		*val = strc(prs->data + start, len);
+		return 0;
+	}
+
+	if (len > prs->buf_size) {
+		char *buf = prs->buf ? mem_realloc(prs->buf, len, prs->buf_size) : mem_alloc(len);
+		if (buf == NULL) {
+			log_error("cutils", "xml", NULL, "failed to allocate decode buffer");
+			return 1;
+		}
+
+		prs->buf      = buf;
+		prs->buf_size = len;
+	}
+
+	*val = strc(prs->buf, decode(prs->data + start, len, prs->buf));
+	return 0;
+}
+
+static int prs_text(xml_prs_t *prs, size_t start, size_t end, int amp, int close)
+{
+	size_t i = start;
+	while (i < end && is_ws(prs->data[i])) {
+		i++;
+	}
+
+	if (i == end && !(prs->leaf && close)) {
+		return 0;
+	}
+
+	if (prs->names.cnt == 0) {
+		return prs_error(prs, i, "text outside of root element");
+	}
+
+	str_t val;
+	if (prs_val(prs, start, end, amp, &val)) {
+		return 1;
+	}
+
+	prs->leaf = 0;
+	return prs->cb(XML_EVT_TEXT, str_null(), val, prs->priv);
+}
+
+static int prs_close(xml_prs_t *prs, size_t pos, size_t *next)
+{
+	str_t name;
+	pos = skip_ws(prs, parse_name(prs, pos + 2, &name));
+	if (pos >= prs->len || prs->data[pos] != '>') {
+		return prs_error(prs, pos, "expected '>'");
+	}
+
+	const str_t *open = prs->names.cnt > 0 ? arr_get(&prs->names, prs->names.cnt - 1) : NULL;
+	if (open == NULL || open->len != name.len || mem_cmp(open->data, name.data, name.len) != 0) {
+		return prs_error(prs, pos, "mismatched closing tag");
+	}
+
+	prs->names.cnt--;
+	*next = pos + 1;
+
+	return prs->cb(XML_EVT_CLOSE, name, str_null(), prs->priv);
+}
+
+static int prs_attr(xml_prs_t *prs, size_t pos, size_t *next)
+{
+	str_t name;
+	pos = parse_name(prs, pos, &name);
+	if (name.len == 0) {
+		return prs_error(prs, pos, "expected attribute name");
+	}
+
+	pos = skip_ws(prs, pos);
+	if (pos >= prs->len || prs->data[pos] != '=') {
+		return prs_error(prs, pos, "expected '='");
+	}
+
+	pos = skip_ws(prs, pos + 1);
+	if (pos >= prs->len || (prs->data[pos] != '"' && prs->data[pos] != '\'')) {
+		return prs_error(prs, pos, "expected quoted attribute value");
+	}
+
+	const char quote   = prs->data[pos];
+	const size_t start = pos + 1;
+
+	size_t end    = scan2(prs->data, start, prs->len, quote, '&');
+	const int amp = end < prs->len && prs->data[end] == '&';
+	if (amp) {
+		const char *c = memchr(prs->data + end, quote, prs->len - end);
+		end	      = c ? (size_t)(c - prs->data) : prs->len;
+	}
+
+	if (end >= prs->len) {
+		return prs_error(prs, pos, "unterminated attribute value");
+	}
+
+	str_t val;
+	if (prs_val(prs, start, end, amp, &val)) {
+		return 1;
+	}
+
+	*next = end + 1;
+	return prs->cb(XML_EVT_ATTR, name, val, prs->priv);
+}
+
+static int prs_open(xml_prs_t *prs, size_t pos, size_t *next)
+{
+	str_t name;
+	pos = parse_name(prs, pos + 1, &name);
+	if (name.len == 0) {
+		return prs_error(prs, pos, "expected tag name");
+	}
+
+	str_t *open = arr_get(&prs->names, arr_add(&prs->names));
+	if (open == NULL) {
+		return 1;
+	}
+
+	*open = name;
+	if (prs->cb(XML_EVT_OPEN, name, str_null(), prs->priv)) {
+		return 1;
+	}
+
+	for (;;) {
+		const size_t ws = pos;
+
+		pos = skip_ws(prs, pos);
+		if (pos >= prs->len) {
+			return prs_error(prs, pos, "unterminated tag");
+		}
+
+		if (prs->data[pos] == '>') {
+			*next	  = pos + 1;
+			prs->leaf = 1;
+			return 0;
+		}
+
+		if (prs->data[pos] == '/') {
+			if (pos + 1 >= prs->len || prs->data[pos + 1] != '>') {
+				return prs_error(prs, pos, "expected '>'");
+			}
+
+			prs->names.cnt--;
+			*next	  = pos + 2;
+			prs->leaf = 0;
+			return prs->cb(XML_EVT_CLOSE, name, str_null(), prs->priv);
+		}
+
+		if (pos == ws) {
+			return prs_error(prs, pos, "expected whitespace");
+		}
+
+		if (prs_attr(prs, pos, &pos)) {
+			return 1;
+		}
+	}
+}
+
+static int prs_markup(xml_prs_t *prs, size_t pos, size_t *next)
+{
+	const char *data = prs->data;
+	const size_t len = prs->len;
+
+	if (data[pos + 1] == '?') {
+		const size_t end = find(data, pos + 2, len, "?>", 2);
+		if (end >= len) {
+			return prs_error(prs, pos, "unterminated processing instruction");
+		}
+
+		*next = end + 2;
+		return 0;
+	}
+
+	if (len - pos >= 4 && mem_cmp(data + pos, "<!--", 4) == 0) {
+		const size_t end = find(data, pos + 4, len, "-->", 3);
+		if (end >= len) {
+			return prs_error(prs, pos, "unterminated comment");
+		}
+
+		*next = end + 3;
+		return 0;
+	}
+
+	if (len - pos >= 9 && mem_cmp(data + pos, "<![CDATA[", 9) == 0) {
+		const size_t end = find(data, pos + 9, len, "]]>", 3);
+		if (end >= len) {
+			return prs_error(prs, pos, "unterminated CDATA section");
+		}
+
+		if (prs->names.cnt == 0) {
+			return prs_error(prs, pos, "CDATA outside of root element");
+		}
+
+		*next	     = end + 3;
+		prs->scratch = 0;
+		prs->leaf    = 0;
+		return prs->cb(XML_EVT_TEXT, str_null(), strc(data + pos + 9, end - pos - 9), prs->priv);
+	}
+
+	if (prs->names.cnt > 0) {
+		return prs_error(prs, pos, "unexpected declaration");
+	}
+
+	uint depth = 0;
+	for (size_t i = pos + 2; i < len; i++) {
+		switch (data[i]) {
+		case '[': depth++; break;
+		case ']': depth -= depth > 0; break;
+		case '>':
+			if (depth == 0) {
+				*next = i + 1;
+				return 0;
+			}
+			break;
+		default: break;
+		}
+	}
+
+	return prs_error(prs, pos, "unterminated declaration");
+}
+
+static int prs_doc(xml_prs_t *prs)
+{
+	const char *data = prs->data;
+	const size_t len = prs->len;
+
+	size_t pos = len >= 3 && mem_cmp(data, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+	int root   = 0;
+
+	while (pos < len) {
+		size_t lt     = scan2(data, pos, len, '<', '&');
+		const int amp = lt < len && data[lt] == '&';
+		if (amp) {
+			const char *c = memchr(data + lt, '<', len - lt);
+			lt	      = c ? (size_t)(c - data) : len;
+		}
+
+		const int close = lt + 1 < len && data[lt + 1] == '/';
+		if ((lt > pos || (prs->leaf && close)) && prs_text(prs, pos, lt, amp, close)) {
+			return 1;
+		}
+
+		if (lt >= len) {
+			break;
+		}
+
+		if (lt + 1 >= len) {
+			return prs_error(prs, lt, "unexpected end of input");
+		}
+
+		if (close) {
+			prs->leaf = 0;
+			if (prs_close(prs, lt, &pos)) {
+				return 1;
+			}
+		} else if (data[lt + 1] == '?' || data[lt + 1] == '!') {
+			if (prs_markup(prs, lt, &pos)) {
+				return 1;
+			}
+		} else {
+			if (prs->names.cnt == 0 && root) {
+				return prs_error(prs, lt, "multiple root elements");
+			}
+
+			root = 1;
+			if (prs_open(prs, lt, &pos)) {
+				return 1;
+			}
+		}
+	}
+
+	if (prs->names.cnt > 0) {
+		return prs_error(prs, len, "unclosed tag");
+	}
+
+	if (!root) {
+		return prs_error(prs, len, "missing root element");
+	}
+
+	return 0;
+}
+
+static int prs_run(xml_prs_t *prs)
+{
+	if (arr_init(&prs->names, 16, sizeof(str_t)) == NULL) {
+		return 1;
+	}
+
+	const int ret = prs_doc(prs);
+
+	arr_free(&prs->names);
+	mem_free(prs->buf, prs->buf_size);
+
+	return ret;
+}
+
+int xml_parse_stream(const char *data, size_t len, xml_parse_cb cb, void *priv)
+{
+	if (data == NULL || cb == NULL) {
+		return 1;
+	}
+
+	xml_prs_t prs = {
+		.data = data,
+		.len  = len,
+		.cb   = cb,
+		.priv = priv,
+	};
+
+	return prs_run(&prs);
+}
+
+static str_t bld_str(const xml_bld_t *bld, str_t str)
+{
+	if (!bld->prs->scratch) {
+		return str;
+	}
+
+	return strn(str.data, str.len, str.len + 1);
+}
+
+static int bld_cb(xml_evt_t evt, str_t name, str_t val, void *priv)
+{
+	xml_bld_t *bld = priv;
+	xml_lvl_t *top = bld->stack.cnt > 0 ? arr_get(&bld->stack, bld->stack.cnt - 1) : NULL;
+
+	switch (evt) {
+	case XML_EVT_OPEN: {
+		const xml_tag_t tag = xml_add_tag_next(bld->xml, top ? top->tag : XML_END, top ? top->last : XML_END, name, str_null());
+		if (tag == XML_END) {
+			return 1;
+		}
+
+		if (top) {
+			top->last = tag;
+		} else {
+			bld->root = tag;
+		}
+
+		xml_lvl_t *lvl = arr_get(&bld->stack, arr_add(&bld->stack));
+		if (lvl == NULL) {
+			return 1;
+		}
+
+		*lvl = (xml_lvl_t){
+			.tag  = tag,
+			.last = XML_END,
+			.text = str_null(),
+		};
+		return 0;
+	}
+	case XML_EVT_ATTR: {
+		str_t str = bld_str(bld, val);
+		if (xml_add_attr(bld->xml, top->tag, name, str) == LIST_END) {
+			str_free(&str);
+			return 1;
+		}
+		return 0;
+	}
+	case XML_EVT_TEXT:
+		if (top->text.data == NULL) {
+			top->text = bld_str(bld, val);
+			return top->text.data == NULL;
+		}
+
+		if (top->text.ref) {
+			top->text = strn(top->text.data, top->text.len, top->text.len + val.len + 1);
+		}
+		return str_cat(&top->text, val) == NULL;
+	case XML_EVT_CLOSE:
+		bld->stack.cnt--;
+		if (top->text.data && xml_set_val(bld->xml, top->tag, top->text)) {
+			str_free(&top->text);
+			return 1;
+		}
+		return 0;
+	default: return 1;
+	}
+}
+
+xml_tag_t xml_parse(xml_t *xml, const char *data, size_t len)
+{
+	if (xml == NULL || data == NULL) {
+		return XML_END;
+	}
+
+	xml_bld_t bld = {
+		.xml  = xml,
+		.root = XML_END,
+	};
+
+	xml_prs_t prs = {
+		.data = data,
+		.len  = len,
+		.cb   = bld_cb,
+		.priv = &bld,
+	};
+
+	bld.prs = &prs;
+
+	if (arr_init(&bld.stack, 16, sizeof(xml_lvl_t)) == NULL) {
+		return XML_END;
+	}
+
+	const int ret = prs_run(&prs);
+
+	xml_lvl_t *lvl;
+	arr_foreach(&bld.stack, lvl)
+	{
+		str_free(&lvl->text);
+	}
+
+	arr_free(&bld.stack);
+
+	return ret ? XML_END : bld.root;
+}
@@ -1,5 +1,7 @@
 #include "ini.h"
 
+#include "cstr.h"
+#include "dbuf.h"
 #include "log.h"
 
 ini_t *ini_init(ini_t *ini, uint secs_cap, uint pairs_cap, uint vals_cap)
@@ -133,36 +135,53 @@ int ini_print(const ini_t *ini, print_dst_t dst)
 		return 0;
 	}
 
-	int off	  = dst.off;
+	char data[DBUF_STACK_SIZE];
+	dbuf_t buf;
+	if (dbuf_init_ext(&buf, data, sizeof(data), dst) == NULL) {
+		return 0;
+	}
+
 	int first = 1;
 	ini_sec_data_t *sec;
 	arr_foreach(&ini->secs, sec)
 	{
 		if (!first) {
-			dst.off += dprintf(dst, "\n");
+			dbuf_catc(&buf, '\n');
 		}
 
 		if (sec->name.data != NULL) {
-			dst.off += dprintf(dst, "[%.*s]\n", sec->name.len, sec->name.data);
+			dbuf_catc(&buf, '[');
+			dbuf_cat(&buf, sec->name.data, sec->name.len);
+			dbuf_cat(&buf, CSTR("]\n"));
 		}
 
 		ini_pair_data_t *pair;
 		list_foreach(&ini->pairs, sec->pairs, pair)
 		{
 			if (pair->key.data) {
-				dst.off += dprintf(dst, "%.*s =", pair->key.len, pair->key.data);
+				dbuf_cat(&buf, pair->key.data, pair->key.len);
+				dbuf_cat(&buf, CSTR(" ="));
 			}
 			str_t *val;
 			int f = 1;
 			list_foreach(&ini->vals, pair->vals, val)
 			{
-				dst.off += dprintf(dst, f ? (pair->key.data ? " %.*s" : "%.*s") : ", %.*s", val->len, val->data);
+				if (!f) {
+					dbuf_cat(&buf, CSTR(", "));
+				} else if (pair->key.data) {
+					dbuf_catc(&buf, ' ');
+				}
+				dbuf_cat(&buf, val->data, val->len);
 				f = 0;
 			}
-			dst.off += dprintf(dst, "\n");
+			dbuf_catc(&buf, '\n');
 		}
 		first = 0;
 	}
 
-	return dst.off - off;
+	dbuf_flush(&buf);
+
+	const int off = buf.dst.off - dst.off;
+	dbuf_free(&buf);
+	return off;
 }
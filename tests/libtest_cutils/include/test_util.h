@@ -0,0 +1,6 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+void test_write_file(const char *path, const char *data);
+
+#endif
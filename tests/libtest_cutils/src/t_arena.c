@@ -0,0 +1,89 @@
+#include "arena.h"
+
+#include "mem.h"
+#include "test.h"
+
+#include <string.h>
+
+TEST(t_arena_init_free)
+{
+	START;
+
+	arena_t arena = { 0 };
+
+	EXPECT_EQ(arena_init(NULL, 0), NULL);
+	EXPECT_EQ(arena_init(&arena, 0), NULL);
+	EXPECT_EQ(arena_init(&arena, 16), &arena);
+
+	arena_free(&arena);
+	arena_free(NULL);
+
+	EXPECT_EQ(arena.chunks, NULL);
+
+	END;
+}
+
+TEST(t_arena_alloc)
+{
+	START;
+
+	arena_t arena = { 0 };
+	arena_init(&arena, 16);
+
+	EXPECT_EQ(arena_alloc(NULL, 0), NULL);
+	mem_oom(1);
+	EXPECT_EQ(arena_alloc(&arena, 4), NULL);
+	mem_oom(0);
+
+	char *a = arena_alloc(&arena, 3);
+	char *b = arena_alloc(&arena, 4);
+	char *c = arena_alloc(&arena, 32);
+
+	EXPECT_NE(a, NULL);
+	EXPECT_EQ(b, a + 8);
+	EXPECT_NE(c, NULL);
+	EXPECT_EQ(arena.used, 39);
+
+	arena_reset(&arena);
+	arena_reset(NULL);
+	EXPECT_EQ(arena.used, 0);
+	EXPECT_NE(arena_alloc(&arena, 8), NULL);
+
+	arena_free(&arena);
+
+	END;
+}
+
+TEST(t_arena_strn)
+{
+	START;
+
+	arena_t arena = { 0 };
+	arena_init(&arena, 16);
+
+	EXPECT_EQ(arena_strn(NULL, NULL, 0), NULL);
+	EXPECT_EQ(arena_strn(&arena, NULL, 0), NULL);
+	mem_oom(1);
+	EXPECT_EQ(arena_strn(&arena, "abc", 3), NULL);
+	mem_oom(0);
+
+	const char *a = arena_strn(&arena, "abc", 3);
+	const char *b = arena_strn(&arena, "defgh", 2);
+
+	EXPECT_STR(a, "abc");
+	EXPECT_STR(b, "de");
+	EXPECT_EQ(b, a + 4);
+
+	arena_free(&arena);
+
+	END;
+}
+
+STEST(t_arena)
+{
+	SSTART;
+	RUN(t_arena_init_free);
+	RUN(t_arena_alloc);
+	RUN(t_arena_strn);
+	SEND;
+}
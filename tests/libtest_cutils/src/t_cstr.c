@@ -223,6 +223,26 @@ TEST(t_cstr_cstr)
 	END;
 }
 
+TEST(t_cstr_remove_chr)
+{
+	START;
+
+	char buf[64] = "a\r\nb\r\n0123456789abcdef0123456789\r\r\r\r\r\r\r\r\r\r\r\r\r\r\r\rz\r";
+	char none[]  = "0123456789abcdef0123456789";
+
+	EXPECT_EQ(cstr_remove_chr(NULL, 0, '\r'), 0);
+	EXPECT_EQ(cstr_remove_chr(none, sizeof(none) - 1, '\r'), sizeof(none) - 1);
+	EXPECT_STR(none, "0123456789abcdef0123456789");
+
+	size_t len = cstr_remove_chr(buf, cstr_len(buf), '\r');
+	buf[len]   = '\0';
+
+	EXPECT_EQ(len, 31);
+	EXPECT_STR(buf, "a\nb\n0123456789abcdef0123456789z");
+
+	END;
+}
+
 TEST(t_cstr_replace_short)
 {
 	START;
@@ -397,6 +417,7 @@ STEST(t_cstr)
 	RUN(t_cstr_chr);
 	RUN(t_cstr_rchr);
 	RUN(t_cstr_cstr);
+	RUN(t_cstr_remove_chr);
 	RUN(t_cstr_replace);
 	RUN(t_wcstr_catn);
 
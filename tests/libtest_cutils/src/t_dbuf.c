@@ -0,0 +1,210 @@
+#include "dbuf.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#define TEST_FILE "t_dbuf.txt"
+
+TEST(t_dbuf_init_free)
+{
+	START;
+
+	dbuf_t buf = { 0 };
+
+	EXPECT_EQ(dbuf_init(NULL, 0), NULL);
+	EXPECT_EQ(dbuf_init(&buf, 0), NULL);
+	mem_oom(1);
+	EXPECT_EQ(dbuf_init(&buf, 16), NULL);
+	mem_oom(0);
+	EXPECT_EQ(dbuf_init(&buf, 16), &buf);
+
+	dbuf_free(&buf);
+	dbuf_free(NULL);
+
+	EXPECT_EQ(buf.data, NULL);
+
+	END;
+}
+
+TEST(t_dbuf_cat)
+{
+	START;
+
+	dbuf_t buf = { 0 };
+	dbuf_init(&buf, 4);
+
+	EXPECT_EQ(dbuf_cat(NULL, NULL, 0), 0);
+	EXPECT_EQ(dbuf_cat(&buf, NULL, 0), 0);
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("abc")), 3);
+	EXPECT_EQ(dbuf_catc(NULL, 'd'), 0);
+	EXPECT_EQ(dbuf_catc(&buf, 'd'), 1);
+	EXPECT_EQ(dbuf_catn(NULL, ' ', 2), 0);
+	EXPECT_EQ(dbuf_catn(&buf, ' ', 2), 2);
+	mem_oom(1);
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("efghijklmn")), 0);
+	mem_oom(0);
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("efghijklmn")), 10);
+
+	EXPECT_EQ(buf.len, 16);
+	EXPECT_STRN(buf.data, "abcd  efghijklmn", buf.len);
+
+	dbuf_free(&buf);
+
+	END;
+}
+
+TEST(t_dbuf_reserve)
+{
+	START;
+
+	dbuf_t buf = { 0 };
+	dbuf_init(&buf, 4);
+
+	EXPECT_EQ(dbuf_reserve(NULL, 1), 1);
+	EXPECT_EQ(dbuf_reserve(&buf, 4), 0);
+	EXPECT_EQ(buf.size, 4);
+	dbuf_cat(&buf, CSTR("ab"));
+	mem_oom(1);
+	EXPECT_EQ(dbuf_reserve(&buf, 3), 1);
+	mem_oom(0);
+	EXPECT_EQ(dbuf_reserve(&buf, 3), 0);
+	EXPECT_EQ(buf.size, 8);
+	EXPECT_STRN(buf.data, "ab", buf.len);
+
+	dbuf_free(&buf);
+
+	END;
+}
+
+TEST(t_dbuf_printf)
+{
+	START;
+
+	dbuf_t buf = { 0 };
+	dbuf_init(&buf, 4);
+
+	EXPECT_EQ(dbuf_printf(NULL, NULL), 0);
+	EXPECT_EQ(dbuf_printf(&buf, NULL), 0);
+	EXPECT_EQ(dbuf_printf(&buf, "%d", 12), 2);
+	EXPECT_EQ(dbuf_printf(&buf, "%s", ""), 0);
+	EXPECT_EQ(dbuf_printf(&buf, "%d-%s", 3, "long string"), 13);
+
+	EXPECT_EQ(buf.len, 15);
+	EXPECT_STRN(buf.data, "123-long string", buf.len);
+
+	dbuf_free(&buf);
+
+	END;
+}
+
+TEST(t_dbuf_flush)
+{
+	START;
+
+	FILE *file = file_open(TEST_FILE, "wb");
+
+	dbuf_t buf = { 0 };
+	dbuf_init_dst(&buf, 8, PRINT_DST_FILE(file));
+
+	EXPECT_EQ(dbuf_flush(NULL), 0);
+	EXPECT_EQ(dbuf_flush(&buf), 0);
+
+	dbuf_cat(&buf, CSTR("ab\0cdef"));
+	dbuf_cat(&buf, CSTR("0123456789"));
+	dbuf_printf(&buf, "%d", 42);
+	EXPECT_EQ(buf.size, 8);
+	EXPECT_EQ(dbuf_flush(&buf), 2);
+	EXPECT_EQ(buf.dst.off, 19);
+	EXPECT_EQ(buf.len, 0);
+
+	dbuf_free(&buf);
+	file_close(file);
+
+	char out[32] = { 0 };
+	EXPECT_EQ(file_read_t(TEST_FILE, out, sizeof(out)), 19);
+	EXPECT_EQ(mem_cmp(out, "ab\0cdef012345678942", 19), 0);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_dbuf_ext)
+{
+	START;
+
+	char data[4];
+	dbuf_t buf = { 0 };
+
+	EXPECT_EQ(dbuf_init_ext(NULL, NULL, 0, PRINT_DST_NONE()), NULL);
+	EXPECT_EQ(dbuf_init_ext(&buf, data, 0, PRINT_DST_NONE()), NULL);
+	EXPECT_EQ(dbuf_init_ext(&buf, data, sizeof(data), PRINT_DST_NONE()), &buf);
+
+	dbuf_cat(&buf, CSTR("abc"));
+	EXPECT_EQ(buf.data, data);
+	mem_oom(1);
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("defg")), 0);
+	mem_oom(0);
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("defg")), 4);
+	EXPECT_NE(buf.data, data);
+	EXPECT_EQ(buf.size, 8);
+	EXPECT_STRN(buf.data, "abcdefg", buf.len);
+
+	dbuf_free(&buf);
+
+	END;
+}
+
+TEST(t_dbuf_dst_buf)
+{
+	START;
+
+	char out[8] = { 0 };
+	char data[4];
+
+	dbuf_t buf = { 0 };
+	dbuf_init_ext(&buf, data, sizeof(data), PRINT_DST_BUF(out, sizeof(out), 0));
+	EXPECT_EQ(buf.data, out);
+
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("abcd")), 4);
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("efgh")), 0);
+	EXPECT_EQ(dbuf_printf(&buf, "%s", ""), 0);
+	EXPECT_EQ(dbuf_printf(&buf, "%d", 1234), 0);
+	EXPECT_EQ(dbuf_printf(&buf, "%d", 12), 2);
+	EXPECT_EQ(dbuf_catc(&buf, 'x'), 1);
+	EXPECT_EQ(dbuf_catc(&buf, 'y'), 0);
+	EXPECT_EQ(dbuf_flush(&buf), 7);
+	EXPECT_STR(out, "abcd12x");
+	EXPECT_EQ(buf.dst.off, 7);
+
+	dbuf_free(&buf);
+
+	out[0] = 'a';
+	dbuf_init_dst(&buf, 16, PRINT_DST_BUF(out, sizeof(out), 8));
+	EXPECT_EQ(dbuf_cat(&buf, CSTR("b")), 0);
+	EXPECT_EQ(dbuf_printf(&buf, "%d", 1), 0);
+	EXPECT_EQ(dbuf_flush(&buf), 0);
+	dbuf_free(&buf);
+
+	dbuf_init_dst(&buf, 16, PRINT_DST_BUF(out, sizeof(out), 2));
+	EXPECT_EQ(dbuf_flush(&buf), 0);
+	EXPECT_STR(out, "ab");
+	dbuf_free(&buf);
+
+	END;
+}
+
+STEST(t_dbuf)
+{
+	SSTART;
+	RUN(t_dbuf_init_free);
+	RUN(t_dbuf_cat);
+	RUN(t_dbuf_reserve);
+	RUN(t_dbuf_printf);
+	RUN(t_dbuf_flush);
+	RUN(t_dbuf_ext);
+	RUN(t_dbuf_dst_buf);
+	SEND;
+}
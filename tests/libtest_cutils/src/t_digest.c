@@ -0,0 +1,126 @@
+#include "digest.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#define TEST_FILE "t_digest.txt"
+
+TEST(t_digest_hex)
+{
+	START;
+
+	const byte digest[] = { 0x01, 0xAB, 0xFF, 0x10 };
+	char out[9]	    = { 0 };
+
+	EXPECT_EQ(digest_hex(NULL, 0, NULL, 0), 1);
+	EXPECT_EQ(digest_hex(digest, sizeof(digest), NULL, 0), 1);
+	EXPECT_EQ(digest_hex(digest, sizeof(digest), out, 8), 1);
+	EXPECT_EQ(digest_hex(digest, sizeof(digest), out, sizeof(out)), 0);
+
+	EXPECT_STR(out, "01abff10");
+
+	END;
+}
+
+TEST(t_digest_guid)
+{
+	START;
+
+	const byte digest[] = { 0x09, 0x8F, 0x6B, 0xCD, 0x46, 0x21, 0xD3, 0x73, 0xCA, 0xDE, 0x4E, 0x83, 0x26, 0x27, 0xB4, 0xF6 };
+	char out[37]	    = { 0 };
+
+	EXPECT_EQ(digest_guid(NULL, NULL, 0), 1);
+	EXPECT_EQ(digest_guid(digest, NULL, 0), 1);
+	EXPECT_EQ(digest_guid(digest, out, 36), 1);
+	EXPECT_EQ(digest_guid(digest, out, sizeof(out)), 0);
+
+	EXPECT_STR(out, "098F6BCD-4621-D373-CADE-4E832627B4F6");
+
+	END;
+}
+
+typedef struct sum_s {
+	u32 h;
+	u64 len;
+	byte block[4];
+	uint calls;
+} sum_t;
+
+static void sum_blocks(void *h, const byte *data, size_t cnt)
+{
+	u32 *sum = h;
+	for (size_t i = 0; i < cnt * 4; i++) {
+		*sum = *sum * 31 + data[i];
+	}
+}
+
+static void sum_update(void *ctx, const void *data, size_t len)
+{
+	sum_t *sum = ctx;
+	digest_update(&sum->h, sum->block, sizeof(sum->block), &sum->len, data, len, sum_blocks);
+	sum->calls++;
+}
+
+TEST(t_digest_update)
+{
+	START;
+
+	sum_t one = { 0 };
+	sum_update(&one, CSTR("abcdefghij"));
+
+	sum_t parts = { 0 };
+	sum_update(&parts, CSTR("a"));
+	sum_update(&parts, CSTR("bc"));
+	sum_update(&parts, CSTR("defgh"));
+	sum_update(&parts, CSTR("ij"));
+
+	EXPECT_EQ(one.h, parts.h);
+	EXPECT_EQ(one.len, 10);
+	EXPECT_EQ(parts.len, 10);
+	EXPECT_EQ(mem_cmp(parts.block, "ij", 2), 0);
+
+	END;
+}
+
+TEST(t_digest_file)
+{
+	START;
+
+	sum_t sum = { 0 };
+
+	EXPECT_EQ(digest_file(NULL, NULL, NULL), 1);
+	EXPECT_EQ(digest_file(TEST_FILE, &sum, NULL), 1);
+	EXPECT_EQ(digest_file(TEST_FILE, &sum, sum_update), 1);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fwrite("abcdefghij", 1, 10, file);
+	file_close(file);
+
+	mem_oom(1);
+	EXPECT_EQ(digest_file(TEST_FILE, &sum, sum_update), 1);
+	mem_oom(0);
+	EXPECT_EQ(digest_file(TEST_FILE, &sum, sum_update), 0);
+
+	sum_t one = { 0 };
+	sum_update(&one, CSTR("abcdefghij"));
+
+	EXPECT_EQ(sum.h, one.h);
+	EXPECT_EQ(sum.len, 10);
+	EXPECT_EQ(sum.calls, 1);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+STEST(t_digest)
+{
+	SSTART;
+	RUN(t_digest_hex);
+	RUN(t_digest_guid);
+	RUN(t_digest_update);
+	RUN(t_digest_file);
+	SEND;
+}
@@ -0,0 +1,138 @@
+#include "fcache.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+#include "test_util.h"
+
+#define TEST_DIR  "t_fcache"
+#define TEST_FILE "t_fcache.txt"
+
+TEST(t_fcache_init_free)
+{
+	START;
+
+	fcache_t cache = { 0 };
+
+	EXPECT_EQ(fcache_init(NULL, NULL, 0), NULL);
+	EXPECT_EQ(fcache_init(&cache, NULL, 0), NULL);
+	EXPECT_EQ(fcache_init(&cache, CSTR(TEST_DIR)), &cache);
+	EXPECT_EQ(folder_exists(TEST_DIR), 1);
+
+	EXPECT_EQ(fcache_save(NULL), 1);
+	EXPECT_EQ(fcache_save(&cache), 0);
+
+	fcache_free(&cache);
+	fcache_free(NULL);
+
+	folder_delete(TEST_DIR);
+
+	END;
+}
+
+TEST(t_fcache_check)
+{
+	START;
+
+	fcache_t cache = { 0 };
+	fcache_init(&cache, CSTR(TEST_DIR));
+
+	EXPECT_EQ(fcache_check(NULL, NULL, 0), 0);
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 0);
+
+	test_write_file(TEST_FILE, "data");
+
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 0);
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 0);
+	EXPECT_EQ(cache.dirty, 0);
+	EXPECT_EQ(fcache_put(&cache, CSTR(TEST_FILE), CSTR("artifact")), 0);
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 1);
+	EXPECT_EQ(fcache_save(&cache), 0);
+	fcache_free(&cache);
+
+	byte index[128] = { 0 };
+	EXPECT_EQ(file_read_t(TEST_DIR SEP "index", (char *)index, sizeof(index)), 8 + 4 + sizeof(TEST_FILE) - 1 + 40);
+	EXPECT_EQ(index[4], 1);
+	EXPECT_EQ(index[7], 0);
+	EXPECT_EQ(index[8], sizeof(TEST_FILE) - 1);
+	EXPECT_EQ(index[11], 0);
+
+	fcache_init(&cache, CSTR(TEST_DIR));
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 1);
+
+	test_write_file(TEST_FILE, "data");
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 1);
+
+	test_write_file(TEST_FILE, "changed");
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 0);
+	EXPECT_EQ(fcache_check(&cache, CSTR(TEST_FILE)), 0);
+
+	EXPECT_EQ(cache.stats.hits + cache.stats.rehashed, 2);
+	EXPECT_EQ(cache.stats.misses, 2);
+
+	char buf[128] = { 0 };
+	EXPECT_EQ(fcache_print(NULL, PRINT_DST_BUF(buf, sizeof(buf), 0)), 0);
+	EXPECT_GT(fcache_print(&cache, PRINT_DST_BUF(buf, sizeof(buf), 0)), 0);
+	EXPECT_STRN(buf, "fcache: 2/4 hits (50%)", 22);
+
+	EXPECT_EQ(fcache_save(&cache), 0);
+	fcache_free(&cache);
+
+	file_delete(TEST_FILE);
+	file_delete(TEST_DIR SEP "index");
+	file_delete(TEST_DIR SEP "fb2a989a6518e5690304539b91ce6dec");
+	folder_delete(TEST_DIR);
+
+	END;
+}
+
+TEST(t_fcache_put_get)
+{
+	START;
+
+	fcache_t cache = { 0 };
+	fcache_init(&cache, CSTR(TEST_DIR));
+
+	size_t size = 0;
+
+	EXPECT_EQ(fcache_put(NULL, NULL, 0, NULL, 0), 1);
+	EXPECT_EQ(fcache_put(&cache, CSTR(TEST_FILE), NULL, 1), 1);
+	EXPECT_EQ(fcache_put(&cache, CSTR(TEST_FILE), CSTR("artifact")), 1);
+	EXPECT_EQ(fcache_get(NULL, NULL, 0, NULL), NULL);
+	EXPECT_EQ(fcache_get(&cache, CSTR(TEST_FILE), &size), NULL);
+
+	test_write_file(TEST_FILE, "input");
+
+	EXPECT_EQ(fcache_put(&cache, CSTR(TEST_FILE), CSTR("artifact")), 0);
+
+	char *data = fcache_get(&cache, CSTR(TEST_FILE), &size);
+	EXPECT_EQ(size, 8);
+	EXPECT_STRN(data, "artifact", 8);
+	file_unmap(data, size);
+
+	EXPECT_EQ(fcache_put(&cache, CSTR(TEST_FILE), NULL, 0), 0);
+	data = fcache_get(&cache, CSTR(TEST_FILE), &size);
+	EXPECT_NE(data, NULL);
+	EXPECT_EQ(size, 0);
+	file_unmap(data, size);
+
+	fcache_save(&cache);
+	fcache_free(&cache);
+
+	file_delete(TEST_FILE);
+	file_delete(TEST_DIR SEP "index");
+	file_delete(TEST_DIR SEP "c3919b0b80c770dcaba928458d2e49b0");
+	folder_delete(TEST_DIR);
+
+	END;
+}
+
+STEST(t_fcache)
+{
+	SSTART;
+	RUN(t_fcache_init_free);
+	RUN(t_fcache_check);
+	RUN(t_fcache_put_get);
+	SEND;
+}
@@ -0,0 +1,252 @@
+#if !defined(_WIN32)
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fcopy.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "finfo.h"
+#include "test.h"
+#include "test_util.h"
+#include "thread.h"
+
+#include <string.h>
+
+#if defined(C_LINUX)
+	#include <dirent.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <time.h>
+	#include <unistd.h>
+#endif
+
+TEST(t_file_copy)
+{
+	START;
+
+	test_write_file("t_fcopy.txt", "Test data");
+
+	EXPECT_EQ(file_copy(NULL, NULL), 1);
+	EXPECT_EQ(file_copy("t_fcopy.txt", NULL), 1);
+	EXPECT_EQ(file_copy("not.txt", "t_fcopy2.txt"), 1);
+	EXPECT_EQ(file_copy("t_fcopy.txt", "not/t_fcopy2.txt"), 1);
+	EXPECT_EQ(file_copy("t_fcopy.txt", "t_fcopy2.txt"), 0);
+
+	char data[32] = { 0 };
+	EXPECT_EQ(file_read_t("t_fcopy2.txt", data, sizeof(data)), 9);
+	EXPECT_STR(data, "Test data");
+
+	finfo_t src = { 0 };
+	finfo_t dst = { 0 };
+	finfo_stat("t_fcopy.txt", &src);
+	finfo_stat("t_fcopy2.txt", &dst);
+	EXPECT_EQ(src.mtime, dst.mtime);
+
+	file_delete("t_fcopy2.txt");
+	file_delete("t_fcopy.txt");
+
+	END;
+}
+
+TEST(t_file_same)
+{
+	START;
+
+	test_write_file("t_fcopy.txt", "Test data");
+	file_copy("t_fcopy.txt", "t_fcopy2.txt");
+
+	EXPECT_EQ(file_same(NULL, NULL, 0), 0);
+	EXPECT_EQ(file_same("t_fcopy.txt", "not.txt", 0), 0);
+	EXPECT_EQ(file_same("t_fcopy.txt", "t_fcopy2.txt", 0), 1);
+	EXPECT_EQ(file_same("t_fcopy.txt", "t_fcopy2.txt", FCOPY_CONTENT), 1);
+
+	test_write_file("t_fcopy2.txt", "Test date");
+	EXPECT_EQ(file_same("t_fcopy.txt", "t_fcopy2.txt", FCOPY_CONTENT), 0);
+
+	test_write_file("t_fcopy2.txt", "Test");
+	EXPECT_EQ(file_same("t_fcopy.txt", "t_fcopy2.txt", FCOPY_CONTENT), 0);
+
+	file_delete("t_fcopy2.txt");
+	file_delete("t_fcopy.txt");
+
+	END;
+}
+
+static void delete_tree(const char *root)
+{
+	const char *files[]   = { "a/x.txt", "b/c/y.txt", "d.txt" };
+	const char *folders[] = { "b/c", "b", "a" };
+
+	char path[64];
+	for (int i = 0; i < 3; i++) {
+		snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+		file_delete(path);
+	}
+	for (int i = 0; i < 3; i++) {
+		folder_delete_f("%s/%s", root, folders[i]);
+	}
+	folder_delete(root);
+}
+
+TEST(t_folder_sync)
+{
+	START;
+
+	folder_create("t_fcopy_src");
+	folder_create("t_fcopy_src/a");
+	folder_create("t_fcopy_src/b");
+	folder_create("t_fcopy_src/b/c");
+	test_write_file("t_fcopy_src/a/x.txt", "x");
+	test_write_file("t_fcopy_src/b/c/y.txt", "y");
+	test_write_file("t_fcopy_src/d.txt", "d");
+
+	path_t src = { 0 };
+	path_t dst = { 0 };
+	path_t not = { 0 };
+	path_init(&src, CSTR("t_fcopy_src"));
+	path_init(&dst, CSTR("t_fcopy_dst/"));
+	path_init(&not, CSTR("not"));
+
+	fcopy_stats_t stats = { 0 };
+
+	EXPECT_EQ(folder_sync(NULL, NULL, 0, 0, NULL, NULL), 1);
+	EXPECT_EQ(folder_sync(&not, &dst, 0, 0, NULL, NULL), 1);
+
+	EXPECT_EQ(folder_sync(&src, &dst, 4, 0, NULL, &stats), 0);
+	EXPECT_EQ(stats.folders, 3);
+	EXPECT_EQ(stats.copied, 3);
+	EXPECT_EQ(stats.skipped, 0);
+	EXPECT_EQ(file_exists("t_fcopy_dst/b/c/y.txt"), 1);
+
+	EXPECT_EQ(folder_sync(&src, &dst, 4, 0, NULL, &stats), 0);
+	EXPECT_EQ(stats.copied, 0);
+	EXPECT_EQ(stats.skipped, 3);
+
+	test_write_file("t_fcopy_dst/d.txt", "e");
+	EXPECT_EQ(folder_sync(&src, &dst, 1, FCOPY_CONTENT, NULL, &stats), 0);
+	EXPECT_EQ(stats.copied, 1);
+	EXPECT_EQ(stats.skipped, 2);
+
+	char data[8] = { 0 };
+	file_read_t("t_fcopy_dst/d.txt", data, sizeof(data));
+	EXPECT_STR(data, "d");
+
+	delete_tree("t_fcopy_dst");
+
+	fglob_t ignore = { 0 };
+	fglob_init(&ignore);
+	fglob_add(&ignore, CSTR("b/"));
+
+	EXPECT_EQ(folder_sync(&src, &dst, 2, 0, &ignore, &stats), 0);
+	EXPECT_EQ(stats.folders, 1);
+	EXPECT_EQ(stats.copied, 2);
+	EXPECT_EQ(folder_exists("t_fcopy_dst/b"), 0);
+
+	fglob_free(&ignore);
+
+	delete_tree("t_fcopy_dst");
+	delete_tree("t_fcopy_src");
+
+	END;
+}
+
+#if defined(C_LINUX)
+typedef struct sync_args_s {
+	path_t src;
+	path_t dst;
+	fcopy_stats_t stats;
+	int ret;
+} sync_args_t;
+
+static void sync_thread(void *priv)
+{
+	sync_args_t *args = priv;
+	args->ret	  = folder_sync(&args->src, &args->dst, 2, 0, NULL, &args->stats);
+}
+
+static int open_srcs()
+{
+	DIR *dir = opendir("/proc/self/fd");
+	if (dir == NULL) {
+		return 0;
+	}
+
+	int cnt = 0;
+	struct dirent *dp;
+	while ((dp = readdir(dir)) != NULL) {
+		char link[300];
+		char target[256];
+		snprintf(link, sizeof(link), "/proc/self/fd/%s", dp->d_name);
+		const ssize_t len = readlink(link, target, sizeof(target) - 1);
+		if (len <= 0) {
+			continue;
+		}
+
+		target[len] = '\0';
+		cnt += strstr(target, "t_fcopy_src/") != NULL;
+	}
+
+	closedir(dir);
+	return cnt;
+}
+#endif
+
+TEST(t_folder_sync_parallel)
+{
+	START;
+
+#if defined(C_LINUX)
+	folder_create("t_fcopy_src");
+	folder_create("t_fcopy_dst");
+	test_write_file("t_fcopy_src/a.txt", "");
+	test_write_file("t_fcopy_src/b.txt", "");
+	EXPECT_EQ(mkfifo("t_fcopy_dst/a.txt", 0600), 0);
+	EXPECT_EQ(mkfifo("t_fcopy_dst/b.txt", 0600), 0);
+
+	sync_args_t args = { 0 };
+	path_init(&args.src, CSTR("t_fcopy_src"));
+	path_init(&args.dst, CSTR("t_fcopy_dst"));
+
+	thread_t thread;
+	EXPECT_EQ(thread_create(&thread, sync_thread, &args), 0);
+
+	const struct timespec ts = { 0, 1000000 };
+
+	int overlap = 0;
+	for (int i = 0; i < 5000 && !overlap; i++) {
+		overlap = open_srcs() == 2;
+		nanosleep(&ts, NULL);
+	}
+
+	const int a = open("t_fcopy_dst/a.txt", O_RDONLY | O_NONBLOCK);
+	const int b = open("t_fcopy_dst/b.txt", O_RDONLY | O_NONBLOCK);
+	thread_join(&thread);
+	close(a);
+	close(b);
+
+	EXPECT_EQ(overlap, 1);
+	EXPECT_EQ(args.ret, 0);
+	EXPECT_EQ(args.stats.copied, 2);
+	EXPECT_EQ(args.stats.peak, 2);
+
+	file_delete("t_fcopy_src/a.txt");
+	file_delete("t_fcopy_src/b.txt");
+	file_delete("t_fcopy_dst/a.txt");
+	file_delete("t_fcopy_dst/b.txt");
+	folder_delete("t_fcopy_src");
+	folder_delete("t_fcopy_dst");
+#endif
+
+	END;
+}
+
+STEST(t_fcopy)
+{
+	SSTART;
+	RUN(t_file_copy);
+	RUN(t_file_same);
+	RUN(t_folder_sync);
+	RUN(t_folder_sync_parallel);
+	SEND;
+}
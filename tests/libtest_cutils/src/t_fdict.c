@@ -0,0 +1,147 @@
+#include "fdict.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "test.h"
+
+#include <stdint.h>
+
+#define TEST_FILE "t_fdict.bin"
+
+TEST(t_fdict_open_close)
+{
+	START;
+
+	fdict_t dict = { 0 };
+
+	EXPECT_EQ(fdict_open(NULL, NULL), NULL);
+	EXPECT_EQ(fdict_open(&dict, NULL), NULL);
+	EXPECT_EQ(fdict_open(&dict, TEST_FILE), NULL);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fprintf(file, "invalid");
+	file_close(file);
+
+	EXPECT_EQ(fdict_open(&dict, TEST_FILE), NULL);
+
+	fdict_close(&dict);
+	fdict_close(NULL);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_fdict_save_get)
+{
+	START;
+
+	fdict_writer_t writer = { 0 };
+
+	EXPECT_EQ(fdict_writer_init(NULL, 0), NULL);
+	EXPECT_EQ(fdict_writer_init(&writer, 0), &writer);
+
+	EXPECT_EQ(fdict_writer_add(NULL, NULL, 0, NULL, 0), 1);
+	EXPECT_EQ(fdict_writer_add(&writer, CSTR("a"), NULL, 1), 1);
+	EXPECT_EQ(fdict_writer_add(&writer, CSTR("a"), CSTR("1")), 0);
+	EXPECT_EQ(fdict_writer_add(&writer, CSTR("b"), CSTR("22")), 0);
+	EXPECT_EQ(fdict_writer_add(&writer, CSTR("a"), CSTR("333")), 0);
+#if SIZE_MAX > 0xFFFFFFFF
+	EXPECT_EQ(fdict_writer_add(&writer, CSTR("c"), "3", (size_t)0xFFFFFFFF + 1), 1);
+	EXPECT_EQ(fdict_writer_add(&writer, "c", (size_t)0xFFFFFFFF + 1, CSTR("3")), 1);
+#endif
+
+	char key[16];
+	for (int i = 0; i < 100; i++) {
+		int len = snprintf(key, sizeof(key), "key%d", i);
+		fdict_writer_add(&writer, key, len, &i, sizeof(i));
+	}
+
+	EXPECT_EQ(fdict_writer_save(NULL, NULL), 1);
+	EXPECT_EQ(fdict_writer_save(&writer, TEST_FILE), 0);
+	EXPECT_EQ(file_exists(TEST_FILE ".tmp"), 0);
+
+	fdict_writer_free(&writer);
+	fdict_writer_free(NULL);
+
+	byte hdr[16] = { 0 };
+	FILE *file   = file_open(TEST_FILE, "rb");
+	EXPECT_EQ(fread(hdr, 1, sizeof(hdr), file), sizeof(hdr));
+	file_close(file);
+	EXPECT_EQ(mem_cmp(hdr, "FDT1", 4), 0);
+	EXPECT_EQ(hdr[4] | hdr[5] << 8, 256);
+	EXPECT_EQ(hdr[7], 0);
+	EXPECT_EQ(hdr[8], 102);
+	EXPECT_EQ(hdr[11], 0);
+
+	fdict_t dict = { 0 };
+	EXPECT_EQ(fdict_open(&dict, TEST_FILE), &dict);
+	EXPECT_EQ(dict.cnt, 102);
+
+	size_t size = 0;
+	EXPECT_EQ(fdict_get(NULL, NULL, 0, NULL), NULL);
+	EXPECT_EQ(fdict_get(&dict, CSTR("c"), &size), NULL);
+
+	const char *val = fdict_get(&dict, CSTR("a"), &size);
+	EXPECT_EQ(size, 3);
+	EXPECT_STRN(val, "333", 3);
+
+	val = fdict_get(&dict, CSTR("b"), &size);
+	EXPECT_EQ(size, 2);
+	EXPECT_STRN(val, "22", 2);
+
+	int found = 0;
+	for (int i = 0; i < 100; i++) {
+		int len		= snprintf(key, sizeof(key), "key%d", i);
+		const int *data = fdict_get(&dict, key, len, &size);
+		found += data != NULL && size == sizeof(int) && *data == i;
+	}
+	EXPECT_EQ(found, 100);
+
+	fdict_close(&dict);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_fdict_load)
+{
+	START;
+
+	fdict_writer_t writer = { 0 };
+	fdict_writer_init(&writer, 8);
+	fdict_writer_add(&writer, CSTR("a"), CSTR("1"));
+	fdict_writer_save(&writer, TEST_FILE);
+	fdict_writer_free(&writer);
+
+	fdict_t dict = { 0 };
+	fdict_open(&dict, TEST_FILE);
+
+	fdict_writer_init(&writer, 8);
+	EXPECT_EQ(fdict_writer_load(NULL, NULL), 1);
+	EXPECT_EQ(fdict_writer_load(&writer, &dict), 0);
+	fdict_writer_add(&writer, CSTR("b"), CSTR("2"));
+	EXPECT_EQ(fdict_writer_save(&writer, TEST_FILE), 0);
+	fdict_writer_free(&writer);
+	fdict_close(&dict);
+
+	fdict_open(&dict, TEST_FILE);
+	size_t size = 0;
+	EXPECT_EQ(dict.cnt, 2);
+	EXPECT_STRN(fdict_get(&dict, CSTR("a"), &size), "1", 1);
+	EXPECT_STRN(fdict_get(&dict, CSTR("b"), &size), "2", 1);
+	fdict_close(&dict);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+STEST(t_fdict)
+{
+	SSTART;
+	RUN(t_fdict_open_close);
+	RUN(t_fdict_save_get);
+	RUN(t_fdict_load);
+	SEND;
+}
@@ -0,0 +1,172 @@
+#include "fglob.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#include <string.h>
+
+#define TEST_FILE "t_fglob.txt"
+
+TEST(t_fglob_init_free)
+{
+	START;
+
+	fglob_t glob = { 0 };
+
+	EXPECT_EQ(fglob_init(NULL), NULL);
+	mem_oom(1);
+	EXPECT_EQ(fglob_init(&glob), NULL);
+	mem_oom(0);
+	EXPECT_EQ(fglob_init(&glob), &glob);
+
+	fglob_free(&glob);
+	fglob_free(NULL);
+
+	END;
+}
+
+TEST(t_fglob_add)
+{
+	START;
+
+	fglob_t glob = { 0 };
+	fglob_init(&glob);
+
+	EXPECT_EQ(fglob_add(NULL, NULL, 0), 1);
+	EXPECT_EQ(fglob_add(&glob, NULL, 0), 1);
+	EXPECT_EQ(fglob_add(&glob, CSTR("")), 0);
+	EXPECT_EQ(fglob_add(&glob, CSTR("# comment")), 0);
+	EXPECT_EQ(fglob_add(&glob, CSTR("   ")), 0);
+	EXPECT_EQ(fglob_add(&glob, CSTR("/")), 0);
+	EXPECT_EQ(glob.cnt, 0);
+	mem_oom(1);
+	EXPECT_EQ(fglob_add(&glob, CSTR("build")), 1);
+	mem_oom(0);
+	EXPECT_EQ(fglob_add(&glob, CSTR("build")), 0);
+	EXPECT_EQ(fglob_add(&glob, CSTR("*.o")), 0);
+	EXPECT_EQ(fglob_add(&glob, CSTR("src/**/*.c")), 0);
+	EXPECT_EQ(glob.cnt, 3);
+	EXPECT_EQ(glob.names.count, 1);
+	EXPECT_EQ(glob.exts.count, 1);
+	EXPECT_EQ(glob.rules.cnt, 1);
+
+	fglob_free(&glob);
+
+	END;
+}
+
+TEST(t_fglob_add_file)
+{
+	START;
+
+	fglob_t glob = { 0 };
+	fglob_init(&glob);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	c_fprintf(file, "# build output\r\nbuild/\r\n*.o\n!keep.o\n");
+	file_close(file);
+
+	EXPECT_EQ(fglob_add_file(NULL, NULL), 1);
+	EXPECT_EQ(fglob_add_file(&glob, NULL), 1);
+	EXPECT_EQ(fglob_add_file(&glob, "not.txt"), 1);
+	EXPECT_EQ(fglob_add_file(&glob, TEST_FILE), 0);
+	EXPECT_EQ(glob.cnt, 3);
+
+	EXPECT_EQ(fglob_match(&glob, CSTR("build"), 1), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("build"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/b.o"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/keep.o"), 0), 0);
+
+	fglob_free(&glob);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_fglob_match_name)
+{
+	START;
+
+	fglob_t glob = { 0 };
+	fglob_init(&glob);
+
+	EXPECT_EQ(fglob_match(NULL, NULL, 0, 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a.o"), 0), 0);
+
+	fglob_add(&glob, CSTR(".git"));
+	fglob_add(&glob, CSTR("*.o"));
+	fglob_add(&glob, CSTR("*.tar.gz"));
+	fglob_add(&glob, CSTR("test_?.[ch]"));
+	fglob_add(&glob, CSTR("[!a-c]*.tmp"));
+	fglob_add(&glob, CSTR("\\#hash"));
+
+	EXPECT_EQ(fglob_match(&glob, CSTR(".git"), 1), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/.git"), 1), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/.gitignore"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/b/c.o"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("c.oo"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a.tar.gz"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a.gz"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("test_1.c"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("test_1.h"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("test_1.o"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("test_12.c"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("d.tmp"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("b.tmp"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("#hash"), 0), 1);
+
+	fglob_free(&glob);
+
+	END;
+}
+
+TEST(t_fglob_match_path)
+{
+	START;
+
+	fglob_t glob = { 0 };
+	fglob_init(&glob);
+
+	fglob_add(&glob, CSTR("/build"));
+	fglob_add(&glob, CSTR("doc/*.md"));
+	fglob_add(&glob, CSTR("**/gen"));
+	fglob_add(&glob, CSTR("src/**/*.c"));
+	fglob_add(&glob, CSTR("out/**"));
+
+	EXPECT_EQ(fglob_match(&glob, CSTR("build"), 1), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/build"), 1), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("doc/a.md"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("doc/a/b.md"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("gen"), 1), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("a/b/gen"), 1), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("src/a.c"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("src/a/b/c.c"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("src/a/b/c.h"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("out"), 1), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("out/a"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("out/a/b"), 0), 1);
+
+	fglob_add(&glob, CSTR("!src/keep.c"));
+	fglob_add(&glob, CSTR("!/build"));
+
+	EXPECT_EQ(fglob_match(&glob, CSTR("src/keep.c"), 0), 0);
+	EXPECT_EQ(fglob_match(&glob, CSTR("src/a/keep.c"), 0), 1);
+	EXPECT_EQ(fglob_match(&glob, CSTR("build"), 1), 0);
+
+	fglob_free(&glob);
+
+	END;
+}
+
+STEST(t_fglob)
+{
+	SSTART;
+	RUN(t_fglob_init_free);
+	RUN(t_fglob_add);
+	RUN(t_fglob_add_file);
+	RUN(t_fglob_match_name);
+	RUN(t_fglob_match_path);
+	SEND;
+}
@@ -169,6 +169,50 @@ TEST(t_file_size)
 	END;
 }
 
+TEST(t_file_map)
+{
+	START;
+
+	size_t size = 0;
+
+	EXPECT_EQ(file_map(NULL, NULL), NULL);
+	EXPECT_EQ(file_map(TEST_FILE, NULL), NULL);
+	EXPECT_EQ(file_map("not.txt", &size), NULL);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	file_close(file);
+
+	EXPECT_EQ(file_map(TEST_FILE, &size), NULL);
+	EXPECT_EQ(size, 0);
+
+	file = file_open(TEST_FILE, "wb");
+	c_fprintf(file, "Test");
+	file_close(file);
+
+	char *data = file_map(TEST_FILE, &size);
+	EXPECT_NE(data, NULL);
+	EXPECT_EQ(size, 4);
+	EXPECT_STRN(data, "Test", 4);
+
+	file_unmap(data, size);
+	file_unmap(NULL, 0);
+
+	EXPECT_EQ(file_map_cow(NULL, NULL), NULL);
+	data = file_map_cow(TEST_FILE, &size);
+	EXPECT_NE(data, NULL);
+	data[0] = 'B';
+	EXPECT_STRN(data, "Best", 4);
+	file_unmap(data, size);
+
+	char buf[8] = { 0 };
+	EXPECT_EQ(file_read_t(TEST_FILE, buf, sizeof(buf)), 4);
+	EXPECT_STR(buf, "Test");
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
 TEST(t_file_delete)
 {
 	START;
@@ -348,6 +392,7 @@ STEST(t_file)
 	RUN(t_file_read_ft);
 	RUN(t_file_read_ft_r);
 	RUN(t_file_size);
+	RUN(t_file_map);
 	RUN(t_file_delete);
 	RUN(t_file_exists);
 	RUN(t_folder_create_delete);
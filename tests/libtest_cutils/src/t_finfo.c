@@ -0,0 +1,196 @@
+#include "finfo.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#include <string.h>
+
+#define TEST_FILE "t_finfo.txt"
+
+TEST(t_finfo_stat)
+{
+	START;
+
+	finfo_t info = { 0 };
+
+	EXPECT_EQ(finfo_stat(NULL, NULL), 1);
+	EXPECT_EQ(finfo_stat(TEST_FILE, NULL), 1);
+	EXPECT_EQ(finfo_stat(TEST_FILE, &info), 1);
+	EXPECT_EQ(info.type, FINFO_NONE);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	c_fprintf(file, "Test");
+	file_close(file);
+
+	EXPECT_EQ(finfo_stat(TEST_FILE, &info), 0);
+	EXPECT_EQ(info.type, FINFO_FILE);
+	EXPECT_EQ(info.size, 4);
+	EXPECT_GT(info.mtime, 0);
+
+	EXPECT_EQ(finfo_stat(".", &info), 0);
+	EXPECT_EQ(info.type, FINFO_FOLDER);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_finfo_get)
+{
+	START;
+
+	finfo_t info = { 0 };
+
+	EXPECT_EQ(finfo_get(NULL, 0, NULL), 1);
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), NULL), 1);
+	mem_oom(1);
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 1);
+	mem_oom(0);
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 1);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	c_fprintf(file, "Test");
+	file_close(file);
+
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 0);
+	EXPECT_EQ(info.type, FINFO_FILE);
+	EXPECT_EQ(info.size, 4);
+
+	finfo_invalidate_all();
+	EXPECT_EQ(finfo_get(TEST_FILE "/x", sizeof(TEST_FILE) - 1, &info), 0);
+	EXPECT_EQ(info.type, FINFO_FILE);
+
+	char path[P_MAX_PATH + 1] = { 0 };
+	mem_set(path, 'a', P_MAX_PATH);
+	EXPECT_EQ(finfo_get(path, P_MAX_PATH, &info), 1);
+
+	remove(TEST_FILE);
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 0);
+
+	finfo_invalidate(NULL, 0);
+	finfo_invalidate(CSTR(TEST_FILE));
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 1);
+	EXPECT_EQ(info.type, FINFO_NONE);
+
+	file_close(file_open(TEST_FILE, "wb"));
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 0);
+	EXPECT_EQ(info.size, 0);
+
+	remove(TEST_FILE);
+	finfo_invalidate_all();
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 1);
+
+	folder_create("t_finfo");
+	EXPECT_EQ(finfo_get(CSTR("t_finfo"), &info), 0);
+	EXPECT_EQ(info.type, FINFO_FOLDER);
+	folder_delete("t_finfo");
+	EXPECT_EQ(finfo_get(CSTR("t_finfo"), &info), 1);
+
+	finfo_free();
+
+	END;
+}
+
+TEST(t_finfo_track)
+{
+	START;
+
+	finfo_t info = { 0 };
+
+	finfo_track(NULL, NULL, 0);
+	finfo_untrack(NULL);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 0);
+	EXPECT_EQ(info.size, 0);
+
+	c_fprintf(file, "Test");
+	file_close(file);
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 0);
+	EXPECT_EQ(info.size, 4);
+
+	file_delete(TEST_FILE);
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 1);
+
+	finfo_free();
+
+	END;
+}
+
+TEST(t_finfo_max)
+{
+	START;
+
+	finfo_t info = { 0 };
+
+	file_close(file_open(TEST_FILE, "wb"));
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 0);
+	remove(TEST_FILE);
+
+	char path[32];
+	for (int i = 0; i < 70000; i++) {
+		const int len = snprintf(path, sizeof(path), "t_finfo/%d.txt", i);
+		finfo_get(path, len, &info);
+	}
+
+	EXPECT_EQ(finfo_get(CSTR(TEST_FILE), &info), 1);
+
+	finfo_free();
+
+	END;
+}
+
+TEST(t_finfo_batch)
+{
+	START;
+
+	folder_create("t_finfo");
+
+	char paths[200][32];
+	finfo_query_t queries[200] = { 0 };
+	for (int i = 0; i < 200; i++) {
+		const int len = snprintf(paths[i], sizeof(paths[i]), "t_finfo/%d.txt", i);
+		if (i % 2 == 0) {
+			file_close(file_open(paths[i], "wb"));
+		}
+		queries[i].path = paths[i];
+		queries[i].len	= len;
+	}
+
+	EXPECT_EQ(finfo_batch(NULL, 0, 0), 1);
+	EXPECT_EQ(finfo_batch(queries, 0, 0), 0);
+	EXPECT_EQ(finfo_batch(queries, 200, 4), 0);
+
+	int files = 0;
+	for (int i = 0; i < 200; i++) {
+		files += queries[i].info.type == FINFO_FILE;
+	}
+	EXPECT_EQ(files, 100);
+
+	EXPECT_EQ(finfo_batch(queries, 200, 1), 0);
+	EXPECT_EQ(queries[0].info.type, FINFO_FILE);
+	EXPECT_EQ(queries[1].info.type, FINFO_NONE);
+
+	for (int i = 0; i < 200; i += 2) {
+		file_delete(paths[i]);
+	}
+	folder_delete("t_finfo");
+
+	finfo_free();
+	finfo_free();
+
+	END;
+}
+
+STEST(t_finfo)
+{
+	SSTART;
+	RUN(t_finfo_stat);
+	RUN(t_finfo_get);
+	RUN(t_finfo_track);
+	RUN(t_finfo_max);
+	RUN(t_finfo_batch);
+	SEND;
+}
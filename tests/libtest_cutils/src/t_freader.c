@@ -0,0 +1,235 @@
+#include "freader.h"
+
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+#include "test_util.h"
+
+#include <string.h>
+
+#define TEST_FILE "t_freader.txt"
+
+TEST(t_freader_init_free)
+{
+	START;
+
+	freader_t reader = { 0 };
+
+	EXPECT_EQ(freader_init(NULL, 0, NULL, NULL), NULL);
+	EXPECT_EQ(freader_init(&reader, 0, NULL, NULL), NULL);
+	mem_oom(1);
+	EXPECT_EQ(freader_init(&reader, 8, NULL, NULL), NULL);
+	mem_oom(0);
+	EXPECT_EQ(freader_init(&reader, 8, NULL, NULL), &reader);
+
+	freader_free(&reader);
+	freader_free(NULL);
+
+	EXPECT_EQ(reader.bufs[0], NULL);
+	EXPECT_EQ(reader.bufs[1], NULL);
+
+	END;
+}
+
+TEST(t_freader_open)
+{
+	START;
+
+	freader_t reader = { 0 };
+
+	test_write_file(TEST_FILE, "Test");
+
+	EXPECT_EQ(freader_open(NULL, NULL, 0), NULL);
+	EXPECT_EQ(freader_open(&reader, NULL, 8), NULL);
+	EXPECT_EQ(freader_open(&reader, "not.txt", 8), NULL);
+	EXPECT_EQ(freader_open(&reader, TEST_FILE, 0), NULL);
+	EXPECT_EQ(freader_open(&reader, TEST_FILE, 8), &reader);
+
+	EXPECT_EQ(freader_advise(NULL, FREADER_ADVICE_SEQUENTIAL), 1);
+	EXPECT_EQ(freader_advise(&reader, FREADER_ADVICE_SEQUENTIAL), 0);
+	EXPECT_EQ(freader_advise(&reader, FREADER_ADVICE_DONTNEED), 0);
+
+	freader_free(&reader);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_freader_read)
+{
+	START;
+
+	freader_t reader = { 0 };
+
+	test_write_file(TEST_FILE, "0123456789abcdefghij");
+	freader_open(&reader, TEST_FILE, 4);
+
+	char data[32] = { 0 };
+
+	EXPECT_EQ(freader_read(NULL, NULL, 0), 0);
+	EXPECT_EQ(freader_read(&reader, NULL, 0), 0);
+	EXPECT_EQ(freader_read(&reader, data, 3), 3);
+	EXPECT_STRN(data, "012", 3);
+	EXPECT_EQ(freader_read(&reader, data, 10), 10);
+	EXPECT_STRN(data, "3456789abc", 10);
+	EXPECT_EQ(freader_read(&reader, data, sizeof(data)), 7);
+	EXPECT_STRN(data, "defghij", 7);
+	EXPECT_EQ(freader_read(&reader, data, sizeof(data)), 0);
+
+	freader_free(&reader);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_freader_chunk)
+{
+	START;
+
+	freader_t reader = { 0 };
+
+	test_write_file(TEST_FILE, "0123456789");
+	freader_open(&reader, TEST_FILE, 4);
+
+	str_t chunk = { 0 };
+
+	EXPECT_EQ(freader_chunk(NULL, NULL), 1);
+	EXPECT_EQ(freader_chunk(&reader, NULL), 1);
+	EXPECT_EQ(freader_chunk(&reader, &chunk), 0);
+	EXPECT_EQ(str_eqc(chunk, "0123", 4), 1);
+	EXPECT_EQ(freader_chunk(&reader, &chunk), 0);
+	EXPECT_EQ(str_eqc(chunk, "4567", 4), 1);
+	EXPECT_EQ(freader_chunk(&reader, &chunk), 0);
+	EXPECT_EQ(str_eqc(chunk, "89", 2), 1);
+	EXPECT_EQ(freader_chunk(&reader, &chunk), 1);
+
+	freader_free(&reader);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_freader_line)
+{
+	START;
+
+	freader_t reader = { 0 };
+
+	test_write_file(TEST_FILE, "ab\r\ncde\n\nfghijklmn\nop");
+	freader_open(&reader, TEST_FILE, 4);
+	freader_advise(&reader, FREADER_ADVICE_SEQUENTIAL);
+
+	str_t line = { 0 };
+
+	EXPECT_EQ(freader_line(NULL, NULL), 1);
+	EXPECT_EQ(freader_line(&reader, &line), 0);
+	EXPECT_EQ(str_eqc(line, "ab", 2), 1);
+	EXPECT_EQ(freader_line(&reader, &line), 0);
+	EXPECT_EQ(str_eqc(line, "cde", 3), 1);
+	EXPECT_EQ(freader_line(&reader, &line), 0);
+	EXPECT_EQ(line.len, 0);
+	EXPECT_EQ(freader_line(&reader, &line), 0);
+	EXPECT_EQ(str_eqc(line, "fghijklmn", 9), 1);
+	EXPECT_EQ(freader_line(&reader, &line), 0);
+	EXPECT_EQ(str_eqc(line, "op", 2), 1);
+	EXPECT_EQ(freader_line(&reader, &line), 1);
+
+	freader_free(&reader);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_freader_record_long)
+{
+	START;
+
+	freader_t reader = { 0 };
+
+	test_write_file(TEST_FILE, "abcdefghijklmnopqrstuvwxyz,ab");
+	freader_open(&reader, TEST_FILE, 4);
+
+	str_t rec = { 0 };
+
+	mem_oom(1);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 1);
+	mem_oom(0);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(str_eqc(rec, "abcdefghijklmnopqrstuvwxyz", 26), 1);
+	EXPECT_EQ(reader.size, 32);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(str_eqc(rec, "ab", 2), 1);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 1);
+
+	freader_free(&reader);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+typedef struct refill_s {
+	const char *data;
+	size_t len;
+	size_t off;
+} refill_t;
+
+static size_t refill_cb(void *priv, char *data, size_t size)
+{
+	refill_t *src = priv;
+
+	size_t len = src->len - src->off;
+	if (len > size) {
+		len = size;
+	}
+	if (len > 3) {
+		len = 3;
+	}
+
+	memcpy(data, src->data + src->off, len);
+	src->off += len;
+	return len;
+}
+
+TEST(t_freader_record_refill)
+{
+	START;
+
+	refill_t src = {
+		.data = "a,bc,,defgh,i",
+		.len  = 13,
+	};
+
+	freader_t reader = { 0 };
+	freader_init(&reader, 8, refill_cb, &src);
+
+	str_t rec = { 0 };
+
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(str_eqc(rec, "a", 1), 1);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(str_eqc(rec, "bc", 2), 1);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(rec.len, 0);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(str_eqc(rec, "defgh", 5), 1);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 0);
+	EXPECT_EQ(str_eqc(rec, "i", 1), 1);
+	EXPECT_EQ(freader_record(&reader, ',', &rec), 1);
+
+	freader_free(&reader);
+
+	END;
+}
+
+STEST(t_freader)
+{
+	SSTART;
+	RUN(t_freader_init_free);
+	RUN(t_freader_open);
+	RUN(t_freader_read);
+	RUN(t_freader_chunk);
+	RUN(t_freader_line);
+	RUN(t_freader_record_long);
+	RUN(t_freader_record_refill);
+	SEND;
+}
@@ -0,0 +1,158 @@
+#if !defined(_WIN32)
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fsink.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "finfo.h"
+#include "print.h"
+#include "test.h"
+
+#if defined(C_LINUX)
+	#include <sys/stat.h>
+#endif
+
+#define TEST_FILE "t_fsink.txt"
+
+TEST(t_fsink_open_close)
+{
+	START;
+
+	fsink_t sink = { 0 };
+
+	EXPECT_EQ(fsink_open(NULL, NULL, NULL), NULL);
+	EXPECT_EQ(fsink_open(&sink, NULL, NULL), NULL);
+	EXPECT_EQ(fsink_close(NULL), 1);
+	EXPECT_EQ(fsink_close(&sink), 1);
+
+	EXPECT_NE(fsink_open(&sink, TEST_FILE, NULL), NULL);
+	EXPECT_EQ(fsink_close(&sink), 0);
+	EXPECT_EQ(fsink_close(&sink), 1);
+
+	EXPECT_EQ(file_exists(TEST_FILE), 1);
+
+	file_delete(TEST_FILE);
+
+	FILE *file = fsink_open(&sink, TEST_FILE, NULL);
+	c_fprintf(file, "Test");
+	fsink_abort(&sink);
+	fsink_abort(&sink);
+	fsink_abort(NULL);
+	EXPECT_EQ(file_exists(TEST_FILE), 0);
+
+	END;
+}
+
+TEST(t_fsink_write_skip)
+{
+	START;
+
+	fsink_t sink	    = { 0 };
+	fsink_stats_t stats = { 0 };
+
+	FILE *file = fsink_open(&sink, TEST_FILE, &stats);
+	c_fprintf(file, "Test %d", 1);
+	EXPECT_EQ(fsink_close(&sink), 0);
+	EXPECT_EQ(stats.written, 1);
+	EXPECT_EQ(stats.skipped, 0);
+
+	finfo_t before = { 0 };
+	finfo_stat(TEST_FILE, &before);
+
+	file = fsink_open(&sink, TEST_FILE, &stats);
+	dprintf(PRINT_DST_FILE(file), "Test %d", 1);
+	EXPECT_EQ(fsink_close(&sink), 0);
+	EXPECT_EQ(stats.written, 1);
+	EXPECT_EQ(stats.skipped, 1);
+
+	finfo_t after = { 0 };
+	finfo_stat(TEST_FILE, &after);
+	EXPECT_EQ(before.mtime, after.mtime);
+
+	file = fsink_open(&sink, TEST_FILE, &stats);
+	c_fprintf(file, "Test %d", 2);
+	EXPECT_EQ(fsink_close(&sink), 0);
+	EXPECT_EQ(stats.written, 2);
+	EXPECT_EQ(stats.skipped, 1);
+
+	char data[16] = { 0 };
+	EXPECT_EQ(file_read_t(TEST_FILE, data, sizeof(data)), 6);
+	EXPECT_STR(data, "Test 2");
+
+	fsink_open(&sink, TEST_FILE, &stats);
+	EXPECT_EQ(fsink_close(&sink), 0);
+	EXPECT_EQ(stats.written, 3);
+	EXPECT_EQ(file_exists("t_fsink.txt.tmp"), 0);
+
+	fsink_open(&sink, TEST_FILE, &stats);
+	EXPECT_EQ(fsink_close(&sink), 0);
+	EXPECT_EQ(stats.skipped, 2);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+static int count_cb(path_t *path, const char *folder, void *priv)
+{
+	(void)path;
+	(void)folder;
+	(*(int *)priv)++;
+	return 0;
+}
+
+TEST(t_fsink_atomic)
+{
+	START;
+
+	folder_create("t_fsink");
+
+	fsink_t sink = { 0 };
+
+	FILE *file = fsink_open(&sink, "t_fsink/a.txt", NULL);
+	c_fprintf(file, "Test %d", 1);
+	EXPECT_EQ(fsink_close(&sink), 0);
+
+#if defined(C_LINUX)
+	chmod("t_fsink/a.txt", 0640);
+#endif
+
+	file = fsink_open(&sink, "t_fsink/a.txt", NULL);
+	c_fprintf(file, "Test %d", 2);
+	EXPECT_EQ(fsink_close(&sink), 0);
+
+#if defined(C_LINUX)
+	struct stat st;
+	EXPECT_EQ(stat("t_fsink/a.txt", &st), 0);
+	EXPECT_EQ(st.st_mode & 0777, 0640);
+#endif
+
+	char data[16] = { 0 };
+	EXPECT_EQ(file_read_t("t_fsink/a.txt", data, sizeof(data)), 6);
+	EXPECT_STR(data, "Test 2");
+
+	int cnt = 0;
+	path_t path;
+	path_init(&path, CSTR("t_fsink"));
+	files_foreach(&path, NULL, count_cb, &cnt);
+	EXPECT_EQ(cnt, 1);
+
+	EXPECT_NE(fsink_open(&sink, "t_fsink/missing/a.txt", NULL), NULL);
+	EXPECT_EQ(fsink_close(&sink), 1);
+
+	file_delete("t_fsink/a.txt");
+	folder_delete("t_fsink");
+
+	END;
+}
+
+STEST(t_fsink)
+{
+	SSTART;
+	RUN(t_fsink_open_close);
+	RUN(t_fsink_write_skip);
+	RUN(t_fsink_atomic);
+	SEND;
+}
@@ -0,0 +1,288 @@
+#if !defined(_WIN32)
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fwalk.h"
+
+#include "cstr.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+#include "thread.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(C_LINUX)
+	#include <unistd.h>
+#endif
+
+typedef struct names_s {
+	char buf[256];
+	size_t len;
+	const char *prune;
+} names_t;
+
+static int names_cb(path_t *path, const char *name, void *priv)
+{
+	(void)path;
+
+	names_t *names	 = priv;
+	const size_t len = strlen(name);
+
+	mem_cpy(names->buf + names->len, sizeof(names->buf) - names->len, name, len);
+	names->len += len;
+	names->buf[names->len++] = ',';
+	names->buf[names->len]	 = '\0';
+
+	return names->prune && strcmp(name, names->prune) == 0 ? 1 : 0;
+}
+
+typedef struct cnt_s {
+	mutex_t lock;
+	int folders;
+	int files;
+} cnt_t;
+
+static int folder_cnt_cb(path_t *path, const char *folder, void *priv)
+{
+	(void)path;
+	(void)folder;
+
+	cnt_t *cnt = priv;
+	mutex_lock(&cnt->lock);
+	cnt->folders++;
+	mutex_unlock(&cnt->lock);
+	return 0;
+}
+
+static int file_cnt_cb(path_t *path, const char *file, void *priv)
+{
+	cnt_t *cnt = priv;
+	mutex_lock(&cnt->lock);
+	cnt->files++;
+	mutex_unlock(&cnt->lock);
+	return path->len > 0 && strcmp(path->path + path->len - cstr_len(file), file) == 0 ? 0 : -1;
+}
+
+static int err_cb(path_t *path, const char *name, void *priv)
+{
+	(void)path;
+	(void)name;
+	(void)priv;
+	return -1;
+}
+
+static void create_tree()
+{
+	folder_create("t_fwalk");
+	folder_create("t_fwalk/a");
+	folder_create("t_fwalk/b");
+	folder_create("t_fwalk/b/c");
+
+	file_close(file_open("t_fwalk/a/x.txt", "w"));
+	file_close(file_open("t_fwalk/b/c/y.txt", "w"));
+	file_close(file_open("t_fwalk/d.txt", "w"));
+}
+
+static void delete_tree()
+{
+	file_delete("t_fwalk/d.txt");
+	file_delete("t_fwalk/b/c/y.txt");
+	file_delete("t_fwalk/a/x.txt");
+
+	folder_delete("t_fwalk/b/c");
+	folder_delete("t_fwalk/b");
+	folder_delete("t_fwalk/a");
+	folder_delete("t_fwalk");
+}
+
+TEST(t_fwalk_args)
+{
+	START;
+
+	path_t not = { 0 };
+	path_init(&not, CSTR("not"));
+
+	EXPECT_EQ(fwalk(NULL, 0, 0, NULL, NULL, NULL, NULL), 1);
+	EXPECT_EQ(fwalk(&not, 1, 0, NULL, NULL, NULL, NULL), 1);
+
+	END;
+}
+
+TEST(t_fwalk_threads)
+{
+	START;
+
+	path_t path = { 0 };
+	path_init(&path, CSTR("t_fwalk"));
+
+	create_tree();
+
+	cnt_t cnt = { 0 };
+	mutex_init(&cnt.lock);
+
+	EXPECT_EQ(fwalk(&path, 4, 0, NULL, folder_cnt_cb, file_cnt_cb, &cnt), 0);
+	EXPECT_EQ(cnt.folders, 3);
+	EXPECT_EQ(cnt.files, 3);
+
+	cnt.folders = 0;
+	cnt.files   = 0;
+	EXPECT_EQ(fwalk(&path, 0, 0, NULL, NULL, file_cnt_cb, &cnt), 0);
+	EXPECT_EQ(cnt.folders, 0);
+	EXPECT_EQ(cnt.files, 3);
+
+	EXPECT_EQ(fwalk(&path, 4, 0, NULL, err_cb, NULL, NULL), -1);
+	EXPECT_EQ(fwalk(&path, 4, 0, NULL, NULL, err_cb, NULL), -1);
+
+	mutex_free(&cnt.lock);
+	delete_tree();
+
+	END;
+}
+
+TEST(t_fwalk_sort)
+{
+	START;
+
+	path_t path = { 0 };
+	path_init(&path, CSTR("t_fwalk/"));
+
+	create_tree();
+
+	names_t names = { 0 };
+	EXPECT_EQ(fwalk(&path, 4, FWALK_SORT, NULL, names_cb, names_cb, &names), 0);
+	EXPECT_STR(names.buf, "a,x.txt,b,c,y.txt,d.txt,");
+
+	names.len   = 0;
+	names.prune = "b";
+	EXPECT_EQ(fwalk(&path, 1, FWALK_SORT, NULL, names_cb, names_cb, &names), 0);
+	EXPECT_STR(names.buf, "a,x.txt,b,d.txt,");
+
+	names.len   = 0;
+	names.prune = "a";
+	EXPECT_EQ(fwalk(&path, 1, 0, NULL, names_cb, NULL, &names), 0);
+	EXPECT_EQ(strstr(names.buf, "a,") != NULL, 1);
+	EXPECT_EQ(strstr(names.buf, "c,") != NULL, 1);
+
+	EXPECT_EQ(fwalk(&path, 2, FWALK_SORT, NULL, NULL, err_cb, NULL), -1);
+
+	delete_tree();
+
+	END;
+}
+
+TEST(t_fwalk_ignore)
+{
+	START;
+
+	path_t path = { 0 };
+	path_init(&path, CSTR("t_fwalk"));
+
+	create_tree();
+
+	fglob_t ignore = { 0 };
+	fglob_init(&ignore);
+	fglob_add(&ignore, CSTR("b/"));
+	fglob_add(&ignore, CSTR("*.txt"));
+	fglob_add(&ignore, CSTR("!/a/x.txt"));
+
+	names_t names = { 0 };
+	EXPECT_EQ(fwalk(&path, 2, FWALK_SORT, &ignore, names_cb, names_cb, &names), 0);
+	EXPECT_STR(names.buf, "a,x.txt,");
+
+	fglob_free(&ignore);
+	delete_tree();
+
+	END;
+}
+
+typedef struct order_s {
+	char last[128];
+	int cnt;
+	int sorted;
+} order_t;
+
+static int order_cb(path_t *path, const char *name, void *priv)
+{
+	(void)path;
+
+	order_t *order = priv;
+	if (strcmp(name, order->last) <= 0) {
+		order->sorted = 0;
+	}
+
+	strcpy(order->last, name);
+	order->cnt++;
+	return 0;
+}
+
+TEST(t_fwalk_large)
+{
+	START;
+
+	folder_create("t_fwalk");
+
+	char name[128] = { 0 };
+	for (int i = 0; i < 400; i++) {
+		snprintf(name, sizeof(name), "t_fwalk/file_with_a_rather_long_name_to_fill_chunks_%03d.txt", i);
+		file_close(file_open(name, "w"));
+	}
+
+	path_t path = { 0 };
+	path_init(&path, CSTR("t_fwalk"));
+
+	order_t order = { .sorted = 1 };
+	EXPECT_EQ(fwalk(&path, 4, FWALK_SORT, NULL, NULL, order_cb, &order), 0);
+	EXPECT_EQ(order.cnt, 400);
+	EXPECT_EQ(order.sorted, 1);
+
+	order = (order_t){ 0 };
+	EXPECT_EQ(fwalk(&path, 1, 0, NULL, NULL, order_cb, &order), 0);
+	EXPECT_EQ(order.cnt, 400);
+
+	for (int i = 0; i < 400; i++) {
+		snprintf(name, sizeof(name), "t_fwalk/file_with_a_rather_long_name_to_fill_chunks_%03d.txt", i);
+		file_delete(name);
+	}
+	folder_delete("t_fwalk");
+
+	END;
+}
+
+TEST(t_fwalk_symlink)
+{
+	START;
+
+#if defined(C_LINUX)
+	create_tree();
+
+	EXPECT_EQ(symlink("a", "t_fwalk/l"), 0);
+	EXPECT_EQ(symlink("d.txt", "t_fwalk/m.txt"), 0);
+
+	path_t path = { 0 };
+	path_init(&path, CSTR("t_fwalk"));
+
+	names_t names = { 0 };
+	EXPECT_EQ(fwalk(&path, 2, FWALK_SORT, NULL, names_cb, names_cb, &names), 0);
+	EXPECT_STR(names.buf, "a,x.txt,b,c,y.txt,d.txt,");
+
+	unlink("t_fwalk/m.txt");
+	unlink("t_fwalk/l");
+	delete_tree();
+#endif
+
+	END;
+}
+
+STEST(t_fwalk)
+{
+	SSTART;
+	RUN(t_fwalk_args);
+	RUN(t_fwalk_threads);
+	RUN(t_fwalk_sort);
+	RUN(t_fwalk_ignore);
+	RUN(t_fwalk_large);
+	RUN(t_fwalk_symlink);
+	SEND;
+}
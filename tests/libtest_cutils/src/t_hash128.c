@@ -0,0 +1,84 @@
+#include "hash128.h"
+
+#include "cstr.h"
+#include "digest.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#define TEST_FILE "t_hash128.txt"
+
+static void hash128_hex(const char *data, size_t len, char *out, size_t out_size)
+{
+	hash128_t ctx;
+	byte digest[16] = { 0 };
+
+	hash128_init(&ctx);
+	hash128_update(&ctx, data, len);
+	hash128_final(&ctx, digest);
+	digest_hex(digest, sizeof(digest), out, out_size);
+}
+
+TEST(t_hash128_update)
+{
+	START;
+
+	hash128_t ctx;
+	char out[33] = { 0 };
+
+	EXPECT_EQ(hash128_init(NULL), NULL);
+	hash128_update(NULL, NULL, 0);
+	hash128_final(NULL, NULL);
+
+	hash128_hex(CSTR(""), out, sizeof(out));
+	EXPECT_STR(out, "00000000000000000000000000000000");
+	hash128_hex(CSTR("hello"), out, sizeof(out));
+	EXPECT_STR(out, "029bbd41b3a7d8cb191dae486a901e5b");
+	hash128_hex(CSTR("The quick brown fox jumps over the lazy dog"), out, sizeof(out));
+	EXPECT_STR(out, "6c1b07bc7bbc4be347939ac4a93c437a");
+
+	const char *msg = "The quick brown fox jumps over the lazy dog";
+
+	byte digest[16] = { 0 };
+	hash128_init(&ctx);
+	for (size_t i = 0; i < cstr_len(msg); i += 5) {
+		hash128_update(&ctx, msg + i, cstr_len(msg) - i < 5 ? cstr_len(msg) - i : 5);
+	}
+	hash128_final(&ctx, digest);
+	digest_hex(digest, sizeof(digest), out, sizeof(out));
+	EXPECT_STR(out, "6c1b07bc7bbc4be347939ac4a93c437a");
+
+	END;
+}
+
+TEST(t_hash128_file)
+{
+	START;
+
+	byte digest[16] = { 0 };
+	char out[33]	= { 0 };
+
+	EXPECT_EQ(hash128_file(NULL, NULL), 1);
+	EXPECT_EQ(hash128_file(TEST_FILE, NULL), 1);
+	EXPECT_EQ(hash128_file(TEST_FILE, digest), 1);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fprintf(file, "hello");
+	file_close(file);
+
+	EXPECT_EQ(hash128_file(TEST_FILE, digest), 0);
+	digest_hex(digest, sizeof(digest), out, sizeof(out));
+	EXPECT_STR(out, "029bbd41b3a7d8cb191dae486a901e5b");
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+STEST(t_hash128)
+{
+	SSTART;
+	RUN(t_hash128_update);
+	RUN(t_hash128_file);
+	SEND;
+}
@@ -46,6 +46,227 @@ TEST(t_json_add_val)
 	END;
 }
 
+TEST(t_json_arena)
+{
+	START;
+
+	json_t json = { 0 };
+
+	EXPECT_EQ(json_init_arena(NULL, 1, 64), NULL);
+	EXPECT_EQ(json_init_arena(&json, 1, 0), NULL);
+	EXPECT_EQ(json_init_arena(&json, 1, 64), &json);
+
+	EXPECT_EQ(json_strn(NULL, CSTR("a")).data, NULL);
+	EXPECT_EQ(json_strz(NULL, 4).data, NULL);
+
+	const str_t str = json_strn(&json, CSTR("abc"));
+	EXPECT_EQ(str.ref, 1);
+	EXPECT_STRN(str.data, "abc", str.len);
+
+	const str_t buf = json_strz(&json, 8);
+	EXPECT_EQ(buf.ref, 1);
+	EXPECT_EQ(buf.size, 8);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	const json_val_t val  = json_add_val(&json, root, STRH("name"), JSON_STR(STRH("value")));
+	json_add_val(&json, root, STR("ref"), JSON_STR(str));
+
+	json_mem_t *mem = list_get_data(&json.values, val);
+	EXPECT_EQ(mem->name.ref, 1);
+	EXPECT_STRN(mem->name.data, "name", mem->name.len);
+	EXPECT_EQ(mem->value.val.s.ref, 1);
+	EXPECT_STRN(mem->value.val.s.data, "value", mem->value.val.s.len);
+
+	char out[64] = { 0 };
+	json_print(&json, root, PRINT_DST_BUF(out, sizeof(out), 0), NULL);
+	EXPECT_STR(out, "{\"name\":\"value\",\"ref\":\"abc\"}");
+
+	json_free(&json);
+	EXPECT_EQ(json.values.data, NULL);
+	EXPECT_EQ(json.arena.chunks, NULL);
+
+	json_init_arena(&json, 1, 64);
+	str_t name  = STRH("name");
+	str_t value = STRH("value");
+	mem_oom(1);
+	EXPECT_EQ(json_add_val(&json, JSON_END, name, JSON_STR(value)), JSON_END);
+	mem_oom(0);
+	str_free(&name);
+	str_free(&value);
+	json_free(&json);
+
+	json_init(&json, 1);
+	const str_t heap = json_strn(&json, CSTR("heap"));
+	EXPECT_EQ(heap.ref, 0);
+	json_add_val(&json, JSON_END, str_null(), JSON_STR(heap));
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_add_val_next)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 1);
+
+	EXPECT_EQ(json_add_val_next(NULL, JSON_END, JSON_END, str_null(), JSON_INT(0)), JSON_END);
+
+	const json_val_t root = json_add_val_next(&json, JSON_END, JSON_END, str_null(), JSON_ARR());
+	const json_val_t num  = json_add_val_next(&json, root, JSON_END, str_null(), JSON_INT(0));
+	EXPECT_EQ(json_add_val_next(&json, num, JSON_END, str_null(), JSON_INT(0)), JSON_END);
+	EXPECT_EQ(json_add_val_next(&json, 100, JSON_END, str_null(), JSON_INT(0)), JSON_END);
+
+	json_val_t last = num;
+	for (int i = 1; i < 4; i++) {
+		last = json_add_val_next(&json, root, last, str_null(), JSON_INT(i));
+	}
+
+	char buf[32] = { 0 };
+	json_print(&json, root, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL);
+	EXPECT_STR(buf, "[0,1,2,3]");
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_copy)
+{
+	START;
+
+	json_t src = { 0 };
+	json_init(&src, 1);
+
+	const json_val_t root = json_add_val(&src, JSON_END, str_null(), JSON_OBJ());
+	json_add_val(&src, root, STR("a"), JSON_INT(1));
+	const json_val_t sub = json_add_val(&src, root, STRH("sub"), JSON_OBJ());
+	json_add_val(&src, sub, STR("s"), JSON_STR(STR("ref")));
+	const json_val_t arr = json_add_val(&src, sub, STRH("arr"), JSON_ARR());
+	json_add_val(&src, arr, str_null(), JSON_STR(STRH("heap")));
+	json_add_val(&src, arr, str_null(), JSON_OBJ());
+	json_add_val(&src, arr, str_null(), JSON_ARR());
+	json_add_val(&src, arr, str_null(), JSON_NULL());
+
+	json_t dst = { 0 };
+	json_init_arena(&dst, 1, 64);
+
+	EXPECT_EQ(json_copy(NULL, JSON_END, &src, sub), JSON_END);
+	EXPECT_EQ(json_copy(&dst, JSON_END, NULL, sub), JSON_END);
+	EXPECT_EQ(json_copy(&src, JSON_END, &src, sub), JSON_END);
+	EXPECT_EQ(json_copy(&dst, JSON_END, &src, JSON_END), JSON_END);
+
+	char exp[128] = { 0 };
+	json_print(&src, sub, PRINT_DST_BUF(exp, sizeof(exp), 0), "\t");
+
+	const json_val_t copy = json_copy(&dst, JSON_END, &src, sub);
+	EXPECT_NE(copy, JSON_END);
+	EXPECT_EQ(json_copy(&dst, copy, &src, JSON_END), JSON_END);
+
+	const json_val_t dst_arr = json_get(&dst, copy, CSTR("arr"));
+	EXPECT_EQ(json_copy(&dst, json_get_at(&dst, dst_arr, 3), &src, root), JSON_END);
+	EXPECT_NE(json_copy(&dst, dst_arr, &src, json_get(&src, root, CSTR("a"))), JSON_END);
+
+	json_free(&src);
+
+	char buf[128] = { 0 };
+	json_print(&dst, copy, PRINT_DST_BUF(buf, sizeof(buf), 0), "\t");
+	EXPECT_STR(buf, "{\n"
+			"\t\"s\": \"ref\",\n"
+			"\t\"arr\": [\n"
+			"\t\t\"heap\",\n"
+			"\t\t{},\n"
+			"\t\t[],\n"
+			"\t\tnull,\n"
+			"\t\t1\n"
+			"\t]\n"
+			"}");
+
+	json_free(&dst);
+
+	END;
+}
+
+TEST(t_json_get)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 8);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	const json_val_t a    = json_add_val(&json, root, STRH("a"), JSON_INT(1));
+	const json_val_t arr  = json_add_val(&json, root, STRH("arr"), JSON_ARR());
+	const json_val_t num  = json_add_val(&json, arr, str_null(), JSON_INT(2));
+	const json_val_t obj  = json_add_val(&json, arr, str_null(), JSON_OBJ());
+	const json_val_t b    = json_add_val(&json, obj, STRH("b/~"), JSON_INT(3));
+	json_add_val(&json, root, STRH("a"), JSON_INT(4));
+
+	EXPECT_EQ(json_get(NULL, JSON_END, NULL, 0), JSON_END);
+	EXPECT_EQ(json_get(&json, a, CSTR("a")), JSON_END);
+	EXPECT_EQ(json_get(&json, root, CSTR("c")), JSON_END);
+	EXPECT_EQ(json_get(&json, root, CSTR("a")), a);
+	EXPECT_EQ(json_get(&json, root, CSTR("arr")), arr);
+
+	EXPECT_EQ(json_get_at(NULL, JSON_END, 0), JSON_END);
+	EXPECT_EQ(json_get_at(&json, root, 0), JSON_END);
+	EXPECT_EQ(json_get_at(&json, arr, 0), num);
+	EXPECT_EQ(json_get_at(&json, arr, 1), obj);
+	EXPECT_EQ(json_get_at(&json, arr, 2), JSON_END);
+
+	EXPECT_EQ(json_pointer(NULL, JSON_END, NULL, 0), JSON_END);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("a")), JSON_END);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("")), root);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/a")), a);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/arr/0")), num);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/arr/1/b~1~0")), b);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/arr/01")), JSON_END);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/arr/2")), JSON_END);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/arr/1/b~2")), JSON_END);
+	EXPECT_EQ(json_pointer(&json, root, CSTR("/a/b")), JSON_END);
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_lookup)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 8);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+
+	char name[16];
+	json_val_t vals[100];
+	for (int i = 0; i < 100; i++) {
+		const int len = snprintf(name, sizeof(name), "key%d", i);
+		vals[i]	      = json_add_val(&json, root, strn(name, len, len + 1), JSON_INT(i));
+	}
+	json_add_val(&json, root, STRH("key0"), JSON_INT(-1));
+
+	json_lookup_t lookup = { 0 };
+
+	EXPECT_EQ(json_lookup_init(NULL, NULL, JSON_END), NULL);
+	EXPECT_EQ(json_lookup_init(&lookup, &json, vals[0]), NULL);
+	EXPECT_EQ(json_lookup_init(&lookup, &json, root), &lookup);
+
+	EXPECT_EQ(json_lookup_get(NULL, NULL, 0), JSON_END);
+	EXPECT_EQ(json_lookup_get(&lookup, CSTR("key")), JSON_END);
+	EXPECT_EQ(json_lookup_get(&lookup, CSTR("key0")), vals[0]);
+	EXPECT_EQ(json_lookup_get(&lookup, CSTR("key99")), vals[99]);
+
+	json_lookup_free(&lookup);
+	json_lookup_free(NULL);
+
+	json_free(&json);
+
+	END;
+}
+
 TEST(t_json_print)
 {
 	START;
@@ -113,11 +334,224 @@ TEST(t_json_print_all)
 	END;
 }
 
+TEST(t_json_print_min)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 1);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	json_add_val(&json, root, STRH("int"), JSON_INT(-2147483647 - 1));
+	json_add_val(&json, root, STRH("float"), JSON_FLOAT(-0.5f));
+	json_add_val(&json, root, STRH("double"), JSON_DOUBLE(-0.0));
+	json_add_val(&json, root, STRH("big"), JSON_DOUBLE(1e20));
+	json_add_val(&json, root, STRH("frac"), JSON_DOUBLE(12345.678));
+	json_add_val(&json, root, STRH("null"), JSON_NULL());
+	const json_val_t arr = json_add_val(&json, root, STRH("arr"), JSON_ARR());
+	json_add_val(&json, arr, str_null(), JSON_OBJ());
+	json_add_val(&json, arr, str_null(), JSON_ARR());
+	json_add_val(&json, arr, str_null(), JSON_BOOL(0));
+
+	char buf[256] = { 0 };
+	EXPECT_EQ(json_print(&json, root, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL), 171);
+	EXPECT_STR(buf, "{\"int\":-2147483648,\"float\":-0.5000000,\"double\":-0.000000000000000,\"big\":100000000000000000000.000000000000000,"
+			"\"frac\":12345.677999999999884,\"null\":null,\"arr\":[{},[],false]}");
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_print_esc)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 1);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	json_add_val(&json, root, STRH("a\"b"), JSON_STR(STRH("quote \" bslash \\ nl \n tab \t ctl \x01 long enough to use the vector path \x1f")));
+
+	char buf[256] = { 0 };
+	json_print(&json, root, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL);
+	EXPECT_STR(buf, "{\"a\\\"b\":\"quote \\\" bslash \\\\ nl \\n tab \\t ctl \\u0001 long enough to use the vector path \\u001f\"}");
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_print_deep)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 1024);
+
+	json_val_t val = json_add_val(&json, JSON_END, str_null(), JSON_ARR());
+	const json_val_t root = val;
+	for (int i = 0; i < 1000; i++) {
+		val = json_add_val(&json, val, str_null(), JSON_ARR());
+	}
+
+	char buf[4096] = { 0 };
+	EXPECT_EQ(json_print(&json, root, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL), 2002);
+	EXPECT_EQ(buf[1000], '[');
+	EXPECT_EQ(buf[1001], ']');
+	EXPECT_EQ(buf[2001], ']');
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_writer)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 1);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	json_add_val(&json, root, STRH("int"), JSON_INT(1));
+	json_add_val(&json, root, STRH("double"), JSON_DOUBLE(3.25));
+	json_add_val(&json, root, STRH("s\"tr"), JSON_STR(STRH("a\nb")));
+	const json_val_t arr = json_add_val(&json, root, STRH("arr"), JSON_ARR());
+	json_add_val(&json, arr, str_null(), JSON_NULL());
+	json_add_val(&json, arr, str_null(), JSON_OBJ());
+	json_add_val(&json, arr, str_null(), JSON_ARR());
+	const json_val_t obj = json_add_val(&json, arr, str_null(), JSON_OBJ());
+	json_add_val(&json, obj, STRH("b"), JSON_BOOL(1));
+
+	const char *indents[] = { "\t", "", NULL };
+
+	for (size_t i = 0; i < sizeof(indents) / sizeof(indents[0]); i++) {
+		char exp[256] = { 0 };
+		const int len = json_print(&json, root, PRINT_DST_BUF(exp, sizeof(exp), 0), indents[i]);
+
+		char buf[256]	     = { 0 };
+		json_writer_t writer = { 0 };
+		EXPECT_EQ(json_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0), indents[i]), &writer);
+		json_write_obj(&writer);
+		json_write_key(&writer, CSTR("int"));
+		json_write_val(&writer, JSON_INT(1));
+		json_write_key(&writer, CSTR("double"));
+		json_write_val(&writer, JSON_DOUBLE(3.25));
+		json_write_key(&writer, CSTR("s\"tr"));
+		json_write_val(&writer, JSON_STR(STR("a\nb")));
+		json_write_key(&writer, CSTR("arr"));
+		json_write_arr(&writer);
+		json_write_val(&writer, JSON_NULL());
+		json_write_obj(&writer);
+		json_write_end(&writer);
+		json_write_val(&writer, JSON_ARR());
+		json_write_end(&writer);
+		json_write_val(&writer, JSON_OBJ());
+		json_write_key(&writer, CSTR("b"));
+		json_write_val(&writer, JSON_BOOL(1));
+		json_write_end(&writer);
+		json_write_end(&writer);
+		json_write_end(&writer);
+		EXPECT_EQ(json_writer_close(&writer), 0);
+
+		EXPECT_EQ(writer.buf.dst.off, len);
+		EXPECT_STR(buf, exp);
+	}
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_writer_invalid)
+{
+	START;
+
+	char buf[64]	     = { 0 };
+	json_writer_t writer = { 0 };
+
+	EXPECT_EQ(json_writer_init(NULL, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL), NULL);
+	EXPECT_EQ(json_writer_close(NULL), 1);
+	EXPECT_EQ(json_write_obj(NULL), 1);
+	EXPECT_EQ(json_write_arr(NULL), 1);
+	EXPECT_EQ(json_write_key(NULL, CSTR("a")), 1);
+	EXPECT_EQ(json_write_val(NULL, JSON_INT(0)), 1);
+	EXPECT_EQ(json_write_end(NULL), 1);
+
+	json_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL);
+	EXPECT_EQ(json_write_key(&writer, CSTR("a")), 1);
+	EXPECT_EQ(json_write_end(&writer), 1);
+	EXPECT_EQ(json_write_obj(&writer), 0);
+	EXPECT_EQ(json_write_val(&writer, JSON_INT(0)), 1);
+	EXPECT_EQ(json_write_key(&writer, NULL, 1), 1);
+	EXPECT_EQ(json_write_key(&writer, CSTR("a")), 0);
+	EXPECT_EQ(json_write_key(&writer, CSTR("b")), 1);
+	EXPECT_EQ(json_write_end(&writer), 1);
+	EXPECT_EQ(json_write_val(&writer, (json_val_data_t){ .type = -1 }), 1);
+	EXPECT_EQ(json_write_arr(&writer), 0);
+	EXPECT_EQ(json_write_key(&writer, CSTR("c")), 1);
+	EXPECT_EQ(json_write_val(&writer, JSON_INT(2)), 0);
+	EXPECT_EQ(json_write_end(&writer), 0);
+	EXPECT_EQ(json_writer_close(&writer), 1);
+	EXPECT_STR(buf, "{\"a\":[2]");
+
+	json_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL);
+	EXPECT_EQ(json_write_val(&writer, JSON_INT(1)), 0);
+	EXPECT_EQ(json_write_val(&writer, JSON_INT(2)), 1);
+	EXPECT_EQ(json_write_arr(&writer), 1);
+	EXPECT_EQ(json_writer_close(&writer), 0);
+	EXPECT_STR(buf, "1");
+
+	json_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0), NULL);
+	for (int i = 0; i < JSON_MAX_DEPTH; i++) {
+		json_write_arr(&writer);
+	}
+	EXPECT_EQ(json_write_arr(&writer), 1);
+	EXPECT_EQ(json_writer_close(&writer), 1);
+
+	END;
+}
+
+TEST(t_json_writer_stream)
+{
+	START;
+
+	const uint cnt	  = 100000;
+	const size_t size = 1024 * 1024;
+
+	char *buf	     = mem_alloc(size);
+	json_writer_t writer = { 0 };
+	json_writer_init(&writer, PRINT_DST_BUF(buf, size, 0), NULL);
+
+	json_write_arr(&writer);
+	for (uint i = 0; i < cnt; i++) {
+		json_write_val(&writer, JSON_INT((int)i));
+	}
+	json_write_end(&writer);
+
+	EXPECT_EQ(writer.buf.data, buf);
+	EXPECT_EQ(json_writer_close(&writer), 0);
+	EXPECT_EQ(writer.buf.dst.off, 588891);
+	EXPECT_STRN(buf, "[0,1,2,", 7);
+	EXPECT_STRN(buf + writer.buf.dst.off - 7, ",99999]", 7);
+
+	mem_free(buf, size);
+
+	END;
+}
+
 TEST(t_json_prints)
 {
 	SSTART;
 	RUN(t_json_print);
 	RUN(t_json_print_all);
+	RUN(t_json_print_min);
+	RUN(t_json_print_esc);
+	RUN(t_json_print_deep);
+	RUN(t_json_writer);
+	RUN(t_json_writer_invalid);
+	RUN(t_json_writer_stream);
 	SEND;
 }
 
@@ -127,6 +561,11 @@ STEST(t_json)
 
 	RUN(t_json_init_free);
 	RUN(t_json_add_val);
+	RUN(t_json_arena);
+	RUN(t_json_add_val_next);
+	RUN(t_json_copy);
+	RUN(t_json_get);
+	RUN(t_json_lookup);
 	RUN(t_json_prints);
 
 	SEND;
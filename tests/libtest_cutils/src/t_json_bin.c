@@ -0,0 +1,227 @@
+#include "json_bin.h"
+
+#include "cstr.h"
+#include "json_parse.h"
+#include "mem.h"
+#include "test.h"
+
+#include <limits.h>
+
+static json_mem_t *get_mem(json_t *json, json_val_t val)
+{
+	return list_get_data(&json->values, val);
+}
+
+TEST(t_json_bin_write)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 8);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	json_add_val(&json, root, STR("min"), JSON_INT(INT_MIN));
+	json_add_val(&json, root, STR("max"), JSON_INT(INT_MAX));
+	json_add_val(&json, root, STR("neg"), JSON_INT(-1));
+	json_add_val(&json, root, STR("float"), JSON_FLOAT(1.25f));
+	json_add_val(&json, root, STR("double"), JSON_DOUBLE(0.1));
+	json_add_val(&json, root, STR("true"), JSON_BOOL(1));
+	json_add_val(&json, root, STR("false"), JSON_BOOL(0));
+	json_add_val(&json, root, STR("null"), JSON_NULL());
+	json_add_val(&json, root, STR(""), JSON_STR(STR("")));
+	const json_val_t arr = json_add_val(&json, root, STR("arr"), JSON_ARR());
+	for (int i = 0; i < 200; i++) {
+		json_add_val(&json, arr, str_null(), JSON_STR(STR("str")));
+	}
+	json_add_val(&json, arr, str_null(), JSON_OBJ());
+	json_add_val(&json, arr, str_null(), JSON_ARR());
+
+	dbuf_t buf = { 0 };
+	dbuf_init(&buf, 16);
+
+	EXPECT_EQ(json_bin_write(NULL, root, &buf), 1);
+	EXPECT_EQ(json_bin_write(&json, root, NULL), 1);
+	EXPECT_EQ(json_bin_write(&json, JSON_END, &buf), 1);
+	EXPECT_EQ(buf.len, 0);
+
+	EXPECT_EQ(json_bin_write(&json, root, &buf), 0);
+
+	json_t load = { 0 };
+	json_init(&load, 8);
+
+	const json_val_t val = json_bin_load(json_bin_root(buf.data, buf.len), &load);
+	EXPECT_NE(val, JSON_END);
+	EXPECT_EQ(load.values.cnt, json.values.cnt);
+
+	EXPECT_EQ(get_mem(&load, json_get(&load, val, CSTR("min")))->value.val.i, INT_MIN);
+	EXPECT_EQ(get_mem(&load, json_get(&load, val, CSTR("max")))->value.val.i, INT_MAX);
+	EXPECT_EQ(get_mem(&load, json_get(&load, val, CSTR("float")))->value.type, JSON_VAL_FLOAT);
+	EXPECT_EQ(get_mem(&load, json_get(&load, val, CSTR("float")))->value.val.f, 1.25f);
+	EXPECT_EQ(get_mem(&load, json_get(&load, val, CSTR("double")))->value.val.d, 0.1);
+
+	const json_mem_t *mem = get_mem(&load, json_get_at(&load, json_get(&load, val, CSTR("arr")), 0));
+	EXPECT_EQ(mem->value.val.s.ref, 1);
+	EXPECT_EQ(mem->value.val.s.data >= buf.data && mem->value.val.s.data < buf.data + buf.len, 1);
+
+	char exp[4096] = { 0 };
+	char act[4096] = { 0 };
+	json_print(&json, root, PRINT_DST_BUF(exp, sizeof(exp), 0), "\t");
+	json_print(&load, val, PRINT_DST_BUF(act, sizeof(act), 0), "\t");
+	EXPECT_STR(act, exp);
+
+	json_free(&load);
+	json_free(&json);
+	dbuf_free(&buf);
+
+	END;
+}
+
+TEST(t_json_bin_ref)
+{
+	START;
+
+	const char data[] = "{\"skip\": {\"x\": [1, {\"y\": 2}]}, \"a/b\": [\"s\", -1, 2.5, true, null, {\"k\": \"v\"}], \"n\": 7}";
+
+	json_t json = { 0 };
+	json_init(&json, 8);
+
+	dbuf_t buf = { 0 };
+	dbuf_init(&buf, 64);
+	json_bin_write(&json, json_parse(&json, CSTR(data)), &buf);
+
+	const json_bin_t root = json_bin_root(buf.data, buf.len);
+	EXPECT_EQ(root.pos, 4);
+	EXPECT_EQ(json_bin_root(NULL, 0).pos, JSON_END);
+	EXPECT_EQ(json_bin_root(buf.data, buf.len - 1).pos, JSON_END);
+	EXPECT_EQ(json_bin_root(buf.data + 1, buf.len - 1).pos, JSON_END);
+
+	EXPECT_EQ(json_bin_get(root, NULL, 0).pos, JSON_END);
+	EXPECT_EQ(json_bin_get(root, CSTR("x")).pos, JSON_END);
+
+	int i	 = 0;
+	int b	 = 0;
+	uint cnt = 0;
+	double d = 0;
+	str_t str;
+	json_val_type_t type;
+
+	EXPECT_EQ(json_bin_cnt(root, &cnt), 0);
+	EXPECT_EQ(cnt, 3);
+
+	json_bin_t ref = json_bin_get(root, CSTR("n"));
+	EXPECT_EQ(json_bin_int(ref, &i), 0);
+	EXPECT_EQ(i, 7);
+	EXPECT_EQ(json_bin_str(ref, &str), 1);
+	EXPECT_EQ(json_bin_cnt(ref, &cnt), 1);
+	EXPECT_EQ(json_bin_get(ref, CSTR("n")).pos, JSON_END);
+	EXPECT_EQ(json_bin_at(ref, 0).pos, JSON_END);
+
+	const json_bin_t arr = json_bin_get(root, CSTR("a/b"));
+	EXPECT_EQ(json_bin_type(arr, &type), 0);
+	EXPECT_EQ(type, JSON_VAL_ARR);
+	EXPECT_EQ(json_bin_cnt(arr, &cnt), 0);
+	EXPECT_EQ(cnt, 6);
+
+	EXPECT_EQ(json_bin_str(json_bin_at(arr, 0), &str), 0);
+	EXPECT_STRN(str.data, "s", str.len);
+	EXPECT_EQ(str.data > (const char *)buf.data && str.data < (const char *)buf.data + buf.len, 1);
+	EXPECT_EQ(json_bin_int(json_bin_at(arr, 1), &i), 0);
+	EXPECT_EQ(i, -1);
+	EXPECT_EQ(json_bin_int(json_bin_at(arr, 2), &i), 1);
+	EXPECT_EQ(json_bin_double(json_bin_at(arr, 2), &d), 0);
+	EXPECT_EQ(d, 2.5);
+	EXPECT_EQ(json_bin_double(json_bin_at(arr, 1), &d), 0);
+	EXPECT_EQ(d, -1.0);
+	EXPECT_EQ(json_bin_bool(json_bin_at(arr, 3), &b), 0);
+	EXPECT_EQ(b, 1);
+	EXPECT_EQ(json_bin_bool(json_bin_at(arr, 4), &b), 1);
+	EXPECT_EQ(json_bin_type(json_bin_at(arr, 4), &type), 0);
+	EXPECT_EQ(type, JSON_VAL_NULL);
+	EXPECT_EQ(json_bin_at(arr, 6).pos, JSON_END);
+
+	ref = json_bin_pointer(root, CSTR("/a~1b/5/k"));
+	EXPECT_EQ(json_bin_str(ref, &str), 0);
+	EXPECT_STRN(str.data, "v", str.len);
+	EXPECT_EQ(json_bin_pointer(root, CSTR("/skip/x/1/y")).pos, json_bin_get(json_bin_at(json_bin_pointer(root, CSTR("/skip/x")), 1), CSTR("y")).pos);
+	EXPECT_EQ(json_bin_pointer(root, CSTR("/skip/x/2")).pos, JSON_END);
+	EXPECT_EQ(json_bin_type(json_bin_pointer(root, CSTR("/none")), &type), 1);
+
+	json_t load = { 0 };
+	json_init(&load, 4);
+	EXPECT_EQ(json_bin_load(ref, NULL), JSON_END);
+	EXPECT_EQ(json_bin_load(json_bin_pointer(root, CSTR("/none")), &load), JSON_END);
+
+	const json_val_t val = json_bin_load(json_bin_pointer(root, CSTR("/skip")), &load);
+	EXPECT_NE(val, JSON_END);
+	EXPECT_EQ(load.values.cnt, 5);
+
+	char out[128] = { 0 };
+	json_print(&load, val, PRINT_DST_BUF(out, sizeof(out), 0), NULL);
+	EXPECT_STR(out, "{\"x\":[1,{\"y\":2}]}");
+
+	json_free(&load);
+	json_free(&json);
+	dbuf_free(&buf);
+
+	END;
+}
+
+TEST(t_json_bin_invalid)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 4);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_ARR());
+	json_add_val(&json, root, str_null(), JSON_INT(300));
+	json_add_val(&json, root, str_null(), JSON_STR(STR("abc")));
+
+	dbuf_t buf = { 0 };
+	dbuf_init(&buf, 64);
+	json_bin_write(&json, root, &buf);
+	EXPECT_EQ(buf.len, 4 + 9 + 3 + 5);
+
+	dbuf_t sink = { 0 };
+	char out[8] = { 0 };
+	dbuf_init_dst(&sink, 16, PRINT_DST_BUF(out, sizeof(out), 0));
+	EXPECT_EQ(json_bin_write(&json, root, &sink), 1);
+	dbuf_free(&sink);
+
+	byte data[32];
+	mem_cpy(data, sizeof(data), buf.data, buf.len);
+
+	json_t load = { 0 };
+	json_init(&load, 4);
+
+	data[5]++;
+	EXPECT_EQ(json_bin_root(data, buf.len).pos, JSON_END);
+	data[5]--;
+
+	json_bin_t bin = json_bin_root(data, buf.len);
+	data[9]++;
+	EXPECT_EQ(json_bin_load(bin, &load), JSON_END);
+	data[9]--;
+
+	data[16] = 0xff;
+	EXPECT_EQ(json_bin_str(json_bin_at(bin, 1), NULL), 1);
+	EXPECT_EQ(json_bin_load(bin, &load), JSON_END);
+	data[16] = 0x06;
+
+	EXPECT_NE(json_bin_load(bin, &load), JSON_END);
+
+	json_free(&load);
+	json_free(&json);
+	dbuf_free(&buf);
+
+	END;
+}
+
+STEST(t_json_bin)
+{
+	SSTART;
+	RUN(t_json_bin_write);
+	RUN(t_json_bin_ref);
+	RUN(t_json_bin_invalid);
+	SEND;
+}
@@ -0,0 +1,526 @@
+#include "json_parse.h"
+
+#include "cstr.h"
+#include "mem.h"
+#include "test.h"
+
+static json_mem_t *get_mem(json_t *json, json_val_t val)
+{
+	return list_get_data(&json->values, val);
+}
+
+TEST(t_json_idx)
+{
+	START;
+
+	json_idx_t idx = { 0 };
+
+	EXPECT_EQ(json_idx_init(NULL, NULL, 0), NULL);
+	EXPECT_EQ(json_idx_init(&idx, NULL, 1), NULL);
+	EXPECT_EQ(json_idx_init(&idx, CSTR("\"abc")), NULL);
+
+	const char data[] = "{\"a\\\"\": [1, true, \"x\"]}";
+	EXPECT_EQ(json_idx_init(&idx, CSTR(data)), &idx);
+
+	const uint pos[] = { 0, 1, 5, 6, 8, 9, 10, 12, 16, 18, 20, 21, 22 };
+	EXPECT_EQ(idx.cnt, sizeof(pos) / sizeof(uint));
+	EXPECT_EQ(mem_cmp(idx.pos, pos, sizeof(pos)), 0);
+
+	json_idx_free(&idx);
+	json_idx_free(NULL);
+
+	END;
+}
+
+TEST(t_json_idx_blocks)
+{
+	START;
+
+	char data[256];
+	mem_set(data, ' ', sizeof(data));
+	data[0]	  = '"';
+	data[62]  = '\\';
+	data[63]  = '\\';
+	data[64]  = '\\';
+	data[65]  = '"';
+	data[66]  = '"';
+	data[70]  = '1';
+	data[71]  = '2';
+	data[127] = '3';
+	data[128] = '4';
+
+	json_idx_t idx = { 0 };
+	EXPECT_EQ(json_idx_init(&idx, data, sizeof(data)), &idx);
+	EXPECT_EQ(idx.cnt, 4);
+	EXPECT_EQ(idx.pos[0], 0);
+	EXPECT_EQ(idx.pos[1], 66);
+	EXPECT_EQ(idx.pos[2], 70);
+	EXPECT_EQ(idx.pos[3], 127);
+	json_idx_free(&idx);
+
+	END;
+}
+
+TEST(t_json_parse_vals)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 16);
+
+	EXPECT_EQ(json_parse(NULL, NULL, 0), JSON_END);
+	EXPECT_EQ(json_parse(&json, NULL, 0), JSON_END);
+
+	const char data[] = "{\"int\": -12, \"double\": 2.5e2, \"big\": 12345678901, \"t\": true, \"f\": false, \"n\": null, \"s\": \"str\", \"e\": \"a\\n\\u00e9\\ud83d\\ude00\"}";
+
+	const json_val_t root = json_parse(&json, CSTR(data));
+	EXPECT_NE(root, JSON_END);
+
+	json_mem_t *mem = get_mem(&json, root);
+	EXPECT_EQ(mem->value.type, JSON_VAL_OBJ);
+
+	json_val_t val = mem->value.val.o.values;
+	mem	       = get_mem(&json, val);
+	EXPECT_STRN(mem->name.data, "int", mem->name.len);
+	EXPECT_EQ(mem->value.type, JSON_VAL_INT);
+	EXPECT_EQ(mem->value.val.i, -12);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_DOUBLE);
+	EXPECT_EQ(mem->value.val.d, 250.0);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_DOUBLE);
+	EXPECT_EQ(mem->value.val.d, 12345678901.0);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_BOOL);
+	EXPECT_EQ(mem->value.val.b, 1);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_BOOL);
+	EXPECT_EQ(mem->value.val.b, 0);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_NULL);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_STR);
+	EXPECT_EQ(mem->value.val.s.data, data + 90);
+	EXPECT_EQ(mem->value.val.s.len, 3);
+
+	mem = get_mem(&json, val = list_get_next(&json.values, val));
+	EXPECT_EQ(mem->value.type, JSON_VAL_STR);
+	EXPECT_STR(mem->value.val.s.data, "a\n\xC3\xA9\xF0\x9F\x98\x80");
+
+	EXPECT_EQ(list_get_next(&json.values, val), JSON_END);
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_parse_invalid)
+{
+	START;
+
+	const char *invalid[] = {
+		"",
+		"{",
+		"[1,]",
+		"{\"a\" 1}",
+		"{\"a\": 1,}",
+		"{1: 2}",
+		"[1 2]",
+		"tru",
+		"nul",
+		"01",
+		"1.",
+		"1e",
+		"-",
+		"\"\\x\"",
+		"\"\\u12\"",
+		"\"\\ud83d\"",
+		"[1] 2",
+		"}",
+		"\"a\"b",
+		"\"a\tb\"",
+		"[\"\n\"]",
+		"1e400",
+		"-1e400",
+	};
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		json_t json = { 0 };
+		json_init(&json, 4);
+		EXPECT_EQ(json_parse(&json, invalid[i], cstr_len(invalid[i])), JSON_END);
+		json_free(&json);
+	}
+
+	char deep[JSON_MAX_DEPTH + 1];
+	mem_set(deep, '[', sizeof(deep));
+
+	json_t json = { 0 };
+	json_init(&json, 4);
+	EXPECT_EQ(json_parse(&json, deep, sizeof(deep)), JSON_END);
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_parse_print)
+{
+	START;
+
+	json_t json = { 0 };
+	json_init(&json, 1);
+
+	const json_val_t root = json_add_val(&json, JSON_END, str_null(), JSON_OBJ());
+	json_add_val(&json, root, STRH("int"), JSON_INT(1));
+	json_add_val(&json, root, STRH("double"), JSON_DOUBLE(3.123456789012345));
+	json_add_val(&json, root, STRH("bool"), JSON_BOOL(1));
+	json_add_val(&json, root, STRH("null"), JSON_NULL());
+	json_add_val(&json, root, STRH("str"), JSON_STR(STRH("str")));
+	const json_val_t arr = json_add_val(&json, root, STRH("arr"), JSON_ARR());
+	for (int i = 0; i < 100; i++) {
+		json_add_val(&json, arr, str_null(), JSON_INT(i));
+	}
+	json_add_val(&json, arr, str_null(), JSON_OBJ());
+	json_add_val(&json, arr, str_null(), JSON_ARR());
+	const json_val_t obj = json_add_val(&json, root, STRH("obj"), JSON_OBJ());
+	json_add_val(&json, obj, STRH("int"), JSON_INT(-4));
+
+	char src[2048] = { 0 };
+	const int len  = json_print(&json, root, PRINT_DST_BUF(src, sizeof(src), 0), "\t");
+	json_free(&json);
+
+	json_init(&json, 1);
+	const json_val_t parsed = json_parse(&json, src, (size_t)len);
+	EXPECT_NE(parsed, JSON_END);
+
+	char dst[2048] = { 0 };
+	EXPECT_EQ(json_print(&json, parsed, PRINT_DST_BUF(dst, sizeof(dst), 0), "\t"), len);
+	EXPECT_STR(dst, src);
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_parse_arena)
+{
+	START;
+
+	const char src[] = "{\"k\\u0041\": [\"a\\nb\", \"plain\", 1, {\"x\": null}]}";
+
+	json_t json = { 0 };
+	json_init_arena(&json, 1, 64);
+
+	const json_val_t root = json_parse(&json, src, sizeof(src) - 1);
+	EXPECT_NE(root, JSON_END);
+
+	const json_val_t arr = json_get(&json, root, CSTR("kA"));
+	EXPECT_NE(arr, JSON_END);
+
+	const json_mem_t *mem = list_get_data(&json.values, arr);
+	EXPECT_EQ(mem->name.ref, 1);
+
+	mem = list_get_data(&json.values, json_get_at(&json, arr, 0));
+	EXPECT_EQ(mem->value.val.s.ref, 1);
+	EXPECT_STRN(mem->value.val.s.data, "a\nb", mem->value.val.s.len);
+
+	char dst[128] = { 0 };
+	json_print(&json, root, PRINT_DST_BUF(dst, sizeof(dst), 0), NULL);
+	EXPECT_STR(dst, "{\"kA\":[\"a\\nb\",\"plain\",1,{\"x\":null}]}");
+
+	json_free(&json);
+
+	END;
+}
+
+TEST(t_json_ref)
+{
+	START;
+
+	const char data[] = "{\"skip\": {\"x\": [1, {\"y\": 2}]}, \"a\\/b\": [\"s\", -1, 2.5, true, null, {\"k\": \"v\"}], \"n\": 7}";
+
+	json_idx_t idx = { 0 };
+	json_idx_init(&idx, CSTR(data));
+
+	const json_ref_t root = json_ref_root(&idx);
+	EXPECT_EQ(root.pos, 0);
+	EXPECT_EQ(json_ref_root(NULL).pos, JSON_END);
+
+	EXPECT_EQ(json_ref_get(root, NULL, 0).pos, JSON_END);
+	EXPECT_EQ(json_ref_get(root, CSTR("x")).pos, JSON_END);
+
+	int i	 = 0;
+	int b	 = 0;
+	double d = 0;
+	str_t str;
+	json_val_type_t type;
+
+	json_ref_t ref = json_ref_get(root, CSTR("n"));
+	EXPECT_EQ(json_ref_int(ref, &i), 0);
+	EXPECT_EQ(i, 7);
+	EXPECT_EQ(json_ref_str(ref, &str), 1);
+	EXPECT_EQ(json_ref_get(ref, CSTR("n")).pos, JSON_END);
+	EXPECT_EQ(json_ref_at(ref, 0).pos, JSON_END);
+
+	const json_ref_t arr = json_ref_get(root, CSTR("a/b"));
+	EXPECT_EQ(json_ref_type(arr, &type), 0);
+	EXPECT_EQ(type, JSON_VAL_ARR);
+
+	EXPECT_EQ(json_ref_str(json_ref_at(arr, 0), &str), 0);
+	EXPECT_STRN(str.data, "s", str.len);
+	EXPECT_EQ(json_ref_int(json_ref_at(arr, 1), &i), 0);
+	EXPECT_EQ(i, -1);
+	EXPECT_EQ(json_ref_int(json_ref_at(arr, 2), &i), 1);
+	EXPECT_EQ(json_ref_double(json_ref_at(arr, 2), &d), 0);
+	EXPECT_EQ(d, 2.5);
+	EXPECT_EQ(json_ref_double(json_ref_at(arr, 1), &d), 0);
+	EXPECT_EQ(d, -1.0);
+	EXPECT_EQ(json_ref_bool(json_ref_at(arr, 3), &b), 0);
+	EXPECT_EQ(b, 1);
+	EXPECT_EQ(json_ref_bool(json_ref_at(arr, 4), &b), 1);
+	EXPECT_EQ(json_ref_type(json_ref_at(arr, 4), &type), 0);
+	EXPECT_EQ(type, JSON_VAL_NULL);
+	EXPECT_EQ(json_ref_at(arr, 6).pos, JSON_END);
+
+	ref = json_ref_pointer(root, CSTR("/a~1b/5/k"));
+	EXPECT_EQ(json_ref_str(ref, &str), 0);
+	EXPECT_STRN(str.data, "v", str.len);
+	EXPECT_EQ(json_ref_pointer(root, CSTR("/skip/x/1/y")).pos, json_ref_get(json_ref_at(json_ref_pointer(root, CSTR("/skip/x")), 1), CSTR("y")).pos);
+	EXPECT_EQ(json_ref_pointer(root, CSTR("/skip/x/2")).pos, JSON_END);
+	EXPECT_EQ(json_ref_type(json_ref_pointer(root, CSTR("/none")), &type), 1);
+
+	json_t json = { 0 };
+	json_init(&json, 4);
+	EXPECT_EQ(json_ref_load(ref, NULL), JSON_END);
+	EXPECT_EQ(json_ref_load(json_ref_pointer(root, CSTR("/none")), &json), JSON_END);
+
+	const json_val_t val = json_ref_load(json_ref_pointer(root, CSTR("/skip")), &json);
+	EXPECT_NE(val, JSON_END);
+	EXPECT_EQ(json.values.cnt, 5);
+
+	char buf[128] = { 0 };
+	json_print(&json, val, PRINT_DST_BUF(buf, sizeof(buf), 0), "");
+	EXPECT_STR(buf, "{\n\"x\": [\n1,\n{\n\"y\": 2\n}\n]\n}");
+
+	json_free(&json);
+	json_idx_free(&idx);
+
+	END;
+}
+
+static size_t pull_evts(const char *data, size_t len, size_t chunk, char *evts, size_t size)
+{
+	static const char chars[] = { '-', '{', '}', '[', ']', 'k', 'v', '.', '!' };
+
+	json_pull_t pull;
+	json_pull_init(&pull, 16);
+
+	size_t off = chunk < len ? chunk : len;
+	size_t cnt = 0;
+	json_pull_feed(&pull, data, off, off == len);
+
+	for (;;) {
+		const json_evt_t evt = json_pull_next(&pull);
+		if (evt == JSON_EVT_NONE) {
+			const size_t n = chunk < len - off ? chunk : len - off;
+			json_pull_feed(&pull, data + off, n, off + n == len);
+			off += n;
+			continue;
+		}
+
+		const str_t *str = evt == JSON_EVT_KEY ? &pull.key : evt == JSON_EVT_VAL && pull.val.type == JSON_VAL_STR ? &pull.val.val.s : NULL;
+		if (str && cnt + str->len < size) {
+			mem_cpy(evts + cnt, size - cnt, str->data, str->len);
+			cnt += str->len;
+		}
+
+		if (cnt + 1 < size) {
+			evts[cnt++] = chars[evt];
+		}
+
+		if (evt == JSON_EVT_END || evt == JSON_EVT_ERROR) {
+			break;
+		}
+	}
+
+	evts[cnt] = '\0';
+	json_pull_free(&pull);
+	return cnt;
+}
+
+TEST(t_json_pull)
+{
+	START;
+
+	json_pull_t pull = { 0 };
+
+	EXPECT_EQ(json_pull_init(NULL, 8), NULL);
+	EXPECT_EQ(json_pull_init(&pull, 0), NULL);
+	EXPECT_EQ(json_pull_next(NULL), JSON_EVT_ERROR);
+	EXPECT_EQ(json_pull_keep(NULL, NULL, JSON_END), JSON_END);
+	json_pull_feed(NULL, NULL, 0, 1);
+	json_pull_free(NULL);
+
+	const char data[] = " {\"ab\": [1, -2.5e1, \"x\\\"y\", true, false, null, {}, []], \"\\u0041\": \"\", \"c\": {\"d\": \"long string\"}} ";
+	const char *exp	  = "{abk[vvx\"yvvvv{}[]]Akvck{dklong stringv}}.";
+
+	char evts[128];
+	for (size_t chunk = 1; chunk <= sizeof(data); chunk++) {
+		pull_evts(data, sizeof(data) - 1, chunk, evts, sizeof(evts));
+		EXPECT_STR(evts, exp);
+	}
+
+	pull_evts(CSTR(""), 1, evts, sizeof(evts));
+	EXPECT_STR(evts, ".");
+	pull_evts(CSTR("{\"a\":1}\n[2]\n\"s\"\n3"), 2, evts, sizeof(evts));
+	EXPECT_STR(evts, "{akv}[v]svv.");
+
+	END;
+}
+
+TEST(t_json_pull_invalid)
+{
+	START;
+
+	const char *invalid[] = {
+		"{",
+		"[1,]",
+		"{\"a\" 1}",
+		"{\"a\": 1,}",
+		"{1: 2}",
+		"[1 2]",
+		"[1}",
+		"{\"a\": 1]",
+		"tru",
+		"nul",
+		"01",
+		"1.",
+		"-",
+		"\"\\x\"",
+		"\"abc",
+		"}",
+		"[\"a much too long string\"]",
+		"[12345678901234567]",
+		"{\"a much too long key\": 1}",
+		"\"a\tb\"",
+		"[\"\n\"]",
+		"[1e400]",
+	};
+
+	char evts[128];
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		const size_t len = pull_evts(invalid[i], cstr_len(invalid[i]), 3, evts, sizeof(evts));
+		EXPECT_EQ(evts[len - 1], '!');
+	}
+
+	char deep[JSON_MAX_DEPTH + 1];
+	char deep_evts[JSON_MAX_DEPTH + 2];
+	mem_set(deep, '[', sizeof(deep));
+	const size_t len = pull_evts(deep, sizeof(deep), 64, deep_evts, sizeof(deep_evts));
+	EXPECT_EQ(deep_evts[len - 1], '!');
+
+	json_pull_t pull = { 0 };
+	json_pull_init(&pull, 8);
+	json_pull_feed(&pull, CSTR("[}"), 1);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_ARR_START);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_ERROR);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_ERROR);
+	json_pull_free(&pull);
+
+	END;
+}
+
+TEST(t_json_pull_keep)
+{
+	START;
+
+	const char data[] = "{\"skip\": [1, 2], \"keep\": {\"a\": [true, {\"b\": \"s\"}], \"c\": null}, \"n\": 5, \"after\": 1}";
+
+	json_t json = { 0 };
+	json_init(&json, 4);
+
+	json_pull_t pull = { 0 };
+	json_pull_init(&pull, 8);
+
+	json_val_t keep = JSON_END;
+	json_val_t n	= JSON_END;
+
+	for (size_t off = 0; off < sizeof(data) - 1; off += 5) {
+		const size_t len = sizeof(data) - 1 - off < 5 ? sizeof(data) - 1 - off : 5;
+		json_pull_feed(&pull, data + off, len, off + len == sizeof(data) - 1);
+
+		json_evt_t evt;
+		while ((evt = json_pull_next(&pull)) != JSON_EVT_NONE && evt != JSON_EVT_END) {
+			if (pull.depth != 2 || pull.key.len != 4) {
+				continue;
+			}
+
+			if (evt == JSON_EVT_OBJ_START && mem_cmp(pull.key.data, "keep", 4) == 0) {
+				keep = json_pull_keep(&pull, &json, JSON_END);
+				EXPECT_EQ(json_pull_keep(&pull, &json, JSON_END), JSON_END);
+			}
+		}
+
+		if (evt == JSON_EVT_END) {
+			break;
+		}
+	}
+
+	EXPECT_NE(keep, JSON_END);
+	EXPECT_EQ(json.values.cnt, 6);
+
+	char buf[128] = { 0 };
+	json_print(&json, keep, PRINT_DST_BUF(buf, sizeof(buf), 0), "");
+	EXPECT_STR(buf, "{\n\"a\": [\ntrue,\n{\n\"b\": \"s\"\n}\n],\n\"c\": null\n}");
+
+	json_pull_free(&pull);
+	json_pull_init(&pull, 8);
+	json_pull_feed(&pull, CSTR("{\"n\": \"str\"}"), 1);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_OBJ_START);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_KEY);
+	EXPECT_EQ(json_pull_keep(&pull, &json, JSON_END), JSON_END);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_VAL);
+	n = json_pull_keep(&pull, &json, keep);
+	EXPECT_NE(n, JSON_END);
+	EXPECT_STRN(get_mem(&json, n)->name.data, "n", 1);
+	EXPECT_STRN(get_mem(&json, n)->value.val.s.data, "str", 3);
+	json_pull_free(&pull);
+
+	json_pull_init(&pull, 8);
+	json_pull_feed(&pull, CSTR("[1, 2, [3, 4], 5]"), 1);
+	EXPECT_EQ(json_pull_next(&pull), JSON_EVT_ARR_START);
+	const json_val_t arr = json_pull_keep(&pull, &json, JSON_END);
+	json_evt_t evt;
+	do {
+		evt = json_pull_next(&pull);
+	} while (evt != JSON_EVT_END && evt != JSON_EVT_ERROR && evt != JSON_EVT_NONE);
+	EXPECT_EQ(evt, JSON_EVT_END);
+	json_print(&json, arr, PRINT_DST_BUF(buf, sizeof(buf), 0), "");
+	EXPECT_STR(buf, "[\n1,\n2,\n[\n3,\n4\n],\n5\n]");
+	json_pull_free(&pull);
+
+	json_free(&json);
+
+	END;
+}
+
+STEST(t_json_parse)
+{
+	SSTART;
+	RUN(t_json_idx);
+	RUN(t_json_idx_blocks);
+	RUN(t_json_parse_vals);
+	RUN(t_json_parse_invalid);
+	RUN(t_json_parse_print);
+	RUN(t_json_parse_arena);
+	RUN(t_json_ref);
+	RUN(t_json_pull);
+	RUN(t_json_pull_invalid);
+	RUN(t_json_pull_keep);
+	SEND;
+}
@@ -89,6 +89,28 @@ TEST(t_lex_tokenize)
 	END;
 }
 
+TEST(t_lex_tokenize_crlf)
+{
+	START;
+
+	lex_t lex = { 0 };
+	lex_init(&lex, 0);
+
+	lex.flags |= LEX_NORM_CRLF;
+
+	EXPECT_EQ(lex_tokenize(&lex, STR("A\r\nB\rC")), &lex);
+	EXPECT_EQ(lex.tokens.cnt, 6);
+
+	EXPECT_EQ(lex_get_token(&lex, 1)->type, (1 << TOKEN_WS) | (1 << TOKEN_NL));
+	EXPECT_EQ(lex_get_token(&lex, 2)->line, 1);
+	EXPECT_EQ(lex_get_token(&lex, 2)->col, 0);
+	EXPECT_EQ(lex_get_token(&lex, 3)->type, (1 << TOKEN_WS) | (1 << TOKEN_CR));
+
+	lex_free(&lex);
+
+	END;
+}
+
 TEST(t_lex_print_line)
 {
 	START;
@@ -141,6 +163,7 @@ STEST(t_lexer)
 	RUN(t_lex_add_token);
 	RUN(t_lex_get_token);
 	RUN(t_lex_tokenize);
+	RUN(t_lex_tokenize_crlf);
 	RUN(t_lex_print_line);
 	RUN(t_lex_dbg);
 
@@ -0,0 +1,215 @@
+#include "lz.h"
+
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#define TEST_FILE "t_lz.bin"
+
+static void fill(byte *data, size_t size)
+{
+	u32 seed = 1;
+	for (size_t i = 0; i < size; i++) {
+		seed	= seed * 1103515245 + 12345;
+		data[i] = i % 1024 < 512 ? (byte)('a' + i % 7) : (byte)(seed >> 16);
+	}
+}
+
+TEST(t_lz_compress)
+{
+	START;
+
+	byte src[4096];
+	byte dst[4096 + 4096 / 255 + 16];
+	byte out[4096];
+
+	EXPECT_EQ(lz_bound(0), 16);
+	EXPECT_EQ(lz_compress(NULL, 1, dst, sizeof(dst)), LZ_ERR);
+	EXPECT_EQ(lz_compress(src, sizeof(src), NULL, 0), LZ_ERR);
+	EXPECT_EQ(lz_compress(src, sizeof(src), dst, 16), LZ_ERR);
+
+	EXPECT_EQ(lz_compress(src, 0, dst, sizeof(dst)), 1);
+	EXPECT_EQ(lz_decompress(dst, 1, out, sizeof(out)), 0);
+
+	EXPECT_EQ(lz_compress("abc", 3, dst, sizeof(dst)), 4);
+	EXPECT_EQ(lz_decompress(dst, 4, out, sizeof(out)), 3);
+	EXPECT_STRN((char *)out, "abc", 3);
+
+	mem_set(src, 'x', sizeof(src));
+	size_t size = lz_compress(src, sizeof(src), dst, sizeof(dst));
+	EXPECT_EQ(size < 64, 1);
+	EXPECT_EQ(lz_decompress(dst, size, out, sizeof(out)), sizeof(src));
+	EXPECT_EQ(mem_cmp(src, out, sizeof(src)), 0);
+
+	fill(src, sizeof(src));
+	size = lz_compress(src, sizeof(src), dst, sizeof(dst));
+	EXPECT_EQ(size < sizeof(src), 1);
+	EXPECT_EQ(lz_decompress(dst, size, out, sizeof(out)), sizeof(src));
+	EXPECT_EQ(mem_cmp(src, out, sizeof(src)), 0);
+
+	END;
+}
+
+TEST(t_lz_decompress_invalid)
+{
+	START;
+
+	byte src[256];
+	byte dst[512];
+	byte out[256];
+
+	fill(src, sizeof(src));
+	mem_set(src, 'a', 128);
+	const size_t size = lz_compress(src, sizeof(src), dst, sizeof(dst));
+
+	EXPECT_EQ(lz_decompress(NULL, 0, out, sizeof(out)), LZ_ERR);
+	EXPECT_EQ(lz_decompress(dst, size, out, sizeof(out) - 1), LZ_ERR);
+	EXPECT_EQ(lz_decompress(dst, size - 1, out, sizeof(out)), LZ_ERR);
+	EXPECT_EQ(lz_decompress((byte[]){ 0xF0 }, 1, out, sizeof(out)), LZ_ERR);
+	EXPECT_EQ(lz_decompress((byte[]){ 0x10, 'a', 0x00, 0x00 }, 4, out, sizeof(out)), LZ_ERR);
+	EXPECT_EQ(lz_decompress((byte[]){ 0x10, 'a', 0x02, 0x00 }, 4, out, sizeof(out)), LZ_ERR);
+	EXPECT_EQ(lz_decompress((byte[]){ 0x10, 'a', 0x01, 0x00, 0x00 }, 5, out, sizeof(out)), 5);
+
+	END;
+}
+
+TEST(t_lz_frame)
+{
+	START;
+
+	const size_t size = LZ_BLOCK_SIZE * 2 + 100;
+
+	byte *src = mem_alloc(size);
+	byte *out = mem_alloc(size + 1);
+	fill(src, size);
+
+	lz_writer_t writer = { 0 };
+
+	EXPECT_EQ(lz_writer_init(NULL, NULL), NULL);
+	EXPECT_EQ(lz_writer_init(&writer, NULL), NULL);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	EXPECT_EQ(lz_writer_init(&writer, file), &writer);
+	EXPECT_EQ(lz_write(NULL, NULL, 0), 1);
+	EXPECT_EQ(lz_write(&writer, NULL, 1), 1);
+	EXPECT_EQ(lz_write(&writer, src, 10), 0);
+	EXPECT_EQ(lz_write(&writer, src + 10, size - 10), 0);
+	EXPECT_EQ(lz_writer_close(&writer), 0);
+	EXPECT_EQ(lz_writer_close(NULL), 1);
+	file_close(file);
+
+	lz_reader_t reader = { 0 };
+
+	EXPECT_EQ(lz_reader_init(NULL, NULL), NULL);
+	EXPECT_EQ(lz_reader_init(&reader, NULL), NULL);
+
+	file = file_open(TEST_FILE, "rb");
+	EXPECT_EQ(lz_reader_init(&reader, file), &reader);
+	EXPECT_EQ(lz_read(NULL, NULL, 0), LZ_ERR);
+	EXPECT_EQ(lz_read(&reader, out, 10), 10);
+	EXPECT_EQ(lz_read(&reader, out + 10, size - 9), size - 10);
+	EXPECT_EQ(lz_read(&reader, out, 1), 0);
+	EXPECT_EQ(mem_cmp(src, out, size), 0);
+	lz_reader_free(&reader);
+	lz_reader_free(NULL);
+	file_close(file);
+
+	size_t fsize;
+	byte *data = file_map(TEST_FILE, &fsize);
+	EXPECT_EQ(fsize < size, 1);
+	mem_cpy(out, size, data, fsize);
+	file_unmap(data, fsize);
+
+	out[fsize - 1] ^= 1;
+	file = file_open(TEST_FILE, "wb");
+	fwrite(out, 1, fsize, file);
+	file_close(file);
+
+	file = file_open(TEST_FILE, "rb");
+	lz_reader_init(&reader, file);
+	EXPECT_EQ(lz_read(&reader, out, size + 1), LZ_ERR);
+	lz_reader_free(&reader);
+	file_close(file);
+
+	file = file_open(TEST_FILE, "wb");
+	fprintf(file, "invalid");
+	file_close(file);
+
+	file = file_open(TEST_FILE, "rb");
+	EXPECT_EQ(lz_reader_init(&reader, file), NULL);
+	file_close(file);
+
+	mem_free(src, size);
+	mem_free(out, size + 1);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_lz_print)
+{
+	START;
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	lz_writer_t writer;
+	lz_writer_init(&writer, file);
+	for (int i = 0; i < 100; i++) {
+		lz_write(&writer, "line\n", 5);
+	}
+	lz_write(&writer, "\0bin\0", 5);
+	lz_writer_close(&writer);
+	file_close(file);
+
+	char buf[1024] = { 0 };
+
+	file = file_open(TEST_FILE, "rb");
+	lz_reader_t reader;
+	lz_reader_init(&reader, file);
+	EXPECT_EQ(lz_print(NULL, PRINT_DST_BUF(buf, sizeof(buf), 0)), LZ_ERR);
+	EXPECT_EQ(lz_print(&reader, PRINT_DST_BUF(buf, sizeof(buf), 0)), 505);
+	EXPECT_STRN(buf, "line\nline\n", 10);
+	EXPECT_EQ(mem_cmp(buf + 500, "\0bin\0", 6), 0);
+	lz_reader_free(&reader);
+	file_close(file);
+
+	file = file_open(TEST_FILE, "rb");
+	lz_reader_init(&reader, file);
+	FILE *out = file_open(TEST_FILE ".out", "wb");
+	EXPECT_EQ(lz_print(&reader, PRINT_DST_FILE(out)), 505);
+	file_close(out);
+	lz_reader_free(&reader);
+	file_close(file);
+
+	EXPECT_EQ(file_read_t(TEST_FILE ".out", buf, sizeof(buf)), 505);
+	EXPECT_EQ(mem_cmp(buf + 500, "\0bin\0", 5), 0);
+	file_delete(TEST_FILE ".out");
+
+	size_t fsize;
+	byte *data = file_map(TEST_FILE, &fsize);
+	mem_cpy(buf, sizeof(buf), data, fsize);
+	file_unmap(data, fsize);
+
+	file = file_open(TEST_FILE, "wb");
+	fwrite(buf, 1, fsize - 1, file);
+	file_close(file);
+
+	file = file_open(TEST_FILE, "rb");
+	lz_reader_init(&reader, file);
+	EXPECT_EQ(lz_print(&reader, PRINT_DST_BUF(buf, sizeof(buf), 0)), LZ_ERR);
+	lz_reader_free(&reader);
+	file_close(file);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+STEST(t_lz)
+{
+	SSTART;
+	RUN(t_lz_compress);
+	RUN(t_lz_decompress_invalid);
+	RUN(t_lz_frame);
+	RUN(t_lz_print);
+	SEND;
+}
@@ -1,8 +1,12 @@
 #include "md5.h"
 
 #include "cstr.h"
+#include "file.h"
+#include "mem.h"
 #include "test.h"
 
+#define TEST_FILE "t_md5.txt"
+
 TEST(format)
 {
 	START;
@@ -20,9 +24,114 @@ TEST(format)
 	END;
 }
 
+TEST(t_md5_update)
+{
+	START;
+
+	md5_t ctx;
+	byte digest[16] = { 0 };
+
+	EXPECT_EQ(md5_init(NULL), NULL);
+	md5_update(NULL, NULL, 0);
+	md5_final(NULL, NULL);
+
+	EXPECT_EQ(md5_init(&ctx), &ctx);
+	md5_final(&ctx, digest);
+	EXPECT_EQ(digest[0], 0xD4);
+	EXPECT_EQ(digest[15], 0x7E);
+
+	byte exp[16] = { 0 };
+	char msg[200];
+	for (size_t i = 0; i < sizeof(msg); i++) {
+		msg[i] = (char)('a' + i % 26);
+	}
+
+	md5_init(&ctx);
+	md5_update(&ctx, msg, sizeof(msg));
+	md5_final(&ctx, exp);
+
+	md5_init(&ctx);
+	for (size_t i = 0; i < sizeof(msg); i += 7) {
+		md5_update(&ctx, msg + i, sizeof(msg) - i < 7 ? sizeof(msg) - i : 7);
+	}
+	md5_final(&ctx, digest);
+
+	EXPECT_EQ(mem_cmp(digest, exp, sizeof(exp)), 0);
+
+	byte buf[256] = { 0 };
+	char res[37]  = { 0 };
+	md5(CSTR("abc"), buf, sizeof(buf), res, sizeof(res));
+	EXPECT_STR(res, "90015098-3CD2-4FB0-D696-3F7D28E17F72");
+
+	END;
+}
+
+TEST(t_md5_file)
+{
+	START;
+
+	byte digest[16] = { 0 };
+
+	EXPECT_EQ(md5_file(NULL, NULL), 1);
+	EXPECT_EQ(md5_file(TEST_FILE, NULL), 1);
+	EXPECT_EQ(md5_file(TEST_FILE, digest), 1);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fprintf(file, "test");
+	file_close(file);
+
+	EXPECT_EQ(md5_file(TEST_FILE, digest), 0);
+	EXPECT_EQ(digest[0], 0x09);
+	EXPECT_EQ(digest[15], 0xF6);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_md5_batch)
+{
+	START;
+
+	char data[300];
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = (char)(i * 7 + 3);
+	}
+
+	md5_msg_t msgs[11] = { 0 };
+	const size_t lens[] = { 0, 1, 55, 56, 63, 64, 65, 119, 128, 200, 300 };
+	for (uint i = 0; i < 11; i++) {
+		msgs[i].data = data;
+		msgs[i].len  = lens[i];
+	}
+
+	EXPECT_EQ(md5_batch(NULL, 0), 1);
+	EXPECT_EQ(md5_batch(msgs, 0), 0);
+	EXPECT_EQ(md5_batch(msgs, 11), 0);
+
+	for (uint i = 0; i < 11; i++) {
+		md5_t ctx;
+		byte exp[16] = { 0 };
+		md5_init(&ctx);
+		md5_update(&ctx, data, lens[i]);
+		md5_final(&ctx, exp);
+		EXPECT_EQ(mem_cmp(msgs[i].digest, exp, sizeof(exp)), 0);
+	}
+
+	msgs[0].data = NULL;
+	msgs[1].data = NULL;
+	EXPECT_EQ(md5_batch(msgs, 1), 0);
+	EXPECT_EQ(md5_batch(msgs, 2), 1);
+
+	END;
+}
+
 STEST(t_md5)
 {
 	SSTART;
 	RUN(format);
+	RUN(t_md5_update);
+	RUN(t_md5_file);
+	RUN(t_md5_batch);
 	SEND;
 }
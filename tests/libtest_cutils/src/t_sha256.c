@@ -0,0 +1,85 @@
+#include "sha256.h"
+
+#include "cstr.h"
+#include "digest.h"
+#include "file.h"
+#include "mem.h"
+#include "test.h"
+
+#define TEST_FILE "t_sha256.txt"
+
+static void sha256_hex(const char *data, size_t len, char *out, size_t out_size)
+{
+	sha256_t ctx;
+	byte digest[32] = { 0 };
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, data, len);
+	sha256_final(&ctx, digest);
+	digest_hex(digest, sizeof(digest), out, out_size);
+}
+
+TEST(t_sha256_update)
+{
+	START;
+
+	sha256_t ctx;
+	char out[65] = { 0 };
+
+	EXPECT_EQ(sha256_init(NULL), NULL);
+	sha256_update(NULL, NULL, 0);
+	sha256_final(NULL, NULL);
+
+	sha256_hex(CSTR(""), out, sizeof(out));
+	EXPECT_STR(out, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	sha256_hex(CSTR("abc"), out, sizeof(out));
+	EXPECT_STR(out, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+	sha256_hex(CSTR("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"), out, sizeof(out));
+	EXPECT_STR(out, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+	char data[1001];
+	mem_set(data, 'a', sizeof(data));
+
+	byte digest[32] = { 0 };
+	sha256_init(&ctx);
+	for (int i = 0; i < 1000; i++) {
+		sha256_update(&ctx, data, i % 2 ? 999 : 1001);
+	}
+	sha256_final(&ctx, digest);
+	digest_hex(digest, sizeof(digest), out, sizeof(out));
+	EXPECT_STR(out, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+	END;
+}
+
+TEST(t_sha256_file)
+{
+	START;
+
+	byte digest[32] = { 0 };
+	char out[65]	= { 0 };
+
+	EXPECT_EQ(sha256_file(NULL, NULL), 1);
+	EXPECT_EQ(sha256_file(TEST_FILE, NULL), 1);
+	EXPECT_EQ(sha256_file(TEST_FILE, digest), 1);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fprintf(file, "abc");
+	file_close(file);
+
+	EXPECT_EQ(sha256_file(TEST_FILE, digest), 0);
+	digest_hex(digest, sizeof(digest), out, sizeof(out));
+	EXPECT_STR(out, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+STEST(t_sha256)
+{
+	SSTART;
+	RUN(t_sha256_update);
+	RUN(t_sha256_file);
+	SEND;
+}
@@ -0,0 +1,243 @@
+#include "snap.h"
+
+#include "file.h"
+#include "mem.h"
+#include "str.h"
+#include "test.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TEST_FILE "t_snap.bin"
+
+typedef struct node_s {
+	str_t name;
+	int val;
+} node_t;
+
+TEST(t_snap_open_close)
+{
+	START;
+
+	snap_t snap = { 0 };
+
+	EXPECT_EQ(snap_open(NULL, NULL), NULL);
+	EXPECT_EQ(snap_open(&snap, NULL), NULL);
+	EXPECT_EQ(snap_open(&snap, TEST_FILE), NULL);
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fprintf(file, "invalid");
+	file_close(file);
+
+	EXPECT_EQ(snap_open(&snap, TEST_FILE), NULL);
+
+	snap_close(&snap);
+	snap_close(NULL);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_snap_writer)
+{
+	START;
+
+	snap_writer_t writer = { 0 };
+	arr_t arr	     = { 0 };
+	arr_init(&arr, 1, sizeof(str_t));
+
+	const size_t strs[] = { 0, sizeof(str_t) };
+
+	EXPECT_EQ(snap_writer_init(NULL, 0), NULL);
+	EXPECT_EQ(snap_writer_init(&writer, 1), &writer);
+
+	EXPECT_EQ(snap_writer_arr(NULL, NULL, NULL, 0), ARR_END);
+	EXPECT_EQ(snap_writer_arr(&writer, &arr, NULL, 1), ARR_END);
+	EXPECT_EQ(snap_writer_arr(&writer, &arr, strs, SNAP_MAX_STRS + 1), ARR_END);
+	EXPECT_EQ(snap_writer_arr(&writer, &arr, &strs[1], 1), ARR_END);
+	EXPECT_EQ(snap_writer_arr(&writer, &arr, strs, 1), 0);
+
+	EXPECT_EQ(snap_writer_save(NULL, NULL), 1);
+	EXPECT_EQ(snap_writer_save(&writer, TEST_FILE), 0);
+	EXPECT_EQ(file_exists(TEST_FILE ".tmp"), 0);
+
+	mem_oom(1);
+	EXPECT_EQ(snap_writer_save(&writer, TEST_FILE), 1);
+	mem_oom(0);
+
+	snap_writer_free(&writer);
+	snap_writer_free(NULL);
+	arr_free(&arr);
+
+	snap_t snap = { 0 };
+	EXPECT_EQ(snap_open(&snap, TEST_FILE), &snap);
+	EXPECT_EQ(snap.cnt, 1);
+
+	arr_t view = { 0 };
+	EXPECT_EQ(snap_get(NULL, 0, NULL), NULL);
+	EXPECT_EQ(snap_get(&snap, 1, &view), NULL);
+	EXPECT_EQ(snap_get(&snap, 0, &view), &view);
+	EXPECT_EQ(view.cnt, 0);
+	EXPECT_EQ(view.size, sizeof(str_t));
+
+	snap_close(&snap);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_snap_containers)
+{
+	START;
+
+	arr_t arr   = { 0 };
+	list_t list = { 0 };
+	tree_t tree = { 0 };
+
+	arr_init(&arr, 4, sizeof(int));
+	for (int i = 0; i < 100; i++) {
+		arr_app(&arr, &i);
+	}
+
+	const node_t nodes[] = {
+		{ .name = STRS("first"), .val = 1 },
+		{ .name = { 0 }, .val = 2 },
+		{ .name = STRS("third"), .val = 3 },
+		{ .name = STRS("root"), .val = 0 },
+		{ .name = STRS("a"), .val = 1 },
+		{ .name = STRS("b"), .val = 2 },
+	};
+
+	list_init(&list, 4, sizeof(node_t));
+	lnode_t lnode = list_add(&list);
+	mem_cpy(list_get_data(&list, lnode), sizeof(node_t), &nodes[0], sizeof(node_t));
+	for (uint i = 1; i < 3; i++) {
+		lnode = list_add_next(&list, lnode);
+		mem_cpy(list_get_data(&list, lnode), sizeof(node_t), &nodes[i], sizeof(node_t));
+	}
+
+	tree_init(&tree, 4, sizeof(node_t));
+	tnode_t root = tree_add(&tree);
+	mem_cpy(tree_get_data(&tree, root), sizeof(node_t), &nodes[3], sizeof(node_t));
+	for (uint i = 4; i < 6; i++) {
+		mem_cpy(tree_get_data(&tree, tree_add_child(&tree, root)), sizeof(node_t), &nodes[i], sizeof(node_t));
+	}
+
+	const size_t strs[] = { offsetof(node_t, name) };
+
+	snap_writer_t writer = { 0 };
+	snap_writer_init(&writer, 4);
+	EXPECT_EQ(snap_writer_arr(&writer, &arr, NULL, 0), 0);
+	EXPECT_EQ(snap_writer_list(&writer, &list, strs, 1), 1);
+	EXPECT_EQ(snap_writer_tree(&writer, &tree, strs, 1), 2);
+	EXPECT_EQ(snap_writer_save(&writer, TEST_FILE), 0);
+	snap_writer_free(&writer);
+
+	arr_free(&arr);
+	list_free(&list);
+	tree_free(&tree);
+
+	snap_t snap = { 0 };
+	EXPECT_EQ(snap_open(&snap, TEST_FILE), &snap);
+	EXPECT_EQ(snap.cnt, 3);
+
+	arr_t arr_view;
+	EXPECT_EQ(snap_get(&snap, 0, &arr_view), &arr_view);
+	EXPECT_EQ(arr_view.cnt, 100);
+	int found = 0;
+	for (uint i = 0; i < arr_view.cnt; i++) {
+		found += *(int *)arr_get(&arr_view, i) == (int)i;
+	}
+	EXPECT_EQ(found, 100);
+
+	list_t list_view;
+	EXPECT_EQ(snap_get(&snap, 1, &list_view), &list_view);
+	EXPECT_EQ(list_view.cnt, 3);
+	const node_t *node;
+	found = 0;
+	list_foreach(&list_view, 0, node)
+	{
+		found += node->val;
+	}
+	EXPECT_EQ(found, 6);
+	node	   = list_get_data(&list_view, 0);
+	str_t name = snap_str(&snap, node->name);
+	EXPECT_STRN(name.data, "first", name.len);
+	EXPECT_EQ(name.data[name.len], '\0');
+	node = list_get_data(&list_view, 1);
+	EXPECT_EQ(snap_str(&snap, node->name).data, NULL);
+	node = list_get_data(&list_view, 2);
+	name = snap_str(&snap, node->name);
+	EXPECT_STRN(name.data, "third", name.len);
+	EXPECT_EQ(snap_str(NULL, node->name).data, NULL);
+	EXPECT_EQ(snap_str(&snap, (str_t){ .data = (const char *)(uintptr_t)snap.size, .len = 1 }).data, NULL);
+
+	tree_t tree_view;
+	EXPECT_EQ(snap_get(&snap, 2, &tree_view), &tree_view);
+	EXPECT_EQ(tree_view.cnt, 3);
+	node = tree_get_data(&tree_view, 0);
+	name = snap_str(&snap, node->name);
+	EXPECT_STRN(name.data, "root", name.len);
+	tnode_t tnode;
+	char names[3] = { 0 };
+	uint cnt      = 0;
+	tree_foreach_child(&tree_view, 0, tnode)
+	{
+		node	     = tree_get_data(&tree_view, tnode);
+		names[cnt++] = snap_str(&snap, node->name).data[0];
+	}
+	EXPECT_STR(names, "ab");
+
+	snap_close(&snap);
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+TEST(t_snap_abi)
+{
+	START;
+
+	arr_t arr = { 0 };
+	arr_init(&arr, 1, sizeof(int));
+
+	snap_writer_t writer = { 0 };
+	snap_writer_init(&writer, 1);
+	snap_writer_arr(&writer, &arr, NULL, 0);
+	snap_writer_save(&writer, TEST_FILE);
+	snap_writer_free(&writer);
+	arr_free(&arr);
+
+	char data[64]	 = { 0 };
+	const size_t len = file_read_t(TEST_FILE, data, sizeof(data));
+	EXPECT_EQ(mem_cmp(data, "SNP2", 4), 0);
+
+	snap_t snap = { 0 };
+	EXPECT_EQ(snap_open(&snap, TEST_FILE), &snap);
+	snap_close(&snap);
+
+	const char order = data[8];
+	data[8]		 = data[11];
+	data[11]	 = order;
+
+	FILE *file = file_open(TEST_FILE, "wb");
+	fwrite(data, 1, len, file);
+	file_close(file);
+
+	EXPECT_EQ(snap_open(&snap, TEST_FILE), NULL);
+
+	file_delete(TEST_FILE);
+
+	END;
+}
+
+STEST(t_snap)
+{
+	SSTART;
+	RUN(t_snap_open_close);
+	RUN(t_snap_writer);
+	RUN(t_snap_containers);
+	RUN(t_snap_abi);
+	SEND;
+}
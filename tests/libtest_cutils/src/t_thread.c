@@ -0,0 +1,135 @@
+#include "thread.h"
+
+#include "test.h"
+
+typedef struct counter_s {
+	mutex_t lock;
+	cond_t cond;
+	int cnt;
+} counter_t;
+
+static void counter_run(void *priv)
+{
+	counter_t *counter = priv;
+
+	for (int i = 0; i < 1000; i++) {
+		mutex_lock(&counter->lock);
+		counter->cnt++;
+		cond_signal(&counter->cond);
+		mutex_unlock(&counter->lock);
+	}
+}
+
+TEST(t_thread_create_join)
+{
+	START;
+
+	counter_t counter = { 0 };
+	mutex_init(&counter.lock);
+	cond_init(&counter.cond);
+
+	thread_t threads[4] = { 0 };
+
+	EXPECT_EQ(thread_create(NULL, NULL, NULL), 1);
+	EXPECT_EQ(thread_create(&threads[0], NULL, NULL), 1);
+	EXPECT_EQ(thread_join(NULL), 1);
+
+	for (int i = 0; i < 4; i++) {
+		EXPECT_EQ(thread_create(&threads[i], counter_run, &counter), 0);
+	}
+
+	mutex_lock(&counter.lock);
+	while (counter.cnt < 4000) {
+		cond_wait(&counter.cond, &counter.lock);
+	}
+	mutex_unlock(&counter.lock);
+
+	for (int i = 0; i < 4; i++) {
+		EXPECT_EQ(thread_join(&threads[i]), 0);
+	}
+
+	EXPECT_EQ(counter.cnt, 4000);
+
+	cond_free(&counter.cond);
+	mutex_free(&counter.lock);
+
+	END;
+}
+
+static once_t s_once = ONCE_INIT;
+static int s_once_cnt;
+
+static void once_run()
+{
+	s_once_cnt++;
+}
+
+static void once_thread(void *priv)
+{
+	(void)priv;
+	thread_once(&s_once, once_run);
+}
+
+TEST(t_thread_once)
+{
+	START;
+
+	thread_once(NULL, NULL);
+	thread_once(&s_once, NULL);
+
+	thread_t threads[4] = { 0 };
+	for (int i = 0; i < 4; i++) {
+		thread_create(&threads[i], once_thread, NULL);
+	}
+
+	thread_once(&s_once, once_run);
+
+	for (int i = 0; i < 4; i++) {
+		thread_join(&threads[i]);
+	}
+
+	EXPECT_EQ(s_once_cnt, 1);
+
+	END;
+}
+
+TEST(t_thread_cpu_cnt)
+{
+	START;
+
+	EXPECT_GT(thread_cpu_cnt(), 0);
+
+	END;
+}
+
+TEST(t_mutex_cond_init_free)
+{
+	START;
+
+	mutex_t mutex = { 0 };
+	cond_t cond   = { 0 };
+
+	EXPECT_EQ(mutex_init(NULL), NULL);
+	EXPECT_EQ(mutex_init(&mutex), &mutex);
+	EXPECT_EQ(cond_init(NULL), NULL);
+	EXPECT_EQ(cond_init(&cond), &cond);
+
+	cond_broadcast(&cond);
+
+	cond_free(&cond);
+	cond_free(NULL);
+	mutex_free(&mutex);
+	mutex_free(NULL);
+
+	END;
+}
+
+STEST(t_thread)
+{
+	SSTART;
+	RUN(t_thread_create_join);
+	RUN(t_thread_once);
+	RUN(t_thread_cpu_cnt);
+	RUN(t_mutex_cond_init_free);
+	SEND;
+}
@@ -4,6 +4,8 @@
 #include "mem.h"
 #include "test.h"
 
+#include <stdio.h>
+
 TEST(t_xml_init_free)
 {
 	START;
@@ -350,6 +352,199 @@ TEST(t_xml_print_remove_tag_middle)
 	END;
 }
 
+TEST(t_xml_print_esc)
+{
+	START;
+
+	xml_t xml = { 0 };
+	xml_init(&xml, 1, 1);
+
+	const xml_tag_t project = xml_add_tag_val(&xml, XML_END, STRH("Project"), STRH("if a < b && c > \"d\" then"));
+	xml_add_attr(&xml, project, STRH("Condition"), STRH("'$(Configuration)' == \"Debug & Release\""));
+
+	char buf[256] = { 0 };
+	EXPECT_EQ(xml_print(&xml, 0, PRINT_DST_BUF(buf, sizeof(buf), 0)), 163);
+
+	EXPECT_STR(buf, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<Project Condition=\"'$(Configuration)' == &quot;Debug &amp; Release&quot;\">if a &lt; b &amp;&amp; c &gt; \"d\" then</Project>\n");
+
+	xml_free(&xml);
+
+	END;
+}
+
+TEST(t_xml_print_deep)
+{
+	START;
+
+	xml_t xml = { 0 };
+	xml_init(&xml, 1, 1);
+
+	xml_tag_t tag = xml_add_tag(&xml, XML_END, STRH("a"));
+	xml_add_tag(&xml, tag, STRH("b"));
+	xml_tag_t last = tag;
+	for (int i = 0; i < 40; i++) {
+		last = xml_add_tag(&xml, last, STRH("c"));
+	}
+	xml_add_tag_val(&xml, last, STRH("d"), STRH("v\n"));
+	xml_add_tag(&xml, tag, STRH("e"));
+
+	char buf[8192] = { 0 };
+	const int len  = xml_print(&xml, 0, PRINT_DST_BUF(buf, sizeof(buf), 0));
+	EXPECT_EQ(len, 3878);
+
+	char exp[8192] = { 0 };
+	size_t off     = 0;
+	off += (size_t)snprintf(exp + off, sizeof(exp) - off, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<a>\n  <b />\n");
+	for (int i = 0; i < 40; i++) {
+		off += (size_t)snprintf(exp + off, sizeof(exp) - off, "%*s<c>\n", (i + 1) * 2, "");
+	}
+	off += (size_t)snprintf(exp + off, sizeof(exp) - off, "%*s<d>v\n%*s</d>\n", 82, "", 82, "");
+	for (int i = 39; i >= 0; i--) {
+		off += (size_t)snprintf(exp + off, sizeof(exp) - off, "%*s</c>\n", (i + 1) * 2, "");
+	}
+	snprintf(exp + off, sizeof(exp) - off, "  <e />\n</a>\n");
+
+	EXPECT_STR(buf, exp);
+
+	xml_free(&xml);
+
+	END;
+}
+
+TEST(t_xml_writer)
+{
+	START;
+
+	xml_t xml = { 0 };
+	xml_init(&xml, 1, 1);
+
+	const xml_tag_t root = xml_add_tag(&xml, XML_END, STRH("Project"));
+	xml_add_attr(&xml, root, STRH("DefaultTargets"), STRH("Build"));
+	xml_add_attr(&xml, root, STRH("Condition"), STRH("\"a\" & <b>"));
+	const xml_tag_t group = xml_add_tag(&xml, root, STRH("ItemGroup"));
+	xml_add_tag(&xml, group, STRH("Empty"));
+	const xml_tag_t item = xml_add_tag_val(&xml, group, STRH("Item"), STRH("a && b"));
+	xml_add_attr(&xml, item, STRH("Include"), STRH(""));
+	xml_add_tag_val(&xml, group, STRH("Blank"), STRH(""));
+	xml_add_tag_val(&xml, root, STRH("Text"), STRH("line 1\nline 2\n"));
+
+	char exp[512] = { 0 };
+	const int len = xml_print(&xml, root, PRINT_DST_BUF(exp, sizeof(exp), 0));
+
+	char buf[512]	    = { 0 };
+	xml_writer_t writer = { 0 };
+	EXPECT_EQ(xml_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0)), &writer);
+	xml_write_open(&writer, CSTR("Project"));
+	xml_write_attr(&writer, CSTR("DefaultTargets"), CSTR("Build"));
+	xml_write_attr(&writer, CSTR("Condition"), CSTR("\"a\" & <b>"));
+	xml_write_open(&writer, CSTR("ItemGroup"));
+	xml_write_open(&writer, CSTR("Empty"));
+	xml_write_end(&writer);
+	xml_write_open(&writer, CSTR("Item"));
+	xml_write_attr(&writer, NULL, 0, NULL, 0);
+	xml_write_attr(&writer, CSTR("Include"), NULL, 0);
+	xml_write_text(&writer, CSTR("a &"));
+	xml_write_text(&writer, CSTR("& b"));
+	xml_write_end(&writer);
+	xml_write_open(&writer, CSTR("Blank"));
+	xml_write_text(&writer, NULL, 0);
+	xml_write_end(&writer);
+	xml_write_end(&writer);
+	xml_write_open(&writer, CSTR("Text"));
+	xml_write_text(&writer, CSTR("line 1\n"));
+	xml_write_text(&writer, CSTR("line 2\n"));
+	xml_write_text(&writer, NULL, 0);
+	xml_write_end(&writer);
+	xml_write_end(&writer);
+	EXPECT_EQ(xml_writer_close(&writer), 0);
+
+	EXPECT_EQ(writer.buf.dst.off, len);
+	EXPECT_STR(buf, exp);
+
+	xml_free(&xml);
+
+	END;
+}
+
+TEST(t_xml_writer_invalid)
+{
+	START;
+
+	char buf[128]	    = { 0 };
+	xml_writer_t writer = { 0 };
+
+	EXPECT_EQ(xml_writer_init(NULL, PRINT_DST_BUF(buf, sizeof(buf), 0)), NULL);
+	EXPECT_EQ(xml_writer_close(NULL), 1);
+	EXPECT_EQ(xml_write_open(NULL, CSTR("a")), 1);
+	EXPECT_EQ(xml_write_attr(NULL, CSTR("a"), CSTR("b")), 1);
+	EXPECT_EQ(xml_write_text(NULL, CSTR("a")), 1);
+	EXPECT_EQ(xml_write_end(NULL), 1);
+
+	xml_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0));
+	EXPECT_EQ(xml_write_attr(&writer, CSTR("a"), CSTR("b")), 1);
+	EXPECT_EQ(xml_write_text(&writer, CSTR("a")), 1);
+	EXPECT_EQ(xml_write_end(&writer), 1);
+	EXPECT_EQ(xml_write_open(&writer, NULL, 0), 1);
+	EXPECT_EQ(xml_write_open(&writer, CSTR("a")), 0);
+	EXPECT_EQ(xml_write_attr(&writer, CSTR("k"), NULL, 1), 1);
+	EXPECT_EQ(xml_write_text(&writer, NULL, 1), 1);
+	EXPECT_EQ(xml_write_open(&writer, CSTR("b")), 0);
+	EXPECT_EQ(xml_write_text(&writer, CSTR("t")), 0);
+	EXPECT_EQ(xml_write_attr(&writer, CSTR("k"), CSTR("v")), 1);
+	EXPECT_EQ(xml_write_open(&writer, CSTR("c")), 1);
+	EXPECT_EQ(xml_write_end(&writer), 0);
+	EXPECT_EQ(xml_write_text(&writer, CSTR("t")), 1);
+	EXPECT_EQ(xml_writer_close(&writer), 1);
+	EXPECT_STR(buf, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<a>\n  <b>t</b>\n");
+
+	xml_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0));
+	EXPECT_EQ(xml_write_open(&writer, CSTR("a")), 0);
+	EXPECT_EQ(xml_write_end(&writer), 0);
+	EXPECT_EQ(xml_write_open(&writer, CSTR("b")), 1);
+	EXPECT_EQ(xml_write_end(&writer), 1);
+	EXPECT_EQ(xml_writer_close(&writer), 0);
+	EXPECT_STR(buf, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<a />\n");
+
+	xml_writer_init(&writer, PRINT_DST_BUF(buf, sizeof(buf), 0));
+	EXPECT_EQ(xml_writer_close(&writer), 1);
+
+	END;
+}
+
+TEST(t_xml_writer_stream)
+{
+	START;
+
+	const uint cnt	  = 100000;
+	const size_t size = 4 * 1024 * 1024;
+
+	char *buf	    = mem_alloc(size);
+	xml_writer_t writer = { 0 };
+	xml_writer_init(&writer, PRINT_DST_BUF(buf, size, 0));
+
+	xml_write_open(&writer, CSTR("root"));
+	for (uint i = 0; i < cnt; i++) {
+		xml_write_open(&writer, CSTR("item"));
+		xml_write_attr(&writer, CSTR("k"), CSTR("<v>"));
+		xml_write_text(&writer, CSTR("a & b"));
+		xml_write_end(&writer);
+	}
+	xml_write_end(&writer);
+
+	EXPECT_EQ(writer.buf.data, buf);
+	EXPECT_EQ(writer.names.size, 256);
+	EXPECT_EQ(writer.stack.cap, 16);
+	EXPECT_EQ(xml_writer_close(&writer), 0);
+	EXPECT_EQ(writer.buf.dst.off, 39 + 7 + cnt * 39 + 8);
+	EXPECT_STRN(buf + 39, "<root>\n  <item k=\"&lt;v&gt;\">a &amp; b</item>\n", 46);
+	EXPECT_STRN(buf + writer.buf.dst.off - 8, "</root>\n", 8);
+
+	mem_free(buf, size);
+
+	END;
+}
+
 TEST(t_xml_prints)
 {
 	SSTART;
@@ -363,6 +558,11 @@ TEST(t_xml_prints)
 	RUN(t_xml_print_remove_tag);
 	RUN(t_xml_print_remove_tag_attr);
 	RUN(t_xml_print_remove_tag_middle);
+	RUN(t_xml_print_esc);
+	RUN(t_xml_print_deep);
+	RUN(t_xml_writer);
+	RUN(t_xml_writer_invalid);
+	RUN(t_xml_writer_stream);
 	SEND;
 }
 
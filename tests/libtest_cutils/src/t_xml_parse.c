@@ -0,0 +1,176 @@
+#include "xml_parse.h"
+
+#include "cstr.h"
+#include "mem.h"
+#include "test.h"
+
+#include <stdio.h>
+
+typedef struct evts_s {
+	char buf[512];
+	size_t len;
+	int stop;
+} evts_t;
+
+static int evt_cb(xml_evt_t evt, str_t name, str_t val, void *priv)
+{
+	evts_t *evts = priv;
+
+	const char *types[] = { "O", "A", "T", "C" };
+	evts->len += (size_t)snprintf(evts->buf + evts->len, sizeof(evts->buf) - evts->len, "%s:%.*s=%.*s;", types[evt], (int)name.len, name.data ? name.data : "",
+				      (int)val.len, val.data ? val.data : "");
+
+	return evts->stop > 0 && --evts->stop == 0;
+}
+
+TEST(t_xml_parse_stream)
+{
+	START;
+
+	const char data[] = "\xEF\xBB\xBF<?xml version=\"1.0\"?>\n"
+			    "<!DOCTYPE a [<!ENTITY x \"y\">]>\n"
+			    "<!-- comment -->\n"
+			    "<a k=\"v\" e='&lt;&#65;&#x42;&amp;'>\n"
+			    "  <b><f/></b>\n"
+			    "  <c></c>\n"
+			    "  <d> </d>\n"
+			    "  <e>x &gt; y<![CDATA[<&>]]></e>\n"
+			    "</a>\n";
+
+	evts_t evts = { 0 };
+
+	EXPECT_EQ(xml_parse_stream(NULL, 0, evt_cb, &evts), 1);
+	EXPECT_EQ(xml_parse_stream(CSTR(data), NULL, &evts), 1);
+
+	EXPECT_EQ(xml_parse_stream(CSTR(data), evt_cb, &evts), 0);
+	EXPECT_STR(evts.buf, "O:a=;A:k=v;A:e=<AB&;O:b=;O:f=;C:f=;C:b=;O:c=;T:=;C:c=;O:d=;T:= ;C:d=;O:e=;T:=x > y;T:=<&>;C:e=;C:a=;");
+
+	evts = (evts_t){ .stop = 3 };
+	EXPECT_EQ(xml_parse_stream(CSTR(data), evt_cb, &evts), 1);
+	EXPECT_STR(evts.buf, "O:a=;A:k=v;A:e=<AB&;");
+
+	END;
+}
+
+TEST(t_xml_parse_doc)
+{
+	START;
+
+	const char data[] = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			    "<Project DefaultTargets=\"Build\" ToolsVersion=\"4.0\">\n"
+			    "  <ItemGroup Label=\"ProjectConfigurations\">\n"
+			    "    <ProjectConfiguration Include=\"Debug|x64\">\n"
+			    "      <Configuration>Debug</Configuration>\n"
+			    "      <Platform>x64</Platform>\n"
+			    "    </ProjectConfiguration>\n"
+			    "  </ItemGroup>\n"
+			    "  <!-- comment -->\n"
+			    "  <PropertyGroup Condition=\"'$(Configuration)'=='Debug'\" />\n"
+			    "  <ItemDefinitionGroup>\n"
+			    "    <Empty></Empty>\n"
+			    "    <Command>a &amp;&amp; b</Command>\n"
+			    "  </ItemDefinitionGroup>\n"
+			    "</Project>\n";
+
+	xml_t xml = { 0 };
+	xml_init(&xml, 16, 16);
+
+	EXPECT_EQ(xml_parse(NULL, CSTR(data)), XML_END);
+	EXPECT_EQ(xml_parse(&xml, NULL, 0), XML_END);
+
+	const xml_tag_t root = xml_parse(&xml, CSTR(data));
+	EXPECT_EQ(root, 0);
+	EXPECT_EQ(xml.tags.cnt, 9);
+	EXPECT_EQ(xml.attrs.cnt, 5);
+
+	char buf[1024] = { 0 };
+	xml_print(&xml, root, PRINT_DST_BUF(buf, sizeof(buf), 0));
+	EXPECT_STR(buf, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<Project DefaultTargets=\"Build\" ToolsVersion=\"4.0\">\n"
+			"  <ItemGroup Label=\"ProjectConfigurations\">\n"
+			"    <ProjectConfiguration Include=\"Debug|x64\">\n"
+			"      <Configuration>Debug</Configuration>\n"
+			"      <Platform>x64</Platform>\n"
+			"    </ProjectConfiguration>\n"
+			"  </ItemGroup>\n"
+			"  <PropertyGroup Condition=\"'$(Configuration)'=='Debug'\" />\n"
+			"  <ItemDefinitionGroup>\n"
+			"    <Empty></Empty>\n"
+			"    <Command>a &amp;&amp; b</Command>\n"
+			"  </ItemDefinitionGroup>\n"
+			"</Project>\n");
+
+	xml_free(&xml);
+
+	END;
+}
+
+TEST(t_xml_parse_text)
+{
+	START;
+
+	const char data[] = "<a>first text longer than a block <!-- c --> second &amp; more text after the comment</a>";
+
+	xml_t xml = { 0 };
+	xml_init(&xml, 1, 1);
+
+	const xml_tag_t root = xml_parse(&xml, CSTR(data));
+	EXPECT_EQ(root, 0);
+
+	char buf[256] = { 0 };
+	xml_print(&xml, root, PRINT_DST_BUF(buf, sizeof(buf), 0));
+	EXPECT_STR(buf, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<a>first text longer than a block  second &amp; more text after the comment</a>\n");
+
+	xml_free(&xml);
+
+	END;
+}
+
+TEST(t_xml_parse_invalid)
+{
+	START;
+
+	const char *docs[] = {
+		"",
+		"text",
+		"<a>",
+		"<a></b>",
+		"</a>",
+		"<a/><b/>",
+		"<a/>text",
+		"<a b></a>",
+		"<a b=c></a>",
+		"<a b=\"c></a>",
+		"<a b=\"c\"d=\"e\"></a>",
+		"<a / >",
+		"<>",
+		"<a><!-- </a>",
+		"<a><![CDATA[</a>",
+		"<?xml",
+		"<!DOCTYPE a",
+		"<a><!DOCTYPE b></a>",
+		"<a><",
+	};
+
+	xml_t xml = { 0 };
+	xml_init(&xml, 1, 1);
+
+	for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+		EXPECT_EQ(xml_parse(&xml, docs[i], cstr_len(docs[i])), XML_END);
+	}
+
+	xml_free(&xml);
+
+	END;
+}
+
+STEST(t_xml_parse)
+{
+	SSTART;
+	RUN(t_xml_parse_stream);
+	RUN(t_xml_parse_doc);
+	RUN(t_xml_parse_text);
+	RUN(t_xml_parse_invalid);
+	SEND;
+}
@@ -4,68 +4,106 @@
 #include "test.h"
 #include "test_test.h"
 
+STEST(t_arena);
 STEST(t_args);
 STEST(t_arr);
 STEST(t_bnf);
 STEST(t_cstr);
 STEST(t_cplatform);
 STEST(t_cutils);
+STEST(t_dbuf);
 STEST(t_dict);
+STEST(t_digest);
 STEST(t_ebnf);
 STEST(t_eparser);
 STEST(t_esyntax);
+STEST(t_fcache);
+STEST(t_fcopy);
+STEST(t_fdict);
+STEST(t_fglob);
 STEST(t_file);
+STEST(t_finfo);
+STEST(t_freader);
+STEST(t_fsink);
+STEST(t_fwalk);
+STEST(t_hash128);
 STEST(t_ini);
 STEST(t_ini_parse);
 STEST(t_json);
+STEST(t_json_bin);
+STEST(t_json_parse);
 STEST(t_lexer);
 STEST(t_list);
 STEST(t_log);
+STEST(t_lz);
 STEST(t_md5);
 STEST(t_mem);
 STEST(t_parser);
 STEST(t_path);
 STEST(t_print);
+STEST(t_snap);
+STEST(t_sha256);
 STEST(t_str);
 STEST(t_syntax);
+STEST(t_thread);
 STEST(t_time);
 STEST(t_token);
 STEST(t_tree);
 STEST(t_type);
 STEST(t_xml);
+STEST(t_xml_parse);
 
 TEST(tests)
 {
 	SSTART;
+	RUN(t_arena);
 	RUN(t_args);
 	RUN(t_arr);
 	RUN(t_bnf);
 	RUN(t_cplatform);
 	RUN(t_cstr);
 	RUN(t_cutils);
+	RUN(t_dbuf);
 	RUN(t_dict);
+	RUN(t_digest);
 	RUN(t_ebnf);
 	RUN(t_eparser);
 	RUN(t_esyntax);
+	RUN(t_fcache);
+	RUN(t_fcopy);
+	RUN(t_fdict);
+	RUN(t_fglob);
 	RUN(t_file);
+	RUN(t_finfo);
+	RUN(t_freader);
+	RUN(t_fsink);
+	RUN(t_fwalk);
+	RUN(t_hash128);
 	RUN(t_ini);
 	RUN(t_ini_parse);
 	RUN(t_json);
+	RUN(t_json_bin);
+	RUN(t_json_parse);
 	RUN(t_lexer);
 	RUN(t_list);
 	RUN(t_log);
+	RUN(t_lz);
 	RUN(t_md5);
 	RUN(t_mem);
 	RUN(t_parser);
 	RUN(t_path);
 	RUN(t_print);
+	RUN(t_snap);
+	RUN(t_sha256);
 	RUN(t_str);
 	RUN(t_syntax);
+	RUN(t_thread);
 	RUN(t_time);
 	RUN(t_token);
 	RUN(t_tree);
 	RUN(t_type);
 	RUN(t_xml);
+	RUN(t_xml_parse);
 	SEND;
 }
 
@@ -0,0 +1,12 @@
+#include "test_util.h"
+
+#include "file.h"
+
+#include <string.h>
+
+void test_write_file(const char *path, const char *data)
+{
+	FILE *file = file_open(path, "wb");
+	fwrite(data, 1, strlen(data), file);
+	file_close(file);
+}
@@ -8,12 +8,15 @@
 
 #define LEX_TOKEN_END ARR_END
 
+#define LEX_NORM_CRLF (1 << 0)
+
 typedef size_t lex_token_t;
 
 typedef struct lex_s {
 	str_t str;
 	arr_t tokens;
 	lex_token_t root;
+	uint flags;
 } lex_t;
 
 lex_t *lex_init(lex_t *lex, uint token_cap);
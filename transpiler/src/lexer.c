@@ -13,7 +13,8 @@ lex_t *lex_init(lex_t *lex, uint tokens_cap)
 		return NULL;
 	}
 
-	lex->root = LEX_TOKEN_END;
+	lex->root  = LEX_TOKEN_END;
+	lex->flags = 0;
 
 	return lex;
 }
@@ -104,6 +105,9 @@ lex_t *lex_tokenize(lex_t *lex, str_t str)
 				type |= 1 << TOKEN_WS;
 				type |= 1 << TOKEN_TAB;
 			} else if (c == '\r') {
+				if ((lex->flags & LEX_NORM_CRLF) && i + 1 < str.len && str.data[i + 1] == '\n') {
+					continue;
+				}
 				type |= 1 << TOKEN_WS;
 				type |= 1 << TOKEN_CR;
 			} else if (c == '\n') {